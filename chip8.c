@@ -5,24 +5,22 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <unistd.h>
 /* For byteswapping utilities */
 #include <arpa/inet.h>
 
 #include "chip8.h"
 #include "chip8_utils.h"
-
-#define OPC_CLASS(_op)  ((_op & 0xF000) >> 12)
-#define OPC_REGX(_op)   ((_op & 0x0F00) >> 8)
-#define OPC_REGY(_op)   ((_op & 0x00F0) >> 4)
-#define OPC_N(_op)      (_op & 0x000F)
-#define OPC_NN(_op)     (_op & 0x00FF)
-#define OPC_NNN(_op)    (_op & 0x0FFF)
+#include "chip8_decode.h"
+#include "chip8_rt.h"
+#include "chip8_writer.h"
 
 #if 0
 #define INTERPRETER_TRACE(...) (printf( __VA_ARGS__ ))
@@ -37,36 +35,120 @@
  * stack stores 16-bit pointers we start at 0xEFE for alignment and to
  * not overwrite past the stack boundaries */
 #define STACK_BASE_ADDR         0xEFE
+/* XO-CHIP programs may fill all of memory, so their stack moves down into
+ * the interpreter area, above the fonts */
+#define XOCHIP_STACK_END_ADDR   0x1A0
+#define XOCHIP_STACK_BASE_ADDR  0x1FE
 #define DISPLAY_REFRESH_ADDR    0xF00
-#define MEMORY_SIZE             0x1000
 
-/* Memory space of the CHIP-8 */
-static uint8_t s_memory[MEMORY_SIZE];
-#define U16_MEMORY_READ(_addr) (*(uint16_t *)&s_memory[_addr])
-#define U16_MEMORY_WRITE(_addr, val) (*((uint16_t *)&s_memory[_addr]) = (val))
+/* The machine state below is thread-local so that every thread can run
+ * its own independent machine, e.g. for parallel state exploration.
+ * Single-threaded users see no difference. */
+
+/* Memory space of the CHIP-8, plus a byte so that fetching an opcode from
+ * the last address stays in bounds */
+static _Thread_local uint8_t s_memory[MEMORY_SIZE + 1];
+/* Opcodes and stack entries need not be aligned */
+#define U16_MEMORY_READ(_addr) (u16_memory_read(_addr))
+#define U16_MEMORY_WRITE(_addr, val) (u16_memory_write((_addr), (val)))
+
+/* XO-CHIP memory layout, see chip8_set_xochip() */
+static _Thread_local bool s_xochip = false;
+
+/* Wraps addresses computed from I. Classic programs wrap at 4 KB, so none
+ * of their accesses reach the XO-CHIP part of memory. */
+static _Thread_local uint16_t s_addr_mask = CLASSIC_MEMORY_SIZE - 1;
+#define MEMORY_AT(_addr) (s_memory[(uint16_t)(_addr) & s_addr_mask])
+
+/* Memory above CLASSIC_MEMORY_SIZE may hold XO-CHIP bytes. Classic opcode
+ * fetches are not masked, so a classic restore clears it first. */
+static _Thread_local bool s_high_memory_used = false;
+
+static inline uint16_t
+u16_memory_read (uint16_t addr)
+{
+    uint16_t val;
+
+    memcpy(&val, &s_memory[addr], sizeof(val));
+    return (val);
+}
+
+static inline void
+u16_memory_write (uint16_t addr, uint16_t val)
+{
+    memcpy(&s_memory[addr], &val, sizeof(val));
+}
 
 /* 16, 8-bit V registers */
-#define NUM_V_REGISTERS 16
-static uint8_t s_v_regs[NUM_V_REGISTERS];
+static _Thread_local uint8_t s_v_regs[NUM_V_REGISTERS];
 
 /* 16-bit I register */
-static uint16_t s_i_reg;
+static _Thread_local uint16_t s_i_reg;
 
 /* 16-bit program counter */
-static uint16_t s_pc;
+static _Thread_local uint16_t s_pc;
 
 /* 16-bit stack pointer */
-static uint16_t s_stack_ptr;
+static _Thread_local uint16_t s_stack_ptr;
 
 /* Set to true if execution is paused.
  * Mainly used for opcode LD Vx, K */
-static bool s_execution_paused_for_key_ld = false;
-
-/* Graphics buffer */
-static uint8_t s_vram[DISPLAY_HEIGHT_PIXELS]
-                     [DISPLAY_WIDTH_PIXELS];
-
-static bool s_little_endian = false;
+static _Thread_local bool s_execution_paused_for_key_ld = false;
+
+/* Graphics buffer, one bitmap per plane, see VRAM_ROW_WORDS. Low
+ * resolution mode only uses the top-left LORES_WIDTH_PIXELS x
+ * LORES_HEIGHT_PIXELS. */
+static _Thread_local uint64_t s_vram[NUM_PLANES][DISPLAY_HEIGHT_PIXELS]
+                                   [VRAM_ROW_WORDS];
+
+/* XO-CHIP planes that drawing, clearing and scrolling apply to */
+static _Thread_local uint8_t s_plane_mask = 0x1;
+
+/* A plane's rows, as passed to the drawing and scrolling kernels */
+typedef uint64_t vram_plane_t[DISPLAY_HEIGHT_PIXELS][VRAM_ROW_WORDS];
+
+#define PLANE_SELECTED(_plane)  ((s_plane_mask & (1 << (_plane))) != 0)
+
+/* SUPER-CHIP 128x64 display mode */
+static _Thread_local bool s_hires = false;
+
+/* SUPER-CHIP RPL user flags */
+static _Thread_local uint8_t s_rpl_flags[NUM_RPL_FLAGS];
+
+/* XO-CHIP audio pattern and pitch */
+static _Thread_local uint8_t s_audio_pattern[AUDIO_PATTERN_SIZE];
+static _Thread_local uint8_t s_audio_pitch = DEFAULT_AUDIO_PITCH;
+
+/* Debugging support. Breakpoints and watchpoints are bitmaps indexed by
+ * address. chip8_run() only switches to the checked loop while at least
+ * one of them is set, or while tracing. */
+static _Thread_local uint8_t s_breakpoints[MEMORY_SIZE / 8];
+static _Thread_local uint8_t s_watchpoints[MEMORY_SIZE / 8];
+static _Thread_local uint32_t s_num_breakpoints;
+static _Thread_local uint32_t s_num_watchpoints;
+static _Thread_local bool s_trace;
+/* Trace lines go to standard output through the I/O thread, -1 prints
+ * them directly if that could not be set up */
+static _Thread_local int s_trace_stream = -1;
+#define TRACE_QUEUE_SIZE    (1 << 20)
+/* Set when stopped at a breakpoint, so that resuming executes it */
+static _Thread_local bool s_resume_past_breakpoint;
+static _Thread_local chip8_stop_reason_et s_stop_reason;
+static _Thread_local uint16_t s_stop_addr;
+
+/* Set once the machine faults, see chip8_get_fault() */
+static _Thread_local chip8_fault_et s_fault = CHIP8_FAULT_NONE;
+static _Thread_local uint16_t s_fault_addr;
+
+/* See chip8_get_counters(). Instructions are counted per run, not per
+ * instruction. */
+static _Thread_local chip8_counters_t s_counters;
+
+#define ADDR_BIT_TEST(_map, _addr) \
+    (((_map)[(_addr) / 8] & (1 << ((_addr) % 8))) != 0)
+
+/* Set by chip8_init and chip8_restore_state, which may run on any thread */
+static _Thread_local bool s_little_endian = false;
 
 /* Sprites are loaded to the start of memory,
  * into the interpreter reserved area (0x0 - 0x1FF)
@@ -74,7 +156,7 @@ static bool s_little_endian = false;
 #define SPRITE_LOAD_ADDR    0
 
 /* Gets the address in memory of the given sprite */
-#define SPRITE_ADDR(_char)  (SPRITE_LOAD_ADDR + (_char * 5))
+#define SPRITE_ADDR(_char)  (SPRITE_LOAD_ADDR + ((_char) * 5))
 static uint8_t s_character_sprite_data[] = {
     0xF0, /* **** */
     0x90, /* *  * */
@@ -173,6 +255,29 @@ static uint8_t s_character_sprite_data[] = {
     0x80, /* *    */
 };
 
+/* SUPER-CHIP 8x10 digits, loaded right after the small ones */
+#define BIG_SPRITE_LOAD_ADDR    (SPRITE_LOAD_ADDR + \
+                                 sizeof(s_character_sprite_data))
+#define BIG_SPRITE_ADDR(_char)  (BIG_SPRITE_LOAD_ADDR + ((_char) * 10))
+static uint8_t s_big_character_sprite_data[] = {
+    /* 0 */ 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF,
+    /* 1 */ 0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF,
+    /* 2 */ 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+    /* 3 */ 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+    /* 4 */ 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03,
+    /* 5 */ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+    /* 6 */ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+    /* 7 */ 0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18,
+    /* 8 */ 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+    /* 9 */ 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+    /* A */ 0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3,
+    /* B */ 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC,
+    /* C */ 0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C,
+    /* D */ 0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC,
+    /* E */ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+    /* F */ 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0,
+};
+
 static bool
 need_to_byteswap_opcode (void)
 {
@@ -188,48 +293,248 @@ need_to_byteswap_opcode (void)
 static void
 clear_display (void)
 {
+    int plane;
+
+    for (plane = 0; plane < NUM_PLANES; plane++) {
+        if (PLANE_SELECTED(plane)) {
+            memset(s_vram[plane], 0, sizeof(s_vram[plane]));
+        }
+    }
+}
+
+static int
+display_width (void)
+{
+    return s_hires ? DISPLAY_WIDTH_PIXELS : LORES_WIDTH_PIXELS;
+}
+
+static int
+display_height (void)
+{
+    return s_hires ? DISPLAY_HEIGHT_PIXELS : LORES_HEIGHT_PIXELS;
+}
+
+static void
+set_display_mode (bool hires)
+{
+    s_hires = hires;
+    /* Every plane, not just the selected ones */
     memset(s_vram, 0, sizeof(s_vram));
 }
 
+/* The scroll kernels below move whole rows or words of one plane at a
+ * time, scroll distances are in pixels of the current display mode.
+ * Sideways distances must be between 1 and 63 pixels. */
+static void
+scroll_down (vram_plane_t rows, uint8_t n)
+{
+    int height = display_height();
+
+    memmove(&rows[n], &rows[0], (height - n) * sizeof(rows[0]));
+    memset(&rows[0], 0, n * sizeof(rows[0]));
+}
+
+static void
+scroll_right (vram_plane_t rows, uint8_t n)
+{
+    int y;
+
+    for (y = 0; y < display_height(); y++) {
+        if (s_hires) {
+            rows[y][1] = (rows[y][1] >> n) | (rows[y][0] << (64 - n));
+        }
+        rows[y][0] >>= n;
+    }
+}
+
+static void
+scroll_left (vram_plane_t rows, uint8_t n)
+{
+    int y;
+
+    /* The second word is always clear in low resolution mode */
+    for (y = 0; y < display_height(); y++) {
+        rows[y][0] = (rows[y][0] << n) | (rows[y][1] >> (64 - n));
+        rows[y][1] <<= n;
+    }
+}
+
 static void
+scroll_planes (void (*kernel)(vram_plane_t rows, uint8_t n), uint8_t n)
+{
+    int plane;
+
+    for (plane = 0; plane < NUM_PLANES; plane++) {
+        if (PLANE_SELECTED(plane)) {
+            kernel(s_vram[plane], n);
+        }
+    }
+}
+
+/* Copies between registers and memory at I, wrapping like MEMORY_AT() */
+static void
+copy_to_memory (uint16_t addr, const uint8_t *src, uint16_t len)
+{
+    uint16_t i;
+
+    if ((uint32_t)addr + len <= (uint32_t)s_addr_mask + 1) {
+        memcpy(&s_memory[addr], src, len);
+        return;
+    }
+
+    for (i = 0; i < len; i++) {
+        MEMORY_AT(addr + i) = src[i];
+    }
+}
+
+static void
+copy_from_memory (uint8_t *dst, uint16_t addr, uint16_t len)
+{
+    uint16_t i;
+
+    if ((uint32_t)addr + len <= (uint32_t)s_addr_mask + 1) {
+        memcpy(dst, &s_memory[addr], len);
+        return;
+    }
+
+    for (i = 0; i < len; i++) {
+        dst[i] = MEMORY_AT(addr + i);
+    }
+}
+
+/* Skips the next instruction, see OPC_SKIP_LEN() */
+static void
+skip_next_instruction (void)
+{
+    s_pc += OPC_SKIP_LEN((s_memory[s_pc] << 8) | s_memory[s_pc + 1],
+                         s_xochip);
+}
+
+/* Recompiled code for the loaded program, see chip8_rt.h. Debugging
+ * always goes through the checked interpreter loop instead. */
+static _Thread_local chip8_native_run_t s_native_run;
+static _Thread_local chip8_native_invalidate_t s_native_invalidate;
+
+/* Native routines run by 0NNN, indexed by NNN. Shared by every thread. */
+static chip8_host_call_t s_host_calls[CHIP8_RT_HOST_CALL_MAX];
+static void *s_host_call_ctx[CHIP8_RT_HOST_CALL_MAX];
+
+/* Memory may no longer hold the code the native loop was built from */
+static void
+invalidate_native_code (void)
+{
+    if (s_native_invalidate != NULL) {
+        s_native_invalidate();
+    }
+}
+
+/* Stops the machine on the instruction being executed. The PC has
+ * already moved past it. */
+static void
+machine_fault (chip8_fault_et fault)
+{
+    s_pc -= 2;
+    s_fault = fault;
+    s_fault_addr = s_pc;
+}
+
+/* Returns false, having faulted the machine, if the stack is full */
+static bool
 stack_push (uint16_t val)
 {
+    if (s_stack_ptr < (s_xochip ? XOCHIP_STACK_END_ADDR : STACK_END_ADDR)) {
+        machine_fault(CHIP8_FAULT_STACK_OVERFLOW);
+        return false;
+    }
+
     INTERPRETER_TRACE("Stack push: SP: 0x%x - 0x%x\n", s_stack_ptr, val);
     U16_MEMORY_WRITE(s_stack_ptr, val);
     s_stack_ptr -= 2;
     INTERPRETER_TRACE("Stack push: SP: 0x%x - 0x%x\n", s_stack_ptr, val);
+
+    return true;
 }
 
-static uint16_t
-stack_pop (void)
+/* Returns false, having faulted the machine, if the stack is empty */
+static bool
+stack_pop (uint16_t *val)
 {
-    uint16_t ret = 0;
+    if (s_stack_ptr >= (s_xochip ? XOCHIP_STACK_BASE_ADDR : STACK_BASE_ADDR)) {
+        machine_fault(CHIP8_FAULT_STACK_UNDERFLOW);
+        return false;
+    }
 
-    INTERPRETER_TRACE("Stack pop: SP: 0x%x - 0x%x\n", s_stack_ptr, ret);
+    INTERPRETER_TRACE("Stack pop: SP: 0x%x - 0x%x\n", s_stack_ptr, *val);
     s_stack_ptr += 2;
-    ret = U16_MEMORY_READ(s_stack_ptr);
-    INTERPRETER_TRACE("Stack pop: SP: 0x%x - 0x%x\n", s_stack_ptr, ret);
+    *val = U16_MEMORY_READ(s_stack_ptr);
+    INTERPRETER_TRACE("Stack pop: SP: 0x%x - 0x%x\n", s_stack_ptr, *val);
 
-    return (ret);
+    return true;
 }
 
 /* Opcode decoding */
+/* SYS NNN. The routine sees the PC past the instruction and may move
+ * it. */
+static void
+run_host_call (uint16_t addr)
+{
+    chip8_host_call_t call = s_host_calls[addr];
+    uint16_t pc = s_pc;
+
+    if (call == NULL) {
+        machine_fault(CHIP8_FAULT_BAD_OPCODE);
+        return;
+    }
+
+    if (!call(chip8_rt_get(), s_host_call_ctx[addr])) {
+        s_pc = pc;
+        machine_fault(CHIP8_FAULT_HOST_CALL);
+    }
+
+    /* Native code may have written anywhere in memory */
+    invalidate_native_code();
+}
+
 static void
 chip8_interpret_op0 (uint16_t op)
 {
+    if ((op & 0xFFF0) == 0x00C0) {
+        /* SCD N - Scroll the display down N lines. */
+        scroll_planes(scroll_down, OPC_N(op));
+        return;
+    }
+
     switch (op) {
         default:
-            /* Would call machine-code routine at the given address */
-            assert(false);
+            /* SYS NNN - Call a machine-code routine, here a native one */
+            run_host_call(OPC_NNN(op));
+            break;
         case 0x00E0: /* CLS */
             clear_display();
             break;
+        case 0x00FB: /* SCR - Scroll the display right 4 pixels */
+            scroll_planes(scroll_right, 4);
+            break;
+        case 0x00FC: /* SCL - Scroll the display left 4 pixels */
+            scroll_planes(scroll_left, 4);
+            break;
+        case 0x00FD: /* EXIT */
+            /* There is no calling program to return to, stay parked on
+             * this instruction */
+            s_pc -= 2;
+            break;
+        case 0x00FE: /* LOW - Switch to 64x32 */
+            set_display_mode(false);
+            break;
+        case 0x00FF: /* HIGH - Switch to 128x64 */
+            set_display_mode(true);
+            break;
         case 0x00EE: /* RET */
             /* Return from a subroutine.
              * The interpreter sets the program counter to the address at the
              * top of the stack, then subtracts 1 from the stack pointer.
              */
-            s_pc = stack_pop();
+            stack_pop(&s_pc);
             break;
     }
 }
@@ -250,8 +555,9 @@ chip8_interpret_op2 (uint16_t op)
      * The interpreter increments the stack pointer, then puts the current PC
      * on the top of the stack. The PC is then set to nnn.
      */
-    stack_push(s_pc);
-    s_pc = OPC_NNN(op);
+    if (stack_push(s_pc)) {
+        s_pc = OPC_NNN(op);
+    }
 }
 
 static void
@@ -264,7 +570,7 @@ chip8_interpret_op3 (uint16_t op)
     uint8_t val = OPC_NN(op);
 
     if (s_v_regs[vx] == val) {
-        s_pc += 2;
+        skip_next_instruction();
     }
 }
 
@@ -278,21 +584,50 @@ chip8_interpret_op4 (uint16_t op)
     uint8_t val = OPC_NN(op);
 
     if (s_v_regs[vx] != val) {
-        s_pc += 2;
+        skip_next_instruction();
+    }
+}
+
+/* XO-CHIP register ranges run from Vx to Vy, in either direction */
+static void
+copy_register_range (uint16_t op, bool to_memory)
+{
+    uint8_t vx = OPC_REGX(op);
+    uint8_t vy = OPC_REGY(op);
+    int step = (vx <= vy) ? 1 : -1;
+    int count = (vx <= vy) ? vy - vx + 1 : vx - vy + 1;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (to_memory) {
+            MEMORY_AT(s_i_reg + i) = s_v_regs[vx + i * step];
+        } else {
+            s_v_regs[vx + i * step] = MEMORY_AT(s_i_reg + i);
+        }
     }
 }
 
 static void
 chip8_interpret_op5 (uint16_t op)
 {
-    /* SE Vx, Vy
-     * Skip next instruction if Vx = Vy.
-     */
     uint8_t vx = OPC_REGX(op);
     uint8_t vy = OPC_REGY(op);
 
-    if (s_v_regs[vx] == s_v_regs[vy]) {
-        s_pc += 2;
+    switch (OPC_N(op)) {
+        default:
+            machine_fault(CHIP8_FAULT_BAD_OPCODE);
+            break;
+        case 0x0: /* SE Vx, Vy - Skip next instruction if Vx = Vy. */
+            if (s_v_regs[vx] == s_v_regs[vy]) {
+                skip_next_instruction();
+            }
+            break;
+        case 0x2: /* LD [I], Vx - Vy - Store Vx to Vy at I, I is unchanged */
+            copy_register_range(op, true);
+            break;
+        case 0x3: /* LD Vx - Vy, [I] - Load Vx to Vy from I */
+            copy_register_range(op, false);
+            break;
     }
 }
 
@@ -319,7 +654,8 @@ chip8_interpret_op8 (uint16_t op)
 {
     switch (op & 0xF) {
         default:
-            assert(false);
+            machine_fault(CHIP8_FAULT_BAD_OPCODE);
+            break;
         case 0: /* LD Vx, Vy - Set Vx = Vy. */
             s_v_regs[OPC_REGX(op)] = s_v_regs[OPC_REGY(op)];
             break;
@@ -374,10 +710,13 @@ chip8_interpret_op9 (uint16_t op)
     /* SNE Vx, Vy
      * Skip next instruction if Vx != Vy.
      */
-    assert((op & 0xF) == 0);
+    if ((op & 0xF) != 0) {
+        machine_fault(CHIP8_FAULT_BAD_OPCODE);
+        return;
+    }
 
     if (s_v_regs[OPC_REGX(op)] != s_v_regs[OPC_REGY(op)]) {
-        s_pc += 2;
+        skip_next_instruction();
     }
 }
 
@@ -408,58 +747,115 @@ chip8_interpret_opC (uint16_t op)
     s_v_regs[OPC_REGX(op)] = get_random_byte() & OPC_NN(op);
 }
 
+/* Positions a row of sprite pixels, leftmost in bit (bits_width - 1), at
+ * column x of a VRAM row, wrapping around the right edge. */
 static void
-chip8_interpret_opD (uint16_t op)
+sprite_row_mask (uint32_t bits, int bits_width, int x,
+                 uint64_t mask[VRAM_ROW_WORDS])
 {
-    /* DRW Vx, Vy, N
-     * Display N-byte sprite starting at memory location I at (Vx, Vy),
-     * set VF = collision.
-     */
-    uint8_t     x           = s_v_regs[OPC_REGX(op)];
-    uint8_t     y           = s_v_regs[OPC_REGY(op)];
-    uint8_t     num_bytes   = OPC_N(op);
-    uint16_t    sprite_addr = s_i_reg;
-    int         i;
-    int         j;
-    uint8_t     previous_sprite = 0;
-    uint8_t     paintbrush = 0;
-
-    /* Start by assuming no pixels will be erased */
-    s_v_regs[0xF] = 0;
-
-    for (i = 0; i < num_bytes; i++) {
-        previous_sprite = 0;
-        /* For each byte of the sprite, the packed byte needs
-         * to be expanded back out into individual bytes */
-        for (j = 0; j < 8; j++) {
-            /* Collect all existing pixels of the byte to
-             * see what changes later */
-            previous_sprite |= s_vram[y][x+j];
-        }
+    uint64_t left = (uint64_t)bits << (64 - bits_width);
+    uint64_t right = 0;
+    uint64_t tmp;
+
+    if (!s_hires) {
+        /* A low resolution row is a single word, rotate within it */
+        mask[0] = (x == 0) ? left : (left >> x) | (left << (64 - x));
+        mask[1] = 0;
+        return;
+    }
 
-        /* Now write the new sprite to VRAM */
-        for (j = 0; j < 8; j++) {
-            if ((s_memory[sprite_addr] & (1 << (7-j))) != 0) {
-                paintbrush = 0xFF;
-            } else {
-                paintbrush = 0x0;
-            }
-            s_vram[y][x+j] = paintbrush ^ s_vram[y][x+j];
+    /* Rotate the 128-bit row right by x */
+    if (x >= 64) {
+        right = left;
+        left = 0;
+        x -= 64;
+    }
+    if (x != 0) {
+        tmp = left;
+        left = (left >> x) | (right << (64 - x));
+        right = (right >> x) | (tmp << (64 - x));
+    }
+
+    mask[0] = left;
+    mask[1] = right;
+}
+
+/* Draws one plane of a sprite, returns 1 if a pixel was erased */
+static uint8_t
+draw_plane (vram_plane_t rows, uint8_t x, uint8_t y, uint16_t sprite_addr,
+            uint8_t num_rows, int bits_width)
+{
+    uint64_t mask[VRAM_ROW_WORDS];
+    uint32_t bits;
+    int height = display_height();
+    int row;
+    int i;
+    uint8_t collision = 0;
+
+    for (i = 0; i < num_rows; i++) {
+        if (bits_width == 16) {
+            bits = (MEMORY_AT(sprite_addr) << 8) | MEMORY_AT(sprite_addr + 1);
+            sprite_addr += 2;
+        } else {
+            bits = MEMORY_AT(sprite_addr);
+            sprite_addr++;
         }
 
-        /* The following sets VF without a branch, only a comparison.
-         * Let's say we have the following byte in VRAM to start
-         * 0x8A (10001010). If the new byte coming in clears any of
-         * those bits, the resulting byte in VRAM will always be
-         * less than the previous value. We can use that comparison
-         * to set the bit in VF indicating that a pixel was erased.
-         */
-        s_v_regs[0xF] |= (previous_sprite > s_memory[sprite_addr]) & 0x1;
-        /* Move to the next line on screen. */
-        sprite_addr++;
-        y++;
-        y = y % DISPLAY_HEIGHT_PIXELS;
+        sprite_row_mask(bits, bits_width, x, mask);
+
+        /* Sprites wrap around the bottom of the screen */
+        row = (y + i) % height;
+        collision |= ((rows[row][0] & mask[0]) |
+                      (rows[row][1] & mask[1])) != 0;
+        rows[row][0] ^= mask[0];
+        rows[row][1] ^= mask[1];
+    }
+
+    return (collision);
+}
+
+/* Draws a sprite from memory at (x, y), returns 1 if a pixel was erased.
+ * A sprite of 0 rows is a SUPER-CHIP 16x16 sprite. With several planes
+ * selected, each plane takes the next sprite's worth of bytes. */
+static uint8_t
+draw_sprite (uint8_t x, uint8_t y, uint16_t sprite_addr, uint8_t num_rows)
+{
+    int bits_width = 8;
+    int plane;
+    uint8_t collision = 0;
+
+    if (num_rows == 0) {
+        num_rows = 16;
+        bits_width = 16;
+    }
+
+    x = x % display_width();
+    y = y % display_height();
+
+    for (plane = 0; plane < NUM_PLANES; plane++) {
+        if (PLANE_SELECTED(plane)) {
+            collision |= draw_plane(s_vram[plane], x, y, sprite_addr,
+                                    num_rows, bits_width);
+            sprite_addr += num_rows * (bits_width / 8);
+        }
     }
+
+    s_counters.draws++;
+    s_counters.collisions += (collision != 0);
+
+    return (collision);
+}
+
+static void
+chip8_interpret_opD (uint16_t op)
+{
+    /* DRW Vx, Vy, N
+     * Display N-byte sprite starting at memory location I at (Vx, Vy),
+     * set VF = collision. N = 0 draws a 16x16 sprite of 32 bytes.
+     */
+    s_v_regs[0xF] = draw_sprite(s_v_regs[OPC_REGX(op)],
+                                s_v_regs[OPC_REGY(op)],
+                                s_i_reg, OPC_N(op));
 }
 
 static void
@@ -467,15 +863,16 @@ chip8_interpret_opE (uint16_t op)
 {
     switch (OPC_NN(op)) {
         default:
-            assert(false);
-        case 0x9E: /* SKP Vx */
-            if (get_key_pressed(s_v_regs[OPC_REGX(op)])) {
-                s_pc += 2;
+            machine_fault(CHIP8_FAULT_BAD_OPCODE);
+            break;
+        case 0x9E: /* SKP Vx - only the low nibble names a key */
+            if (get_key_pressed(s_v_regs[OPC_REGX(op)] & 0xF)) {
+                skip_next_instruction();
             }
             break;
         case 0xA1: /* SKNP Vx */
-            if (!get_key_pressed(s_v_regs[OPC_REGX(op)])) {
-                s_pc += 2;
+            if (!get_key_pressed(s_v_regs[OPC_REGX(op)] & 0xF)) {
+                skip_next_instruction();
             }
             break;
     }
@@ -484,13 +881,13 @@ chip8_interpret_opE (uint16_t op)
 void
 chip8_notify_key_pressed (chip8_key_et key)
 {
-    uint16_t key_opcode = U16_MEMORY_READ(s_pc - 2);
-
-    if (s_little_endian) {
-        key_opcode = htons(key_opcode);
-    }
+    uint16_t key_opcode;
 
     if (s_execution_paused_for_key_ld) {
+        key_opcode = U16_MEMORY_READ(s_pc - 2);
+        if (s_little_endian) {
+            key_opcode = htons(key_opcode);
+        }
         s_v_regs[OPC_REGX(key_opcode)] = key;
         s_execution_paused_for_key_ld = false;
     }
@@ -501,7 +898,27 @@ chip8_interpret_opF (uint16_t op)
 {
     switch (OPC_NN(op)) {
         default:
-            assert(false);
+            machine_fault(CHIP8_FAULT_BAD_OPCODE);
+            break;
+        case 0x00: /* LD I, NNNN - XO-CHIP F000 NNNN */
+            if (OPC_REGX(op) != 0) {
+                machine_fault(CHIP8_FAULT_BAD_OPCODE);
+                break;
+            }
+            s_i_reg = (MEMORY_AT(s_pc) << 8) | MEMORY_AT(s_pc + 1);
+            s_pc += 2;
+            break;
+        case 0x01: /* PLANE N - XO-CHIP FN01 */
+            s_plane_mask = OPC_REGX(op) & ((1 << NUM_PLANES) - 1);
+            break;
+        case 0x02: /* LD AUDIO, [I] - XO-CHIP F002 */
+            if (OPC_REGX(op) != 0) {
+                machine_fault(CHIP8_FAULT_BAD_OPCODE);
+                break;
+            }
+            copy_from_memory(s_audio_pattern, s_i_reg,
+                             sizeof(s_audio_pattern));
+            break;
         case 0x07: /* LD Vx, DT */
             s_v_regs[OPC_REGX(op)] = get_delay_timer_remaining();
             break;
@@ -518,24 +935,37 @@ chip8_interpret_opF (uint16_t op)
             s_i_reg = s_i_reg + s_v_regs[OPC_REGX(op)];
             break;
         case 0x29: /* LD F, Vx */
-            assert(s_v_regs[OPC_REGX(op)] <= 0xF);
-            s_i_reg = SPRITE_ADDR(s_v_regs[OPC_REGX(op)]);
+            /* Only the low digit counts, as on the COSMAC VIP */
+            s_i_reg = SPRITE_ADDR(s_v_regs[OPC_REGX(op)] & 0xF);
+            break;
+        case 0x30: /* LD HF, Vx */
+            s_i_reg = BIG_SPRITE_ADDR(s_v_regs[OPC_REGX(op)] & 0xF);
             break;
         case 0x33: /* LD B, Bx */
             {
                 uint8_t val = s_v_regs[OPC_REGX(op)];
-                s_memory[s_i_reg] = val / 100;
-                s_memory[s_i_reg + 1] = (val / 10) % 10;
-                s_memory[s_i_reg + 2] = val % 10;
+                MEMORY_AT(s_i_reg) = val / 100;
+                MEMORY_AT(s_i_reg + 1) = (val / 10) % 10;
+                MEMORY_AT(s_i_reg + 2) = val % 10;
             }
             break;
+        case 0x3A: /* PITCH Vx - XO-CHIP */
+            s_audio_pitch = s_v_regs[OPC_REGX(op)];
+            break;
         case 0x55: /* LD [I], Vx */
-            memcpy(&s_memory[s_i_reg], s_v_regs,
-                   OPC_REGX(op) + sizeof(s_v_regs[0]));
+            copy_to_memory(s_i_reg, s_v_regs,
+                           OPC_REGX(op) + sizeof(s_v_regs[0]));
             break;
         case 0x65: /* LD Vx, [I] */
-            memcpy(s_v_regs, &s_memory[s_i_reg],
-                   OPC_REGX(op) + sizeof(s_v_regs[0]));
+            copy_from_memory(s_v_regs, s_i_reg,
+                             OPC_REGX(op) + sizeof(s_v_regs[0]));
+            break;
+        case 0x75: /* LD R, Vx */
+            memcpy(s_rpl_flags, s_v_regs, OPC_REGX(op) + 1);
+            break;
+        case 0x85: /* LD Vx, R */
+            memcpy(s_v_regs, s_rpl_flags, OPC_REGX(op) + 1);
+            break;
     }
 }
 
@@ -583,33 +1013,538 @@ chip8_step (void)
 
     INTERPRETER_TRACE("PC: 0x%x - 0x%x\n", s_pc, U16_MEMORY_READ(s_pc));
 
-    if (!s_execution_paused_for_key_ld) {
+    if (!s_execution_paused_for_key_ld && s_fault == CHIP8_FAULT_NONE) {
         /* Increment PC for next instruction */
         s_pc += 2;
         chip8_interpret_op(op);
+        s_counters.instructions++;
     }
 }
 
-uint8_t *
-chip8_get_vram (void)
+/* Run loop used when nothing is being debugged. Must stay free of any
+ * per-instruction debugging checks. */
+static uint32_t
+chip8_run_fast (uint32_t count)
 {
-    return &s_vram[0][0];
+    uint32_t i;
+    uint16_t op;
+
+    for (i = 0; i < count; i++) {
+        if (s_execution_paused_for_key_ld) {
+            s_stop_reason = CHIP8_STOP_KEY_WAIT;
+            break;
+        }
+        if (s_fault != CHIP8_FAULT_NONE) {
+            s_stop_reason = CHIP8_STOP_FAULT;
+            s_stop_addr = s_fault_addr;
+            break;
+        }
+
+        op = U16_MEMORY_READ(s_pc);
+        s_pc += 2;
+        chip8_interpret_op(op);
+    }
+
+    return (i);
+}
+
+/* Checks whether op is about to write to a watched address.
+ * op is in host byte order. */
+static bool
+chip8_write_watched (uint16_t op, uint16_t *hit_addr)
+{
+    uint16_t start;
+    uint16_t len;
+    uint16_t addr;
+    uint16_t i;
+
+    if (OPC_CLASS(op) == 0x2) {
+        /* CALL pushes the return address */
+        start = s_stack_ptr;
+        len = sizeof(uint16_t);
+    } else if (OPC_CLASS(op) == 0xF && OPC_NN(op) == 0x33) {
+        start = s_i_reg & s_addr_mask;
+        len = 3;
+    } else if (OPC_CLASS(op) == 0xF && OPC_NN(op) == 0x55) {
+        start = s_i_reg & s_addr_mask;
+        len = OPC_REGX(op) + 1;
+    } else if (OPC_CLASS(op) == 0x5 && OPC_N(op) == 0x2) {
+        start = s_i_reg & s_addr_mask;
+        len = (OPC_REGX(op) <= OPC_REGY(op)) ?
+              OPC_REGY(op) - OPC_REGX(op) + 1 :
+              OPC_REGX(op) - OPC_REGY(op) + 1;
+    } else {
+        return false;
+    }
+
+    /* Stores wrap around the top of memory, see MEMORY_AT() */
+    for (i = 0; i < len; i++) {
+        addr = (start + i) & s_addr_mask;
+        if (ADDR_BIT_TEST(s_watchpoints, addr)) {
+            *hit_addr = addr;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+trace_instruction (uint16_t host_op)
+{
+    char line[32];
+    int len;
+
+    if (s_trace_stream < 0) {
+        printf("PC: 0x%03x - 0x%04x\n", s_pc, host_op);
+        return;
+    }
+
+    len = snprintf(line, sizeof(line), "PC: 0x%03x - 0x%04x\n", s_pc,
+                   host_op);
+    chip8_writer_write(s_trace_stream, line, len);
+}
+
+/* Run loop used while breakpoints, watchpoints or tracing are active */
+static uint32_t
+chip8_run_checked (uint32_t count)
+{
+    uint32_t i;
+    uint16_t op;
+    uint16_t host_op;
+    uint16_t watch_addr = 0;
+    bool watch_hit;
+
+    for (i = 0; i < count; i++) {
+        if (s_execution_paused_for_key_ld) {
+            s_stop_reason = CHIP8_STOP_KEY_WAIT;
+            break;
+        }
+        if (s_fault != CHIP8_FAULT_NONE) {
+            s_stop_reason = CHIP8_STOP_FAULT;
+            s_stop_addr = s_fault_addr;
+            break;
+        }
+
+        if (ADDR_BIT_TEST(s_breakpoints, s_pc) && !s_resume_past_breakpoint) {
+            s_stop_reason = CHIP8_STOP_BREAKPOINT;
+            s_stop_addr = s_pc;
+            s_resume_past_breakpoint = true;
+            break;
+        }
+        s_resume_past_breakpoint = false;
+
+        op = U16_MEMORY_READ(s_pc);
+        host_op = s_little_endian ? htons(op) : op;
+
+        if (s_trace) {
+            trace_instruction(host_op);
+        }
+
+        watch_hit = (s_num_watchpoints != 0) &&
+                    chip8_write_watched(host_op, &watch_addr);
+
+        s_pc += 2;
+        chip8_interpret_op(op);
+
+        if (watch_hit) {
+            /* Like most debuggers, stop just after the write */
+            s_stop_reason = CHIP8_STOP_WATCHPOINT;
+            s_stop_addr = watch_addr;
+            i++;
+            break;
+        }
+    }
+
+    /* The debugger prints next, after the lines that led there */
+    if (s_trace_stream >= 0 && s_stop_reason != CHIP8_STOP_NONE &&
+        s_stop_reason != CHIP8_STOP_KEY_WAIT) {
+        chip8_writer_flush(s_trace_stream);
+    }
+
+    return (i);
+}
+
+typedef uint32_t (*run_loop_t)(uint32_t count);
+
+static _Thread_local run_loop_t s_run_loop = chip8_run_fast;
+
+static void
+chip8_select_run_loop (void)
+{
+    if (s_num_breakpoints != 0 || s_num_watchpoints != 0 || s_trace) {
+        s_run_loop = chip8_run_checked;
+    } else if (s_native_run != NULL) {
+        s_run_loop = s_native_run;
+    } else {
+        s_run_loop = chip8_run_fast;
+    }
+}
+
+uint32_t
+chip8_run (uint32_t count)
+{
+    uint32_t ran;
+
+    s_stop_reason = CHIP8_STOP_NONE;
+    ran = s_run_loop(count);
+    s_counters.instructions += ran;
+
+    return (ran);
+}
+
+chip8_stop_reason_et
+chip8_get_stop_reason (uint16_t *addr)
+{
+    if (addr != NULL) {
+        *addr = s_stop_addr;
+    }
+
+    return s_stop_reason;
+}
+
+chip8_fault_et
+chip8_get_fault (uint16_t *addr)
+{
+    if (addr != NULL) {
+        *addr = s_fault_addr;
+    }
+
+    return s_fault;
+}
+
+void
+chip8_get_counters (chip8_counters_t *counters)
+{
+    assert(counters != NULL);
+
+    memcpy(counters, &s_counters, sizeof(*counters));
+}
+
+void
+chip8_set_counters (const chip8_counters_t *counters)
+{
+    assert(counters != NULL);
+
+    memcpy(&s_counters, counters, sizeof(s_counters));
+}
+
+static void
+addr_bit_update (uint8_t *map, uint32_t *count, uint16_t addr, bool enabled)
+{
+    uint8_t mask = 1 << (addr % 8);
+
+    if (enabled && (map[addr / 8] & mask) == 0) {
+        map[addr / 8] |= mask;
+        (*count)++;
+    } else if (!enabled && (map[addr / 8] & mask) != 0) {
+        map[addr / 8] &= ~mask;
+        (*count)--;
+    }
+}
+
+void
+chip8_set_breakpoint (uint16_t addr, bool enabled)
+{
+    assert(addr < MEMORY_SIZE);
+
+    addr_bit_update(s_breakpoints, &s_num_breakpoints, addr, enabled);
+    chip8_select_run_loop();
+}
+
+bool
+chip8_get_breakpoint (uint16_t addr)
+{
+    return (addr < MEMORY_SIZE) && ADDR_BIT_TEST(s_breakpoints, addr);
+}
+
+void
+chip8_set_watchpoint (uint16_t addr, uint16_t len, bool enabled)
+{
+    uint32_t end = (uint32_t)addr + len;
+
+    assert(end <= MEMORY_SIZE);
+
+    for (; addr < end; addr++) {
+        addr_bit_update(s_watchpoints, &s_num_watchpoints, addr, enabled);
+    }
+    chip8_select_run_loop();
+}
+
+bool
+chip8_get_watchpoint (uint16_t addr)
+{
+    return (addr < MEMORY_SIZE) && ADDR_BIT_TEST(s_watchpoints, addr);
+}
+
+void
+chip8_set_trace (bool enabled)
+{
+    chip8_writer_stats_t stats;
+    int fd;
+
+    if (enabled && s_trace_stream < 0) {
+        /* Dropped lines are counted instead of stalling the emulation */
+        fflush(stdout);
+        fd = dup(STDOUT_FILENO);
+        if (fd >= 0) {
+            s_trace_stream = chip8_writer_open_fd(fd, TRACE_QUEUE_SIZE,
+                                                  CHIP8_WRITER_DROP);
+        }
+    } else if (!enabled && s_trace_stream >= 0) {
+        chip8_writer_close(s_trace_stream, &stats);
+        s_trace_stream = -1;
+        if (stats.dropped_writes > 0) {
+            printf("Tracing dropped %llu instructions it could not keep up "
+                   "with\n", (unsigned long long)stats.dropped_writes);
+        }
+    }
+
+    s_trace = enabled;
+    chip8_select_run_loop();
+}
+
+void
+chip8_get_resolution (int *width, int *height)
+{
+    *width = display_width();
+    *height = display_height();
+}
+
+uint8_t
+chip8_get_pixel (int x, int y)
+{
+    uint8_t color = 0;
+    int plane;
+
+    if (x < 0 || y < 0 || x >= display_width() || y >= display_height()) {
+        return 0;
+    }
+
+    for (plane = 0; plane < NUM_PLANES; plane++) {
+        color |= ((s_vram[plane][y][x / 64] >> (63 - (x % 64))) & 0x1) <<
+                 plane;
+    }
+
+    return (color);
+}
+
+size_t
+chip8_get_vram_packed (uint8_t plane, uint8_t *dst)
+{
+    int words = display_width() / 64;
+    int height = display_height();
+    uint64_t word;
+    int y;
+    int w;
+    int b;
+
+    assert(plane < NUM_PLANES);
+
+    for (y = 0; y < height; y++) {
+        for (w = 0; w < words; w++) {
+            word = s_vram[plane][y][w];
+            for (b = 56; b >= 0; b -= 8) {
+                *dst++ = (word >> b) & 0xFF;
+            }
+        }
+    }
+
+    return (words * sizeof(uint64_t) * height);
+}
+
+chip8_rt_t *
+chip8_rt_get (void)
+{
+    static _Thread_local chip8_rt_t s_rt;
+
+    /* Thread-local addresses differ per thread, so fill in every time */
+    s_rt.memory = s_memory;
+    s_rt.v_regs = s_v_regs;
+    s_rt.i_reg = &s_i_reg;
+    s_rt.pc = &s_pc;
+    s_rt.stack_ptr = &s_stack_ptr;
+    s_rt.paused_for_key_ld = &s_execution_paused_for_key_ld;
+    s_rt.rpl_flags = s_rpl_flags;
+    s_rt.xochip = &s_xochip;
+
+    return &s_rt;
+}
+
+uint32_t
+chip8_rt_interpret (uint32_t count)
+{
+    return chip8_run_fast(count);
+}
+
+uint8_t
+chip8_rt_draw (uint8_t x, uint8_t y, uint16_t sprite_addr, uint8_t num_bytes)
+{
+    return draw_sprite(x, y, sprite_addr, num_bytes);
+}
+
+void
+chip8_rt_clear (void)
+{
+    clear_display();
+}
+
+void
+chip8_rt_display_op (uint16_t op)
+{
+    chip8_interpret_op0(op);
+}
+
+bool
+chip8_rt_set_host_call (uint16_t addr, chip8_host_call_t call, void *ctx)
+{
+    /* 00XX is left to the display instructions */
+    if (addr < CHIP8_RT_HOST_CALL_MIN || addr >= CHIP8_RT_HOST_CALL_MAX) {
+        return false;
+    }
+
+    s_host_calls[addr] = call;
+    s_host_call_ctx[addr] = (call != NULL) ? ctx : NULL;
+
+    return true;
+}
+
+void
+chip8_rt_set_native (chip8_native_run_t run,
+                     chip8_native_invalidate_t invalidate)
+{
+    s_native_run = run;
+    s_native_invalidate = invalidate;
+    chip8_select_run_loop();
 }
 
 void
 chip8_init (void)
 {
     memset(s_memory, 0, sizeof(s_memory));
+    s_high_memory_used = false;
     memset(s_v_regs, 0, sizeof(s_v_regs));
     s_i_reg = 0;
     s_pc = PROGRAM_LOAD_ADDR;
     s_stack_ptr = STACK_BASE_ADDR;
+    s_execution_paused_for_key_ld = false;
+    s_fault = CHIP8_FAULT_NONE;
+    s_xochip = false;
+    s_addr_mask = CLASSIC_MEMORY_SIZE - 1;
     memset(s_vram, 0, sizeof(s_vram));
+    s_plane_mask = 0x1;
+    s_hires = false;
+    memset(s_rpl_flags, 0, sizeof(s_rpl_flags));
+    memset(s_audio_pattern, 0, sizeof(s_audio_pattern));
+    s_audio_pitch = DEFAULT_AUDIO_PITCH;
     memcpy(&s_memory[SPRITE_LOAD_ADDR], s_character_sprite_data,
            sizeof(s_character_sprite_data));
+    memcpy(&s_memory[BIG_SPRITE_LOAD_ADDR], s_big_character_sprite_data,
+           sizeof(s_big_character_sprite_data));
     s_little_endian = need_to_byteswap_opcode();
 }
 
+void
+chip8_set_xochip (bool enabled)
+{
+    s_xochip = enabled;
+    s_high_memory_used = s_high_memory_used || enabled;
+    s_addr_mask = enabled ? MEMORY_SIZE - 1 : CLASSIC_MEMORY_SIZE - 1;
+    s_stack_ptr = enabled ? XOCHIP_STACK_BASE_ADDR : STACK_BASE_ADDR;
+}
+
+bool
+chip8_get_xochip (void)
+{
+    return s_xochip;
+}
+
+void
+chip8_get_audio (uint8_t *pattern, uint8_t *pitch)
+{
+    assert(pattern != NULL && pitch != NULL);
+
+    memcpy(pattern, s_audio_pattern, sizeof(s_audio_pattern));
+    *pitch = s_audio_pitch;
+}
+
+void
+chip8_save_state (chip8_state_t *state)
+{
+    assert(state != NULL);
+
+    /* Classic snapshots stay as cheap as before the XO-CHIP expansion */
+    state->xochip = s_xochip;
+    memcpy(state->memory, s_memory, (size_t)s_addr_mask + 1);
+    memcpy(state->v_regs, s_v_regs, sizeof(s_v_regs));
+    state->i_reg = s_i_reg;
+    state->pc = s_pc;
+    state->stack_ptr = s_stack_ptr;
+    state->paused_for_key_ld = s_execution_paused_for_key_ld;
+    memcpy(state->vram, s_vram, sizeof(s_vram));
+    state->plane_mask = s_plane_mask;
+    state->hires = s_hires;
+    memcpy(state->rpl_flags, s_rpl_flags, sizeof(s_rpl_flags));
+    memcpy(state->audio_pattern, s_audio_pattern, sizeof(s_audio_pattern));
+    state->audio_pitch = s_audio_pitch;
+    state->fault = s_fault;
+    chip8_utils_save_state(&state->utils);
+}
+
+size_t
+chip8_state_size (const chip8_state_t *state)
+{
+    assert(state != NULL);
+
+    return offsetof(chip8_state_t, memory) +
+           (state->xochip ? MEMORY_SIZE : CLASSIC_MEMORY_SIZE);
+}
+
+void
+chip8_restore_state (const chip8_state_t *state)
+{
+    assert(state != NULL);
+
+    chip8_set_xochip(state->xochip);
+    memcpy(s_memory, state->memory, (size_t)s_addr_mask + 1);
+    if (!state->xochip && s_high_memory_used) {
+        memset(&s_memory[CLASSIC_MEMORY_SIZE], 0,
+               sizeof(s_memory) - CLASSIC_MEMORY_SIZE);
+        s_high_memory_used = false;
+    }
+    memcpy(s_v_regs, state->v_regs, sizeof(s_v_regs));
+    s_i_reg = state->i_reg;
+    s_pc = state->pc;
+    s_stack_ptr = state->stack_ptr;
+    s_execution_paused_for_key_ld = state->paused_for_key_ld;
+    memcpy(s_vram, state->vram, sizeof(s_vram));
+    s_plane_mask = state->plane_mask;
+    s_hires = state->hires;
+    memcpy(s_rpl_flags, state->rpl_flags, sizeof(s_rpl_flags));
+    memcpy(s_audio_pattern, state->audio_pattern, sizeof(s_audio_pattern));
+    s_audio_pitch = state->audio_pitch;
+    s_fault = state->fault;
+    /* A faulted machine is parked on the faulting instruction */
+    s_fault_addr = state->pc;
+    chip8_utils_restore_state(&state->utils);
+    /* A thread may restore a snapshot without ever calling chip8_init */
+    s_little_endian = need_to_byteswap_opcode();
+    invalidate_native_code();
+}
+
+int
+chip8_load_program_buffer (const uint8_t *data, size_t len)
+{
+    if (len > (size_t)s_addr_mask + 1 - PROGRAM_LOAD_ADDR) {
+        return (-1);
+    }
+
+    memcpy(&s_memory[PROGRAM_LOAD_ADDR], data, len);
+    invalidate_native_code();
+
+    return (0);
+}
+
 void
 chip8_load_program (char *file_path)
 {
@@ -627,10 +1562,16 @@ chip8_load_program (char *file_path)
     file_size = ftell(fp);
 
     fseek(fp, 0L, SEEK_SET);
+    if (file_size > (size_t)s_addr_mask + 1 - PROGRAM_LOAD_ADDR) {
+        printf("%s is %lu bytes, only %lu fit in memory\n", file_path,
+               file_size, (size_t)s_addr_mask + 1 - PROGRAM_LOAD_ADDR);
+        fclose(fp);
+        exit(1);
+    }
     printf("Loading %lu bytes from %s\n", file_size, file_path);
 
     while (total_bytes_read < file_size) {
-        bytes_read = fread(&s_memory[PROGRAM_LOAD_ADDR], 1,
+        bytes_read = fread(&s_memory[PROGRAM_LOAD_ADDR + total_bytes_read], 1,
                            file_size - total_bytes_read, fp);
         if (bytes_read == 0) {
             printf("Unable to read more data from file\n");
@@ -641,6 +1582,7 @@ chip8_load_program (char *file_path)
     }
 
     printf("Loaded program into memory\n");
+    invalidate_native_code();
 
     fclose(fp);
 }
@@ -9,11 +9,92 @@
 
 #include "chip8_utils.h"
 
+/* The largest display, the SUPER-CHIP high resolution mode */
+#define DISPLAY_WIDTH_PIXELS    128
+#define DISPLAY_HEIGHT_PIXELS   64
+/* The original CHIP-8 display, used until a program asks for more */
+#define LORES_WIDTH_PIXELS      64
+#define LORES_HEIGHT_PIXELS     32
+#define BITS2BYTES(_bits) (_bits / 8)
+/* VRAM rows are one bit per pixel in 64-bit words, leftmost pixel in the
+ * most significant bit of the first word */
+#define VRAM_ROW_WORDS          (DISPLAY_WIDTH_PIXELS / 64)
+/* XO-CHIP bitplanes, classic programs only draw to the first */
+#define NUM_PLANES              2
+/* Largest size of one plane packed into bytes, see chip8_get_vram_packed() */
+#define PACKED_VRAM_SIZE \
+    (BITS2BYTES(DISPLAY_WIDTH_PIXELS) * DISPLAY_HEIGHT_PIXELS)
+
+/* XO-CHIP address space. Classic programs only see the first 4 KB. */
+#define MEMORY_SIZE             0x10000
+#define CLASSIC_MEMORY_SIZE     0x1000
+#define NUM_V_REGISTERS         16
+/* SUPER-CHIP "RPL user flags", saved and loaded with FX75/FX85 */
+#define NUM_RPL_FLAGS           16
+/* XO-CHIP audio, a 128 sample 1-bit pattern loaded with F002 */
+#define AUDIO_PATTERN_SIZE      16
+/* FX3A pitch at which the pattern plays at 4000 samples per second */
+#define DEFAULT_AUDIO_PITCH     64
+
+/**
+ * @brief       A complete snapshot of the machine.
+ *
+ * Everything needed to resume execution later: memory, registers,
+ * VRAM and the timer/key/RNG state kept by chip8_utils. Memory comes
+ * last and only its first CLASSIC_MEMORY_SIZE bytes are used unless
+ * xochip is set, so a classic snapshot fits in chip8_state_size() bytes.
+ */
+typedef struct chip8_state_s {
+    bool                xochip;
+    uint8_t             v_regs[NUM_V_REGISTERS];
+    uint16_t            i_reg;
+    uint16_t            pc;
+    uint16_t            stack_ptr;
+    bool                paused_for_key_ld;
+    uint64_t            vram[NUM_PLANES][DISPLAY_HEIGHT_PIXELS]
+                            [VRAM_ROW_WORDS];
+    uint8_t             plane_mask;
+    bool                hires;
+    uint8_t             rpl_flags[NUM_RPL_FLAGS];
+    uint8_t             audio_pattern[AUDIO_PATTERN_SIZE];
+    uint8_t             audio_pitch;
+    uint8_t             fault;
+    chip8_utils_state_t utils;
+    uint8_t             memory[MEMORY_SIZE];
+} chip8_state_t;
+
 /**
  * @brief       Initializes the interpreter core
  */
 void chip8_init(void);
 
+/**
+ * @brief       Switches between the classic and XO-CHIP memory layouts.
+ *
+ * XO-CHIP programs get 64 KB of memory and keep the stack in the
+ * interpreter area below 0x200 instead of at 0xEA0. Resets the stack, so
+ * call it after chip8_init() and before loading a program.
+ *
+ * @param[in]   enabled     true for XO-CHIP
+ */
+void chip8_set_xochip(bool enabled);
+
+/**
+ * @brief       Checks whether the XO-CHIP memory layout is in use
+ */
+bool chip8_get_xochip(void);
+
+/**
+ * @brief       Gets the XO-CHIP audio pattern and pitch.
+ *
+ * The pattern plays, most significant bit of the first byte first, for
+ * as long as the sound timer runs.
+ *
+ * @param[out]  pattern     AUDIO_PATTERN_SIZE bytes of 1-bit samples
+ * @param[out]  pitch       The FX3A pitch, see DEFAULT_AUDIO_PITCH
+ */
+void chip8_get_audio(uint8_t *pattern, uint8_t *pitch);
+
 /**
  * @brief       Loads a program into the interpreter
  *
@@ -21,10 +102,15 @@ void chip8_init(void);
  */
 void chip8_load_program(char *file_path);
 
-
-#define DISPLAY_WIDTH_PIXELS    64
-#define DISPLAY_HEIGHT_PIXELS   32
-#define BITS2BYTES(_bits) (_bits / 8)
+/**
+ * @brief       Loads a program image already in memory
+ *
+ * @param[in]   data    The program image
+ * @param[in]   len     Length of the image in bytes
+ *
+ * @returns     0 on success, -1 if the image does not fit in memory
+ */
+int chip8_load_program_buffer(const uint8_t *data, size_t len);
 
 /**
  * @brief       Steps the interpreter one instruction
@@ -32,11 +118,155 @@ void chip8_load_program(char *file_path);
 void chip8_step(void);
 
 /**
- * @brief       Gets the contents of VRAM
+ * @brief       Why chip8_run() returned early
+ */
+typedef enum {
+    CHIP8_STOP_NONE,
+    /* About to execute an instruction with a breakpoint */
+    CHIP8_STOP_BREAKPOINT,
+    /* The last instruction wrote to a watched address */
+    CHIP8_STOP_WATCHPOINT,
+    /* Waiting on LD Vx, K for a key press */
+    CHIP8_STOP_KEY_WAIT,
+    /* The machine faulted, see chip8_get_fault() */
+    CHIP8_STOP_FAULT,
+} chip8_stop_reason_et;
+
+/**
+ * @brief       Why the machine stopped for good
+ */
+typedef enum {
+    CHIP8_FAULT_NONE,
+    /* An opcode no supported machine defines, including 0NNN without a
+     * host call, see chip8_rt_set_host_call() */
+    CHIP8_FAULT_BAD_OPCODE,
+    /* CALL with the stack full */
+    CHIP8_FAULT_STACK_OVERFLOW,
+    /* RET with the stack empty */
+    CHIP8_FAULT_STACK_UNDERFLOW,
+    /* A 0NNN host call reported an error */
+    CHIP8_FAULT_HOST_CALL,
+} chip8_fault_et;
+
+/**
+ * @brief       Runs the interpreter for a number of instructions.
+ *
+ * While no breakpoints, watchpoints or tracing are set this runs a loop
+ * without any debugging checks. Setting any of them swaps in a checked
+ * loop until they are all cleared again.
+ *
+ * @param[in]   count   Maximum number of instructions to execute
+ *
+ * @returns     The number of instructions executed
+ */
+uint32_t chip8_run(uint32_t count);
+
+/**
+ * @brief       Gets why the last chip8_run() stopped
+ *
+ * @param[out]  addr    The breakpoint or written watchpoint address, or
+ *                      the faulting instruction, may be NULL
+ *
+ * @returns     The stop reason
+ */
+chip8_stop_reason_et chip8_get_stop_reason(uint16_t *addr);
+
+/**
+ * @brief       Gets the fault the machine stopped on.
+ *
+ * A faulted machine stays parked on the faulting instruction, every
+ * chip8_run() stops straight away with CHIP8_STOP_FAULT until
+ * chip8_init() or chip8_restore_state() replaces the machine.
+ *
+ * @param[out]  addr    The faulting instruction, may be NULL
+ *
+ * @returns     The fault, CHIP8_FAULT_NONE if the machine is running
+ */
+chip8_fault_et chip8_get_fault(uint16_t *addr);
+
+/**
+ * @brief       Usage counters of the calling thread's machines.
+ *
+ * Never reset, not even by chip8_init(), and not part of snapshots.
+ */
+typedef struct chip8_counters_s {
+    /* Instructions executed by chip8_run() and chip8_step() */
+    uint64_t    instructions;
+    /* DRW instructions */
+    uint64_t    draws;
+    /* DRW instructions that set VF */
+    uint64_t    collisions;
+} chip8_counters_t;
+
+/**
+ * @brief       Gets the calling thread's usage counters
+ */
+void chip8_get_counters(chip8_counters_t *counters);
+
+/**
+ * @brief       Puts back counters from chip8_get_counters(), so that runs
+ *              the program did not ask for, such as timing runs, leave no
+ *              trace in them
+ */
+void chip8_set_counters(const chip8_counters_t *counters);
+
+/**
+ * @brief       Sets or clears a breakpoint on an instruction address
+ */
+void chip8_set_breakpoint(uint16_t addr, bool enabled);
+
+/**
+ * @brief       Checks for a breakpoint on an instruction address
+ */
+bool chip8_get_breakpoint(uint16_t addr);
+
+/**
+ * @brief       Sets or clears write watchpoints on a range of memory
+ *
+ * @param[in]   addr    First address to watch
+ * @param[in]   len     Number of bytes to watch
+ * @param[in]   enabled Whether to set or clear the watchpoints
+ */
+void chip8_set_watchpoint(uint16_t addr, uint16_t len, bool enabled);
+
+/**
+ * @brief       Checks for a write watchpoint on an address
+ */
+bool chip8_get_watchpoint(uint16_t addr);
+
+/**
+ * @brief       Enables printing every executed instruction
+ */
+void chip8_set_trace(bool enabled);
+
+/**
+ * @brief       Gets the resolution of the current display mode
  *
- * @returns     The VRAM buffer, packed as bytes.
+ * @param[out]  width   64 or 128 pixels
+ * @param[out]  height  32 or 64 pixels
  */
-uint8_t *chip8_get_vram(void);
+void chip8_get_resolution(int *width, int *height);
+
+/**
+ * @brief       Gets the color of a pixel of the current display mode
+ *
+ * @returns     Bit n is set if the pixel is lit in plane n, 0 if unlit
+ */
+uint8_t chip8_get_pixel(int x, int y);
+
+/**
+ * @brief       Copies one plane of VRAM out at one bit per pixel
+ *
+ * Only the current display mode's resolution is copied. Rows are stored
+ * top to bottom, each row left to right with the leftmost pixel in the
+ * most significant bit of its byte.
+ *
+ * @param[in]   plane   0 for the classic plane, 1 for the XO-CHIP one
+ * @param[out]  dst     PACKED_VRAM_SIZE bytes
+ *
+ * @returns     The number of bytes written
+ */
+size_t chip8_get_vram_packed(uint8_t plane, uint8_t *dst);
 
 /**
  * @brief       Informs the interpreter core about a key press
@@ -45,4 +275,34 @@ uint8_t *chip8_get_vram(void);
  */
 void chip8_notify_key_pressed(chip8_key_et key);
 
+/**
+ * @brief       Captures the current machine state.
+ *
+ * The interpreter state is kept per-thread, so each thread saves and
+ * restores its own machine.
+ *
+ * @param[out]  state   Where to store the snapshot
+ */
+void chip8_save_state(chip8_state_t *state);
+
+/**
+ * @brief       Gets the number of bytes a snapshot occupies.
+ *
+ * Snapshots may be copied to and kept in buffers of this size instead of
+ * sizeof(chip8_state_t). Such a buffer only holds snapshots of the same
+ * memory layout, chip8_save_state() into it must not switch to XO-CHIP.
+ *
+ * @param[in]   state   A snapshot from chip8_save_state()
+ *
+ * @returns     The size of the snapshot in bytes
+ */
+size_t chip8_state_size(const chip8_state_t *state);
+
+/**
+ * @brief       Replaces the current machine state with a snapshot.
+ *
+ * @param[in]   state   A snapshot from chip8_save_state()
+ */
+void chip8_restore_state(const chip8_state_t *state);
+
 #endif /* __CHIP8_H__ */
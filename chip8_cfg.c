@@ -0,0 +1,372 @@
+/*
+ * chip8_cfg - CHIP8 Program Control-Flow Analysis
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_cfg.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Instructions after which a basic block cannot continue */
+#define BLOCK_ENDING_FLAGS  (CHIP8_INSN_JUMP | CHIP8_INSN_CALL | \
+                             CHIP8_INSN_RET | CHIP8_INSN_SKIP | \
+                             CHIP8_INSN_UNSUPPORTED | CHIP8_INSN_HALT | \
+                             CHIP8_INSN_HOST_CALL)
+/* Instructions reported as issues */
+#define ISSUE_FLAGS         (CHIP8_INSN_UNSUPPORTED | CHIP8_INSN_INDIRECT | \
+                             CHIP8_INSN_HOST_CALL)
+
+typedef struct worklist_s {
+    uint16_t   *addrs;
+    size_t      len;
+    size_t      cap;
+} worklist_t;
+
+static bool
+worklist_push (worklist_t *list, uint16_t addr)
+{
+    uint16_t *addrs;
+
+    if (list->len == list->cap) {
+        list->cap = list->cap ? list->cap * 2 : 64;
+        addrs = realloc(list->addrs, list->cap * sizeof(*addrs));
+        if (addrs == NULL) {
+            return false;
+        }
+        list->addrs = addrs;
+    }
+
+    list->addrs[list->len++] = addr;
+    return true;
+}
+
+static bool
+add_issue (chip8_cfg_t *cfg, uint16_t addr, uint16_t op, uint16_t kind)
+{
+    chip8_cfg_issue_t *issues;
+
+    issues = realloc(cfg->issues, (cfg->num_issues + 1) * sizeof(*issues));
+    if (issues == NULL) {
+        return false;
+    }
+
+    cfg->issues = issues;
+    cfg->issues[cfg->num_issues].addr = addr;
+    cfg->issues[cfg->num_issues].op = op;
+    cfg->issues[cfg->num_issues].kind = kind;
+    cfg->num_issues++;
+
+    return true;
+}
+
+static bool
+add_branch_target (chip8_cfg_t *cfg, worklist_t *work, uint32_t addr)
+{
+    if (addr >= MEMORY_SIZE) {
+        return true;
+    }
+
+    cfg->byte_flags[addr] |= CHIP8_CFG_LEADER;
+    return worklist_push(work, addr);
+}
+
+/* Where a skip at addr lands, the same as in the interpreter */
+static uint32_t
+skip_target (const chip8_cfg_t *cfg, uint32_t addr)
+{
+    return addr + 2 + OPC_SKIP_LEN(chip8_fetch_op(cfg->memory, addr + 2),
+                                   cfg->xochip);
+}
+
+/* Decodes instructions starting at addr until control flow leaves the
+ * straight line, queueing any branch targets found on the way. */
+static bool
+trace_from (chip8_cfg_t *cfg, worklist_t *work, uint32_t addr)
+{
+    chip8_insn_t insn;
+
+    while (addr + 1 < MEMORY_SIZE &&
+           (cfg->byte_flags[addr] & CHIP8_CFG_CODE) == 0) {
+
+        if ((cfg->byte_flags[addr] & CHIP8_CFG_OPERAND) ||
+            (cfg->byte_flags[addr + 1] & CHIP8_CFG_CODE)) {
+            cfg->byte_flags[addr] |= CHIP8_CFG_OVERLAP;
+        }
+
+        chip8_decode_at(cfg->memory, addr, &insn);
+        cfg->byte_flags[addr] |= CHIP8_CFG_CODE;
+        cfg->byte_flags[addr + 1] |= CHIP8_CFG_OPERAND;
+        if (insn.size == 4 && addr + 3 < MEMORY_SIZE) {
+            cfg->byte_flags[addr + 2] |= CHIP8_CFG_OPERAND;
+            cfg->byte_flags[addr + 3] |= CHIP8_CFG_OPERAND;
+        }
+
+        if (insn.flags & CHIP8_INSN_SETS_I) {
+            cfg->byte_flags[insn.target] |= CHIP8_CFG_DATA_REF;
+        }
+
+        if (insn.flags & ISSUE_FLAGS) {
+            if (!add_issue(cfg, addr, insn.op, insn.flags & ISSUE_FLAGS)) {
+                return false;
+            }
+        }
+
+        if (insn.flags & (CHIP8_INSN_UNSUPPORTED | CHIP8_INSN_RET |
+                          CHIP8_INSN_HALT)) {
+            /* The interpreter stops dead on unsupported opcodes and EXIT */
+            break;
+        }
+
+        if (insn.flags & CHIP8_INSN_JUMP) {
+            return add_branch_target(cfg, work, insn.target);
+        }
+
+        if (insn.flags & CHIP8_INSN_CALL) {
+            cfg->byte_flags[insn.target] |= CHIP8_CFG_SUBROUTINE;
+            if (!add_branch_target(cfg, work, insn.target) ||
+                !add_branch_target(cfg, work, addr + 2)) {
+                return false;
+            }
+            break;
+        }
+
+        if (insn.flags & CHIP8_INSN_SKIP) {
+            if (!add_branch_target(cfg, work, addr + 2) ||
+                !add_branch_target(cfg, work, skip_target(cfg, addr))) {
+                return false;
+            }
+            break;
+        }
+
+        addr += insn.size;
+    }
+
+    return true;
+}
+
+static bool
+build_blocks (chip8_cfg_t *cfg)
+{
+    chip8_cfg_block_t *blocks;
+    chip8_cfg_block_t *block;
+    chip8_insn_t insn;
+    uint32_t addr;
+    size_t cap = 0;
+
+    for (addr = 0; addr + 1 < MEMORY_SIZE; addr++) {
+        if ((cfg->byte_flags[addr] & CHIP8_CFG_CODE) == 0) {
+            continue;
+        }
+
+        if (cfg->num_blocks == cap) {
+            cap = cap ? cap * 2 : 64;
+            blocks = realloc(cfg->blocks, cap * sizeof(*blocks));
+            if (blocks == NULL) {
+                return false;
+            }
+            cfg->blocks = blocks;
+        }
+
+        block = &cfg->blocks[cfg->num_blocks++];
+        memset(block, 0, sizeof(*block));
+        block->start = addr;
+        block->call_target = CHIP8_CFG_NO_CALL;
+
+        /* Extend the block until it branches or runs into a leader */
+        for (;;) {
+            chip8_decode_at(cfg->memory, addr, &insn);
+            block->flags |= insn.flags;
+            block->num_insns++;
+            addr += insn.size;
+
+            if ((insn.flags & BLOCK_ENDING_FLAGS) ||
+                addr + 1 >= MEMORY_SIZE ||
+                (cfg->byte_flags[addr] & CHIP8_CFG_CODE) == 0 ||
+                (cfg->byte_flags[addr] & CHIP8_CFG_LEADER)) {
+                break;
+            }
+        }
+        block->end = addr;
+
+        if (insn.flags & (CHIP8_INSN_RET | CHIP8_INSN_UNSUPPORTED |
+                          CHIP8_INSN_HALT)) {
+            block->num_succ = 0;
+        } else if (insn.flags & CHIP8_INSN_JUMP) {
+            block->succ[block->num_succ++] = insn.target;
+        } else if (insn.flags & CHIP8_INSN_SKIP) {
+            block->succ[block->num_succ++] = addr;
+            block->succ[block->num_succ++] = skip_target(cfg, addr - 2);
+        } else {
+            if (insn.flags & CHIP8_INSN_CALL) {
+                block->call_target = insn.target;
+            }
+            if (addr + 1 < MEMORY_SIZE &&
+                (cfg->byte_flags[addr] & CHIP8_CFG_CODE)) {
+                block->succ[block->num_succ++] = addr;
+            }
+        }
+
+        /* Step back so the loop increment lands on the next address */
+        addr--;
+    }
+
+    return true;
+}
+
+static int
+compare_issues (const void *a, const void *b)
+{
+    return (int)((const chip8_cfg_issue_t *)a)->addr -
+           (int)((const chip8_cfg_issue_t *)b)->addr;
+}
+
+static bool
+assign_routines (chip8_cfg_t *cfg)
+{
+    worklist_t work = { NULL, 0, 0 };
+    bool *seen = calloc(cfg->num_blocks, sizeof(*seen));
+    const chip8_cfg_block_t *block;
+    uint16_t routine;
+    size_t r;
+    size_t i;
+    bool ok = (seen != NULL);
+
+    /* The program entry owns whatever it reaches first, then each
+     * subroutine in address order */
+    for (r = 0; ok && r <= cfg->num_subroutines; r++) {
+        routine = (r == 0) ? cfg->entry : cfg->subroutines[r - 1];
+        ok = worklist_push(&work, routine);
+
+        while (ok && work.len > 0) {
+            block = chip8_cfg_find_block(cfg, work.addrs[--work.len]);
+            if (block == NULL || seen[block - cfg->blocks]) {
+                continue;
+            }
+
+            seen[block - cfg->blocks] = true;
+            cfg->blocks[block - cfg->blocks].routine = routine;
+            for (i = 0; ok && i < block->num_succ; i++) {
+                ok = worklist_push(&work, block->succ[i]);
+            }
+        }
+    }
+
+    free(work.addrs);
+    free(seen);
+    return ok;
+}
+
+static bool
+collect_subroutines (chip8_cfg_t *cfg)
+{
+    uint32_t addr;
+
+    for (addr = 0; addr < MEMORY_SIZE; addr++) {
+        if (cfg->byte_flags[addr] & CHIP8_CFG_SUBROUTINE) {
+            cfg->num_subroutines++;
+        }
+    }
+
+    if (cfg->num_subroutines == 0) {
+        return true;
+    }
+
+    cfg->subroutines = malloc(cfg->num_subroutines *
+                              sizeof(*cfg->subroutines));
+    if (cfg->subroutines == NULL) {
+        return false;
+    }
+
+    cfg->num_subroutines = 0;
+    for (addr = 0; addr < MEMORY_SIZE; addr++) {
+        if (cfg->byte_flags[addr] & CHIP8_CFG_SUBROUTINE) {
+            cfg->subroutines[cfg->num_subroutines++] = addr;
+        }
+    }
+
+    return true;
+}
+
+int
+chip8_cfg_analyze (chip8_cfg_t *cfg, const uint8_t *memory,
+                   uint16_t rom_start, uint16_t rom_len, bool xochip)
+{
+    worklist_t work = { NULL, 0, 0 };
+    bool ok;
+
+    assert(cfg != NULL);
+    assert(memory != NULL);
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->memory = memory;
+    cfg->xochip = xochip;
+    cfg->entry = rom_start;
+    cfg->rom_start = rom_start;
+    cfg->rom_end = rom_start + rom_len;
+
+    ok = add_branch_target(cfg, &work, rom_start);
+    while (ok && work.len > 0) {
+        ok = trace_from(cfg, &work, work.addrs[--work.len]);
+    }
+    free(work.addrs);
+
+    ok = ok && collect_subroutines(cfg) && build_blocks(cfg) &&
+         assign_routines(cfg);
+
+    if (ok && cfg->num_issues > 1) {
+        /* Traversal order is arbitrary, report in address order */
+        qsort(cfg->issues, cfg->num_issues, sizeof(*cfg->issues),
+              compare_issues);
+    }
+
+    if (!ok) {
+        chip8_cfg_free(cfg);
+        return (-1);
+    }
+
+    return (0);
+}
+
+void
+chip8_cfg_free (chip8_cfg_t *cfg)
+{
+    free(cfg->blocks);
+    free(cfg->subroutines);
+    free(cfg->issues);
+    cfg->blocks = NULL;
+    cfg->subroutines = NULL;
+    cfg->issues = NULL;
+    cfg->num_blocks = 0;
+    cfg->num_subroutines = 0;
+    cfg->num_issues = 0;
+}
+
+const chip8_cfg_block_t *
+chip8_cfg_find_block (const chip8_cfg_t *cfg, uint16_t start)
+{
+    size_t lo = 0;
+    size_t hi = cfg->num_blocks;
+    size_t mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (cfg->blocks[mid].start == start) {
+            return &cfg->blocks[mid];
+        } else if (cfg->blocks[mid].start < start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+bool
+chip8_cfg_is_data (const chip8_cfg_t *cfg, uint16_t addr)
+{
+    return (cfg->byte_flags[addr] & (CHIP8_CFG_CODE | CHIP8_CFG_OPERAND)) == 0;
+}
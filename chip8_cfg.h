@@ -0,0 +1,111 @@
+/*
+ * chip8_cfg - CHIP8 Program Control-Flow Analysis
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_CFG_H__
+#define __CHIP8_CFG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+#include "chip8_decode.h"
+
+/* Per-byte classification, see chip8_cfg_t.byte_flags */
+#define CHIP8_CFG_CODE          0x01    /* First byte of an instruction */
+#define CHIP8_CFG_OPERAND       0x02    /* Second byte of an instruction */
+#define CHIP8_CFG_LEADER        0x04    /* Starts a basic block */
+#define CHIP8_CFG_SUBROUTINE    0x08    /* Target of a CALL */
+#define CHIP8_CFG_DATA_REF      0x10    /* Target of LD I, NNN */
+#define CHIP8_CFG_OVERLAP       0x20    /* Decoded both as opcode and operand */
+
+#define CHIP8_CFG_NO_CALL       (-1)
+
+/**
+ * @brief      A basic block: straight-line code with a single entry
+ */
+typedef struct chip8_cfg_block_s {
+    uint16_t    start;
+    /* Address following the last instruction */
+    uint32_t    end;
+    uint16_t    num_insns;
+    /* CHIP8_INSN_* flags of all instructions in the block, OR'd */
+    uint16_t    flags;
+    /* Successor blocks within the same routine */
+    uint16_t    succ[2];
+    uint8_t     num_succ;
+    /* Subroutine called by the last instruction, or CHIP8_CFG_NO_CALL */
+    int32_t     call_target;
+    /* Entry of the routine the block was first reached from */
+    uint16_t    routine;
+} chip8_cfg_block_t;
+
+/**
+ * @brief      An instruction that needs attention
+ */
+typedef struct chip8_cfg_issue_s {
+    uint16_t    addr;
+    uint16_t    op;
+    /* CHIP8_INSN_UNSUPPORTED, CHIP8_INSN_INDIRECT or
+     * CHIP8_INSN_HOST_CALL */
+    uint16_t    kind;
+} chip8_cfg_issue_t;
+
+/**
+ * @brief      Result of analysing a program
+ */
+typedef struct chip8_cfg_s {
+    const uint8_t      *memory;
+    bool                xochip;
+    uint16_t            entry;
+    uint16_t            rom_start;
+    uint32_t            rom_end;
+    uint8_t             byte_flags[MEMORY_SIZE];
+    /* Sorted by start address */
+    chip8_cfg_block_t  *blocks;
+    size_t              num_blocks;
+    /* Sorted subroutine entry points */
+    uint16_t           *subroutines;
+    size_t              num_subroutines;
+    chip8_cfg_issue_t  *issues;
+    size_t              num_issues;
+} chip8_cfg_t;
+
+/**
+ * @brief      Recovers code, data, basic blocks and subroutines of a program
+ *             by recursive traversal from its entry point.
+ *
+ * @param[out] cfg        The analysis, release with chip8_cfg_free()
+ * @param[in]  memory     MEMORY_SIZE bytes with the program loaded; must
+ *                        outlive cfg
+ * @param[in]  rom_start  Load (and entry) address of the program
+ * @param[in]  rom_len    Length of the program
+ * @param[in]  xochip     true to follow skips the XO-CHIP way
+ *
+ * @return     0 on success, -1 on allocation failure
+ */
+int chip8_cfg_analyze(chip8_cfg_t *cfg, const uint8_t *memory,
+                      uint16_t rom_start, uint16_t rom_len, bool xochip);
+
+/**
+ * @brief      Releases the memory held by an analysis
+ */
+void chip8_cfg_free(chip8_cfg_t *cfg);
+
+/**
+ * @brief      Finds the basic block starting at an address
+ *
+ * @return     The block, or NULL if no block starts there
+ */
+const chip8_cfg_block_t *chip8_cfg_find_block(const chip8_cfg_t *cfg,
+                                              uint16_t start);
+
+/**
+ * @brief      Checks whether a byte was only ever reached as data
+ */
+bool chip8_cfg_is_data(const chip8_cfg_t *cfg, uint16_t addr);
+
+#endif /* __CHIP8_CFG_H__ */
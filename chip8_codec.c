@@ -0,0 +1,210 @@
+/*
+ * chip8_codec - CHIP8 Frame Delta Encoding
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_codec.h"
+
+#include <string.h>
+
+size_t
+chip8_codec_put_varint (uint8_t *out, uint64_t value)
+{
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        out[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[len++] = value;
+
+    return len;
+}
+
+size_t
+chip8_codec_get_varint (const uint8_t *in, size_t len, uint64_t *value)
+{
+    size_t i;
+
+    *value = 0;
+    for (i = 0; i < len && i < CHIP8_CODEC_MAX_VARINT; i++) {
+        *value |= (uint64_t)(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+size_t
+chip8_codec_encode_delta (const uint8_t *prev, const uint8_t *cur,
+                          size_t len, uint8_t *out)
+{
+    size_t used = 0;
+    size_t start;
+    size_t zeros;
+    size_t i = 0;
+    size_t j;
+
+#define XOR(_i) (cur[_i] ^ (prev ? prev[_i] : 0))
+
+    while (i < len) {
+        for (zeros = 0; i < len && XOR(i) == 0; i++) {
+            zeros++;
+        }
+        if (i == len) {
+            break;
+        }
+
+        /* A lone unchanged byte is cheaper as a literal than as the end
+         * of one run and the start of another */
+        for (start = i; i < len; i++) {
+            if (XOR(i) == 0 && (i + 1 == len || XOR(i + 1) == 0)) {
+                break;
+            }
+        }
+
+        used += chip8_codec_put_varint(&out[used], zeros);
+        used += chip8_codec_put_varint(&out[used], i - start);
+        for (j = start; j < i; j++) {
+            out[used++] = XOR(j);
+        }
+    }
+
+#undef XOR
+
+    return used;
+}
+
+bool
+chip8_codec_decode_delta (const uint8_t *in, size_t in_len, uint8_t *buf,
+                          size_t len)
+{
+    uint64_t zeros;
+    uint64_t literals;
+    size_t used = 0;
+    size_t pos = 0;
+    size_t n;
+
+    while (used < in_len) {
+        n = chip8_codec_get_varint(&in[used], in_len - used, &zeros);
+        if (n == 0) {
+            return false;
+        }
+        used += n;
+        n = chip8_codec_get_varint(&in[used], in_len - used, &literals);
+        if (n == 0) {
+            return false;
+        }
+        used += n;
+
+        if (zeros > len - pos || literals > len - pos - zeros ||
+            literals > in_len - used) {
+            return false;
+        }
+        pos += zeros;
+        while (literals-- > 0) {
+            buf[pos++] ^= in[used++];
+        }
+    }
+
+    return true;
+}
+
+size_t
+chip8_codec_encode_frame (const chip8_frontend_frame_t *prev,
+                          const chip8_frontend_frame_t *cur,
+                          uint64_t number, uint8_t *out)
+{
+    uint8_t delta[CHIP8_CODEC_MAX_FRAME];
+    size_t size = cur->width / 8 * cur->height;
+    size_t used = 0;
+    size_t len;
+    int plane;
+
+    if (prev != NULL &&
+        (prev->width != cur->width || prev->height != cur->height ||
+         prev->planes != cur->planes)) {
+        prev = NULL;
+    }
+
+    out[used++] = (prev == NULL) ? CHIP8_CODEC_KEYFRAME : CHIP8_CODEC_DELTA;
+    used += chip8_codec_put_varint(&out[used], number);
+    used += chip8_codec_put_varint(&out[used], cur->width);
+    used += chip8_codec_put_varint(&out[used], cur->height);
+    used += chip8_codec_put_varint(&out[used], cur->planes);
+
+    for (plane = 0; plane < cur->planes; plane++) {
+        len = chip8_codec_encode_delta(prev ? prev->packed[plane] : NULL,
+                                       cur->packed[plane], size, delta);
+        used += chip8_codec_put_varint(&out[used], len);
+        memcpy(&out[used], delta, len);
+        used += len;
+    }
+
+    return used;
+}
+
+size_t
+chip8_codec_decode_frame (const uint8_t *in, size_t len,
+                          chip8_frontend_frame_t *frame, uint64_t *number,
+                          chip8_codec_type_et *type)
+{
+    uint64_t fields[4];
+    uint64_t delta_len;
+    size_t used = 1;
+    size_t size;
+    size_t n;
+    int plane;
+    int i;
+
+    if (len < 1 ||
+        (in[0] != CHIP8_CODEC_KEYFRAME && in[0] != CHIP8_CODEC_DELTA)) {
+        return 0;
+    }
+    *type = (chip8_codec_type_et)in[0];
+
+    /* Number, width, height and planes */
+    for (i = 0; i < 4; i++) {
+        n = chip8_codec_get_varint(&in[used], len - used, &fields[i]);
+        if (n == 0) {
+            return 0;
+        }
+        used += n;
+    }
+    if (fields[1] == 0 || fields[1] % 8 != 0 ||
+        fields[1] > DISPLAY_WIDTH_PIXELS || fields[2] == 0 ||
+        fields[2] > DISPLAY_HEIGHT_PIXELS || fields[3] == 0 ||
+        fields[3] > NUM_PLANES) {
+        return 0;
+    }
+
+    if (*type == CHIP8_CODEC_KEYFRAME) {
+        memset(frame->packed, 0, sizeof(frame->packed));
+        frame->width = fields[1];
+        frame->height = fields[2];
+        frame->planes = fields[3];
+    } else if (frame->width != fields[1] || frame->height != fields[2] ||
+               frame->planes != fields[3]) {
+        return 0;
+    }
+    *number = fields[0];
+    size = frame->width / 8 * frame->height;
+
+    for (plane = 0; plane < frame->planes; plane++) {
+        n = chip8_codec_get_varint(&in[used], len - used, &delta_len);
+        if (n == 0 || delta_len > len - used - n) {
+            return 0;
+        }
+        used += n;
+        if (!chip8_codec_decode_delta(&in[used], delta_len,
+                                      frame->packed[plane], size)) {
+            return 0;
+        }
+        used += delta_len;
+    }
+
+    return used;
+}
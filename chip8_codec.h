@@ -0,0 +1,106 @@
+/*
+ * chip8_codec - CHIP8 Frame Delta Encoding
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_CODEC_H__
+#define __CHIP8_CODEC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8_frontend.h"
+
+/* The largest encoded frame: its header, and every byte of every plane
+ * as literals with the run lengths around them */
+#define CHIP8_CODEC_MAX_FRAME \
+    (32 + NUM_PLANES * (PACKED_VRAM_SIZE + PACKED_VRAM_SIZE / 2 + 16))
+
+/* Longest varint, for 64 bits */
+#define CHIP8_CODEC_MAX_VARINT  10
+
+/**
+ * @brief      Frame types
+ */
+typedef enum {
+    /* Against a blank screen, decodes without the frame before */
+    CHIP8_CODEC_KEYFRAME = 'K',
+    /* Against the frame before */
+    CHIP8_CODEC_DELTA    = 'D',
+} chip8_codec_type_et;
+
+/**
+ * @brief      Writes an unsigned LEB128 varint
+ *
+ * @returns    Bytes written, at most CHIP8_CODEC_MAX_VARINT
+ */
+size_t chip8_codec_put_varint(uint8_t *out, uint64_t value);
+
+/**
+ * @brief      Reads an unsigned LEB128 varint
+ *
+ * @returns    Bytes read, 0 if it is truncated or too long
+ */
+size_t chip8_codec_get_varint(const uint8_t *in, size_t len,
+                              uint64_t *value);
+
+/**
+ * @brief      Run-length encodes the XOR of two buffers.
+ *
+ * The output is pairs of runs: a varint count of unchanged bytes, a
+ * varint count of changed bytes, and the changed bytes XORed. Unchanged
+ * bytes at the end are left out.
+ *
+ * @param[in]  prev    The buffer before, NULL for all zeros
+ * @param[in]  cur     The buffer now
+ * @param[in]  len     Size of both
+ * @param[out] out     At least len + len / 2 + 2 * CHIP8_CODEC_MAX_VARINT
+ *                     bytes
+ *
+ * @returns    Bytes written
+ */
+size_t chip8_codec_encode_delta(const uint8_t *prev, const uint8_t *cur,
+                                size_t len, uint8_t *out);
+
+/**
+ * @brief      XORs an encoded delta into a buffer
+ *
+ * @returns    false if it is corrupt or runs past len
+ */
+bool chip8_codec_decode_delta(const uint8_t *in, size_t in_len,
+                                uint8_t *buf, size_t len);
+
+/**
+ * @brief      Encodes a frame: its type, number, resolution and planes, and
+ *             the delta of each plane
+ *
+ * @param[in]  prev    The frame before, NULL for a keyframe. A keyframe is
+ *                     also written if the resolution or planes changed.
+ * @param[in]  cur     The frame
+ * @param[in]  number  Its main loop pass
+ * @param[out] out     CHIP8_CODEC_MAX_FRAME bytes
+ *
+ * @returns    Bytes written
+ */
+size_t chip8_codec_encode_frame(const chip8_frontend_frame_t *prev,
+                                const chip8_frontend_frame_t *cur,
+                                uint64_t number, uint8_t *out);
+
+/**
+ * @brief      Decodes a frame over the one before it
+ *
+ * @param[in,out] frame   The frame before, replaced by this one. Anything
+ *                        will do before a keyframe.
+ * @param[out]    number  Its main loop pass
+ * @param[out]    type    Keyframe or delta
+ *
+ * @returns    Bytes read, 0 if they are corrupt or a delta changes the
+ *             resolution. frame is then left part decoded.
+ */
+size_t chip8_codec_decode_frame(const uint8_t *in, size_t len,
+                                chip8_frontend_frame_t *frame,
+                                uint64_t *number, chip8_codec_type_et *type);
+
+#endif /* __CHIP8_CODEC_H__ */
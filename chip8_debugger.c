@@ -0,0 +1,282 @@
+/*
+ * chip8_debugger - CHIP8 Interpreter Interactive Debugger
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_debugger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "chip8_decode.h"
+
+#define LINE_MAX_LEN        128
+#define DUMP_BYTES_PER_LINE 16
+#define DEFAULT_DUMP_LEN    64
+
+/* Snapshot used for inspecting the machine */
+static chip8_state_t s_state;
+
+static void
+print_help (void)
+{
+    printf("Commands:\n"
+           "  c             Continue execution\n"
+           "  s [n]         Step n instructions (default 1)\n"
+           "  b <addr>      Set a breakpoint\n"
+           "  db <addr>     Delete a breakpoint\n"
+           "  w <addr> [n]  Watch n bytes for writes (default 1)\n"
+           "  dw <addr> [n] Delete watchpoints\n"
+           "  l             List breakpoints and watchpoints\n"
+           "  r             Show registers\n"
+           "  x <addr> [n]  Dump n bytes of memory\n"
+           "  t             Toggle instruction tracing\n"
+           "  q             Quit\n");
+}
+
+static void
+print_location (void)
+{
+    chip8_insn_t insn;
+
+    chip8_save_state(&s_state);
+    chip8_decode_at(s_state.memory, s_state.pc, &insn);
+    if (insn.flags & CHIP8_INSN_HOST_CALL) {
+        printf("0x%03x: %04x  %-20s; native\n", s_state.pc, insn.op,
+               insn.text);
+    } else {
+        printf("0x%03x: %04x  %s\n", s_state.pc, insn.op, insn.text);
+    }
+}
+
+static void
+print_registers (void)
+{
+    int i;
+
+    chip8_save_state(&s_state);
+
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        printf("V%X: 0x%02x%s", i, s_state.v_regs[i],
+               (i % 8 == 7) ? "\n" : "  ");
+    }
+    printf("I:  0x%03x  PC: 0x%03x  SP: 0x%03x  DT: %u  ST: %u%s\n",
+           s_state.i_reg, s_state.pc, s_state.stack_ptr,
+           s_state.utils.delay_timer, s_state.utils.sound_timer,
+           s_state.paused_for_key_ld ? "  (waiting for key)" : "");
+}
+
+static void
+dump_memory (unsigned long addr, unsigned long len)
+{
+    unsigned long i;
+
+    chip8_save_state(&s_state);
+
+    for (i = 0; i < len && addr + i < MEMORY_SIZE; i++) {
+        if (i % DUMP_BYTES_PER_LINE == 0) {
+            printf("%s0x%03lx:", (i == 0) ? "" : "\n", addr + i);
+        }
+        printf(" %02x", s_state.memory[addr + i]);
+    }
+    printf("\n");
+}
+
+static void
+list_points (void)
+{
+    uint32_t addr;
+
+    for (addr = 0; addr < MEMORY_SIZE; addr++) {
+        if (chip8_get_breakpoint(addr)) {
+            printf("Breakpoint at 0x%03x\n", addr);
+        }
+    }
+
+    for (addr = 0; addr < MEMORY_SIZE; addr++) {
+        if (chip8_get_watchpoint(addr)) {
+            printf("Watchpoint at 0x%03x\n", addr);
+        }
+    }
+}
+
+static void
+print_fault (void)
+{
+    static const char *s_fault_names[] = {
+        [CHIP8_FAULT_NONE]              = "none",
+        [CHIP8_FAULT_BAD_OPCODE]        = "invalid instruction",
+        [CHIP8_FAULT_STACK_OVERFLOW]    = "stack overflow",
+        [CHIP8_FAULT_STACK_UNDERFLOW]   = "stack underflow",
+        [CHIP8_FAULT_HOST_CALL]         = "host call failed",
+    };
+    uint16_t addr;
+    chip8_fault_et fault = chip8_get_fault(&addr);
+
+    printf("Fault: %s at 0x%03x, the program cannot continue\n",
+           s_fault_names[fault], addr);
+}
+
+static void
+step (unsigned long count)
+{
+    uint16_t addr;
+
+    while (count-- > 0) {
+        chip8_run(1);
+        if (chip8_get_stop_reason(NULL) == CHIP8_STOP_FAULT) {
+            print_fault();
+            break;
+        }
+        if (chip8_debugger_should_break()) {
+            chip8_get_stop_reason(&addr);
+            printf("Stopped at %s 0x%03x\n",
+                   chip8_get_stop_reason(NULL) == CHIP8_STOP_BREAKPOINT ?
+                   "breakpoint" : "watchpoint", addr);
+            break;
+        }
+        if (chip8_get_stop_reason(NULL) == CHIP8_STOP_KEY_WAIT) {
+            printf("Waiting for a key press\n");
+            break;
+        }
+    }
+    print_location();
+}
+
+/* Parses "<addr> [len]", returns false if addr is missing or invalid */
+static bool
+parse_range (char *args, unsigned long *addr, unsigned long *len,
+             unsigned long default_len)
+{
+    char *arg = strtok(args, " \t");
+
+    if (arg == NULL) {
+        printf("Missing address\n");
+        return false;
+    }
+    *addr = strtoul(arg, NULL, 16);
+
+    arg = strtok(NULL, " \t");
+    *len = (arg != NULL) ? strtoul(arg, NULL, 0) : default_len;
+
+    if (*addr >= MEMORY_SIZE || *len == 0) {
+        printf("Address out of range\n");
+        return false;
+    }
+
+    if (*addr + *len > MEMORY_SIZE) {
+        *len = MEMORY_SIZE - *addr;
+    }
+
+    return true;
+}
+
+bool
+chip8_debugger_should_break (void)
+{
+    chip8_stop_reason_et reason = chip8_get_stop_reason(NULL);
+
+    return reason == CHIP8_STOP_BREAKPOINT || reason == CHIP8_STOP_WATCHPOINT ||
+           reason == CHIP8_STOP_FAULT;
+}
+
+void
+chip8_debugger_report (void)
+{
+    uint16_t stop_addr;
+
+    switch (chip8_get_stop_reason(&stop_addr)) {
+        default:
+            break;
+        case CHIP8_STOP_BREAKPOINT:
+            printf("Breakpoint at 0x%03x\n", stop_addr);
+            break;
+        case CHIP8_STOP_WATCHPOINT:
+            printf("Watchpoint: write to 0x%03x\n", stop_addr);
+            break;
+        case CHIP8_STOP_FAULT:
+            print_fault();
+            break;
+    }
+    print_location();
+}
+
+bool
+chip8_debugger_prompt (void)
+{
+    static bool s_tracing = false;
+    char line[LINE_MAX_LEN];
+    char *cmd;
+    char *args;
+    unsigned long addr;
+    unsigned long len;
+    bool faulted;
+
+    chip8_debugger_report();
+
+    for (;;) {
+        printf("(chip8) ");
+        fflush(stdout);
+
+        /* A faulted machine stays faulted, there is nothing to resume */
+        faulted = (chip8_get_stop_reason(NULL) == CHIP8_STOP_FAULT);
+
+        if (fgets(line, sizeof(line), stdin) == NULL) {
+            /* stdin went away, let the program run if it can */
+            return !faulted;
+        }
+
+        line[strcspn(line, "\r\n")] = '\0';
+        cmd = strtok(line, " \t");
+        args = strtok(NULL, "");
+        if (args == NULL) {
+            args = "";
+        }
+
+        if (cmd == NULL) {
+            continue;
+        } else if (strcmp(cmd, "c") == 0 && faulted) {
+            print_fault();
+        } else if (strcmp(cmd, "c") == 0) {
+            return true;
+        } else if (strcmp(cmd, "s") == 0) {
+            len = (*args != '\0') ? strtoul(args, NULL, 0) : 1;
+            step(len);
+        } else if (strcmp(cmd, "b") == 0) {
+            if (parse_range(args, &addr, &len, 1)) {
+                chip8_set_breakpoint(addr, true);
+            }
+        } else if (strcmp(cmd, "db") == 0) {
+            if (parse_range(args, &addr, &len, 1)) {
+                chip8_set_breakpoint(addr, false);
+            }
+        } else if (strcmp(cmd, "w") == 0) {
+            if (parse_range(args, &addr, &len, 1)) {
+                chip8_set_watchpoint(addr, len, true);
+            }
+        } else if (strcmp(cmd, "dw") == 0) {
+            if (parse_range(args, &addr, &len, 1)) {
+                chip8_set_watchpoint(addr, len, false);
+            }
+        } else if (strcmp(cmd, "l") == 0) {
+            list_points();
+        } else if (strcmp(cmd, "r") == 0) {
+            print_registers();
+        } else if (strcmp(cmd, "x") == 0) {
+            if (parse_range(args, &addr, &len, DEFAULT_DUMP_LEN)) {
+                dump_memory(addr, len);
+            }
+        } else if (strcmp(cmd, "t") == 0) {
+            s_tracing = !s_tracing;
+            chip8_set_trace(s_tracing);
+            printf("Tracing %s\n", s_tracing ? "on" : "off");
+        } else if (strcmp(cmd, "q") == 0) {
+            return false;
+        } else {
+            print_help();
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * chip8_debugger - CHIP8 Interpreter Interactive Debugger
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_DEBUGGER_H__
+#define __CHIP8_DEBUGGER_H__
+
+#include <stdbool.h>
+
+/**
+ * @brief      Reports why execution stopped, if it stopped for the debugger
+ *
+ * @return     true if the last chip8_run() hit a breakpoint or watchpoint,
+ *             or the machine faulted
+ */
+bool chip8_debugger_should_break(void);
+
+/**
+ * @brief      Prints why execution stopped and where, as the prompt does
+ */
+void chip8_debugger_report(void);
+
+/**
+ * @brief      Runs the interactive debugger prompt on stdin.
+ *
+ * Returns once the user continues execution. A faulted machine cannot
+ * continue, so the prompt only returns false for it.
+ *
+ * @return     false if the user asked to quit the emulator
+ */
+bool chip8_debugger_prompt(void);
+
+#endif /* __CHIP8_DEBUGGER_H__ */
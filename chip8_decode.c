@@ -0,0 +1,312 @@
+/*
+ * chip8_decode - CHIP8 Opcode Decoding
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_decode.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "chip8.h"
+
+#define INSN_TEXT(_insn, ...) \
+    (snprintf((_insn)->text, sizeof((_insn)->text), __VA_ARGS__))
+
+static void
+decode_op0 (uint16_t op, chip8_insn_t *insn)
+{
+    if ((op & 0xFFF0) == 0x00C0) {
+        insn->flags |= CHIP8_INSN_DRAW;
+        INSN_TEXT(insn, "SCD %u", OPC_N(op));
+        return;
+    }
+
+    switch (op) {
+        default:
+            /* Machine-code routine, run natively when a plugin registered
+             * one for NNN, see chip8_rt_set_host_call() */
+            insn->flags |= CHIP8_INSN_HOST_CALL;
+            insn->target = OPC_NNN(op);
+            INSN_TEXT(insn, "SYS 0x%03x", OPC_NNN(op));
+            break;
+        case 0x00E0:
+            insn->flags |= CHIP8_INSN_DRAW;
+            INSN_TEXT(insn, "CLS");
+            break;
+        case 0x00EE:
+            insn->flags |= CHIP8_INSN_RET;
+            INSN_TEXT(insn, "RET");
+            break;
+        case 0x00FB:
+            insn->flags |= CHIP8_INSN_DRAW;
+            INSN_TEXT(insn, "SCR");
+            break;
+        case 0x00FC:
+            insn->flags |= CHIP8_INSN_DRAW;
+            INSN_TEXT(insn, "SCL");
+            break;
+        case 0x00FD:
+            insn->flags |= CHIP8_INSN_HALT;
+            INSN_TEXT(insn, "EXIT");
+            break;
+        case 0x00FE:
+            insn->flags |= CHIP8_INSN_DRAW;
+            INSN_TEXT(insn, "LOW");
+            break;
+        case 0x00FF:
+            insn->flags |= CHIP8_INSN_DRAW;
+            INSN_TEXT(insn, "HIGH");
+            break;
+    }
+}
+
+static void
+decode_op5 (uint16_t op, chip8_insn_t *insn)
+{
+    switch (OPC_N(op)) {
+        default:
+            insn->flags |= CHIP8_INSN_UNSUPPORTED;
+            INSN_TEXT(insn, "DW 0x%04x", op);
+            break;
+        case 0x0:
+            insn->flags |= CHIP8_INSN_SKIP;
+            INSN_TEXT(insn, "SE V%X, V%X", OPC_REGX(op), OPC_REGY(op));
+            break;
+        case 0x2:
+            insn->flags |= CHIP8_INSN_MEM_WRITE | CHIP8_INSN_XOCHIP;
+            INSN_TEXT(insn, "LD [I], V%X - V%X", OPC_REGX(op), OPC_REGY(op));
+            break;
+        case 0x3:
+            insn->flags |= CHIP8_INSN_XOCHIP;
+            INSN_TEXT(insn, "LD V%X - V%X, [I]", OPC_REGX(op), OPC_REGY(op));
+            break;
+    }
+}
+
+static void
+decode_op8 (uint16_t op, chip8_insn_t *insn)
+{
+    static const char *s_alu_names[16] = {
+        [0x0] = "LD",
+        [0x1] = "OR",
+        [0x2] = "AND",
+        [0x3] = "XOR",
+        [0x4] = "ADD",
+        [0x5] = "SUB",
+        [0x6] = "SHR",
+        [0x7] = "SUBN",
+        [0xE] = "SHL",
+    };
+    const char *name = s_alu_names[OPC_N(op)];
+
+    if (name == NULL) {
+        insn->flags |= CHIP8_INSN_UNSUPPORTED;
+        INSN_TEXT(insn, "DW 0x%04x", op);
+    } else if (OPC_N(op) == 0x6 || OPC_N(op) == 0xE) {
+        INSN_TEXT(insn, "%s V%X", name, OPC_REGX(op));
+    } else {
+        INSN_TEXT(insn, "%s V%X, V%X", name, OPC_REGX(op), OPC_REGY(op));
+    }
+}
+
+static void
+decode_opE (uint16_t op, chip8_insn_t *insn)
+{
+    switch (OPC_NN(op)) {
+        default:
+            insn->flags |= CHIP8_INSN_UNSUPPORTED;
+            INSN_TEXT(insn, "DW 0x%04x", op);
+            break;
+        case 0x9E:
+            insn->flags |= CHIP8_INSN_SKIP;
+            INSN_TEXT(insn, "SKP V%X", OPC_REGX(op));
+            break;
+        case 0xA1:
+            insn->flags |= CHIP8_INSN_SKIP;
+            INSN_TEXT(insn, "SKNP V%X", OPC_REGX(op));
+            break;
+    }
+}
+
+static void
+decode_opF (uint16_t op, chip8_insn_t *insn)
+{
+    uint8_t x = OPC_REGX(op);
+
+    switch (OPC_NN(op)) {
+        default:
+            insn->flags |= CHIP8_INSN_UNSUPPORTED;
+            INSN_TEXT(insn, "DW 0x%04x", op);
+            break;
+        case 0x00:
+            if (x != 0) {
+                insn->flags |= CHIP8_INSN_UNSUPPORTED;
+                INSN_TEXT(insn, "DW 0x%04x", op);
+                break;
+            }
+            /* The operand follows, see chip8_decode_at() */
+            insn->flags |= CHIP8_INSN_SETS_I | CHIP8_INSN_LONG |
+                           CHIP8_INSN_XOCHIP;
+            insn->size = 4;
+            INSN_TEXT(insn, "LD I, long");
+            break;
+        case 0x01:
+            insn->flags |= CHIP8_INSN_XOCHIP;
+            INSN_TEXT(insn, "PLANE %u", x);
+            break;
+        case 0x02:
+            if (x != 0) {
+                insn->flags |= CHIP8_INSN_UNSUPPORTED;
+                INSN_TEXT(insn, "DW 0x%04x", op);
+                break;
+            }
+            insn->flags |= CHIP8_INSN_XOCHIP;
+            INSN_TEXT(insn, "LD AUDIO, [I]");
+            break;
+        case 0x07:
+            INSN_TEXT(insn, "LD V%X, DT", x);
+            break;
+        case 0x0A:
+            insn->flags |= CHIP8_INSN_KEY_WAIT;
+            INSN_TEXT(insn, "LD V%X, K", x);
+            break;
+        case 0x15:
+            INSN_TEXT(insn, "LD DT, V%X", x);
+            break;
+        case 0x18:
+            INSN_TEXT(insn, "LD ST, V%X", x);
+            break;
+        case 0x1E:
+            INSN_TEXT(insn, "ADD I, V%X", x);
+            break;
+        case 0x29:
+            INSN_TEXT(insn, "LD F, V%X", x);
+            break;
+        case 0x30:
+            INSN_TEXT(insn, "LD HF, V%X", x);
+            break;
+        case 0x33:
+            insn->flags |= CHIP8_INSN_MEM_WRITE;
+            INSN_TEXT(insn, "LD B, V%X", x);
+            break;
+        case 0x3A:
+            insn->flags |= CHIP8_INSN_XOCHIP;
+            INSN_TEXT(insn, "PITCH V%X", x);
+            break;
+        case 0x55:
+            insn->flags |= CHIP8_INSN_MEM_WRITE;
+            INSN_TEXT(insn, "LD [I], V%X", x);
+            break;
+        case 0x65:
+            INSN_TEXT(insn, "LD V%X, [I]", x);
+            break;
+        case 0x75:
+            INSN_TEXT(insn, "LD R, V%X", x);
+            break;
+        case 0x85:
+            INSN_TEXT(insn, "LD V%X, R", x);
+            break;
+    }
+}
+
+void
+chip8_decode (uint16_t op, chip8_insn_t *insn)
+{
+    assert(insn != NULL);
+
+    memset(insn, 0, sizeof(*insn));
+    insn->op = op;
+    insn->size = 2;
+
+    switch (OPC_CLASS(op)) {
+        case 0x0:
+            decode_op0(op, insn);
+            break;
+        case 0x1:
+            insn->flags |= CHIP8_INSN_JUMP;
+            insn->target = OPC_NNN(op);
+            INSN_TEXT(insn, "JP 0x%03x", OPC_NNN(op));
+            break;
+        case 0x2:
+            insn->flags |= CHIP8_INSN_CALL;
+            insn->target = OPC_NNN(op);
+            INSN_TEXT(insn, "CALL 0x%03x", OPC_NNN(op));
+            break;
+        case 0x3:
+            insn->flags |= CHIP8_INSN_SKIP;
+            INSN_TEXT(insn, "SE V%X, 0x%02x", OPC_REGX(op), OPC_NN(op));
+            break;
+        case 0x4:
+            insn->flags |= CHIP8_INSN_SKIP;
+            INSN_TEXT(insn, "SNE V%X, 0x%02x", OPC_REGX(op), OPC_NN(op));
+            break;
+        case 0x5:
+            decode_op5(op, insn);
+            break;
+        case 0x6:
+            INSN_TEXT(insn, "LD V%X, 0x%02x", OPC_REGX(op), OPC_NN(op));
+            break;
+        case 0x7:
+            INSN_TEXT(insn, "ADD V%X, 0x%02x", OPC_REGX(op), OPC_NN(op));
+            break;
+        case 0x8:
+            decode_op8(op, insn);
+            break;
+        case 0x9:
+            if (OPC_N(op) != 0) {
+                insn->flags |= CHIP8_INSN_UNSUPPORTED;
+                INSN_TEXT(insn, "DW 0x%04x", op);
+            } else {
+                insn->flags |= CHIP8_INSN_SKIP;
+                INSN_TEXT(insn, "SNE V%X, V%X", OPC_REGX(op), OPC_REGY(op));
+            }
+            break;
+        case 0xA:
+            insn->flags |= CHIP8_INSN_SETS_I;
+            insn->target = OPC_NNN(op);
+            INSN_TEXT(insn, "LD I, 0x%03x", OPC_NNN(op));
+            break;
+        case 0xB:
+            /* The interpreter currently computes NNN + V0 into I and
+             * carries on, flag it so analysis can point it out. */
+            insn->flags |= CHIP8_INSN_INDIRECT;
+            insn->target = OPC_NNN(op);
+            INSN_TEXT(insn, "JP V0, 0x%03x", OPC_NNN(op));
+            break;
+        case 0xC:
+            INSN_TEXT(insn, "RND V%X, 0x%02x", OPC_REGX(op), OPC_NN(op));
+            break;
+        case 0xD:
+            insn->flags |= CHIP8_INSN_DRAW;
+            INSN_TEXT(insn, "DRW V%X, V%X, %u", OPC_REGX(op), OPC_REGY(op),
+                      OPC_N(op));
+            break;
+        case 0xE:
+            decode_opE(op, insn);
+            break;
+        case 0xF:
+            decode_opF(op, insn);
+            break;
+    }
+}
+
+void
+chip8_decode_at (const uint8_t *memory, uint16_t addr, chip8_insn_t *insn)
+{
+    chip8_decode(chip8_fetch_op(memory, addr), insn);
+
+    if (insn->flags & CHIP8_INSN_LONG) {
+        insn->target = chip8_fetch_op(memory, addr + 2);
+        INSN_TEXT(insn, "LD I, 0x%04x", insn->target);
+    }
+}
+
+uint16_t
+chip8_fetch_op (const uint8_t *memory, uint16_t addr)
+{
+    return (memory[addr % MEMORY_SIZE] << 8) |
+           memory[(addr + 1) % MEMORY_SIZE];
+}
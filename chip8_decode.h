@@ -0,0 +1,85 @@
+/*
+ * chip8_decode - CHIP8 Opcode Decoding
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_DECODE_H__
+#define __CHIP8_DECODE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Opcode fields, shared by the interpreter and the analysis tools */
+#define OPC_CLASS(_op)  ((_op & 0xF000) >> 12)
+#define OPC_REGX(_op)   ((_op & 0x0F00) >> 8)
+#define OPC_REGY(_op)   ((_op & 0x00F0) >> 4)
+#define OPC_N(_op)      (_op & 0x000F)
+#define OPC_NN(_op)     (_op & 0x00FF)
+#define OPC_NNN(_op)    (_op & 0x0FFF)
+/* Bytes a taken skip passes over. Only XO-CHIP skips all of F000 NNNN,
+ * classic skips land on its operand word. */
+#define OPC_SKIP_LEN(_next_op, _xochip) \
+    (((_xochip) && (_next_op) == 0xF000) ? 4 : 2)
+
+/* Control flow and side effects of an instruction */
+#define CHIP8_INSN_JUMP         0x0001  /* JP NNN, never falls through */
+#define CHIP8_INSN_CALL         0x0002  /* CALL NNN */
+#define CHIP8_INSN_RET          0x0004  /* RET, never falls through */
+#define CHIP8_INSN_SKIP         0x0008  /* May skip the next instruction */
+#define CHIP8_INSN_INDIRECT     0x0010  /* JP V0, NNN */
+#define CHIP8_INSN_UNSUPPORTED  0x0020  /* Not implemented by the interpreter */
+#define CHIP8_INSN_MEM_WRITE    0x0040  /* Writes memory at I */
+#define CHIP8_INSN_KEY_WAIT     0x0080  /* Blocks until a key press */
+#define CHIP8_INSN_DRAW         0x0100  /* Changes VRAM */
+#define CHIP8_INSN_SETS_I       0x0200  /* Loads I with NNN */
+#define CHIP8_INSN_HALT         0x0400  /* EXIT, never moves on */
+#define CHIP8_INSN_LONG         0x0800  /* F000 NNNN, 4 bytes long */
+#define CHIP8_INSN_XOCHIP       0x1000  /* Only in XO-CHIP programs */
+#define CHIP8_INSN_HOST_CALL    0x2000  /* SYS NNN, needs a native routine */
+
+#define CHIP8_INSN_TEXT_LEN     24
+
+/**
+ * @brief      A decoded instruction
+ */
+typedef struct chip8_insn_s {
+    uint16_t    op;
+    uint16_t    flags;
+    /* Address operand for jumps, calls and LD I */
+    uint16_t    target;
+    /* Bytes taken up in memory, 2 or 4 */
+    uint8_t     size;
+    char        text[CHIP8_INSN_TEXT_LEN];
+} chip8_insn_t;
+
+/**
+ * @brief      Decodes an instruction
+ *
+ * @param[in]  op    The opcode, in host byte order
+ * @param[out] insn  The decoded instruction
+ */
+void chip8_decode(uint16_t op, chip8_insn_t *insn);
+
+/**
+ * @brief      Decodes the instruction at an address of a memory image,
+ *             including the operand word of F000 NNNN
+ *
+ * @param[in]  memory  The memory image
+ * @param[in]  addr    Address of the instruction
+ * @param[out] insn    The decoded instruction
+ */
+void chip8_decode_at(const uint8_t *memory, uint16_t addr,
+                     chip8_insn_t *insn);
+
+/**
+ * @brief      Reads a big-endian opcode from a memory image
+ *
+ * @param[in]  memory  The memory image
+ * @param[in]  addr    Address of the opcode
+ *
+ * @return     The opcode in host byte order
+ */
+uint16_t chip8_fetch_op(const uint8_t *memory, uint16_t addr);
+
+#endif /* __CHIP8_DECODE_H__ */
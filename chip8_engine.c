@@ -0,0 +1,174 @@
+/*
+ * chip8_engine - CHIP8 Execution Engines
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_engine.h"
+
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include "chip8_rt.h"
+
+/* Calibration runs in chunks so a key wait ends it early */
+#define CALIBRATION_CHUNK   1000
+
+static bool
+interp_init (void)
+{
+    chip8_rt_set_native(NULL, NULL);
+    return true;
+}
+
+static const chip8_engine_t s_interp_engine = {
+    .name       = "interp",
+    .init       = interp_init,
+    .run        = chip8_run,
+};
+
+#ifdef CHIP8_RECOMP
+/* Stores to memory reach the translation through chip8_rt_set_native() */
+static const chip8_engine_t s_recomp_engine = {
+    .name       = "recomp",
+    .init       = chip8_recomp_attach,
+    .run        = chip8_run,
+};
+#endif
+
+/* The reference interpreter must stay first */
+static const chip8_engine_t *s_engines[] = {
+    &s_interp_engine,
+#ifdef CHIP8_RECOMP
+    &s_recomp_engine,
+#endif
+};
+
+#define NUM_ENGINES (sizeof(s_engines) / sizeof(s_engines[0]))
+
+static _Thread_local const chip8_engine_t *s_current = &s_interp_engine;
+
+size_t
+chip8_engine_count (void)
+{
+    return NUM_ENGINES;
+}
+
+const chip8_engine_t *
+chip8_engine_get (size_t index)
+{
+    return (index < NUM_ENGINES) ? s_engines[index] : NULL;
+}
+
+const chip8_engine_t *
+chip8_engine_find (const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_ENGINES; i++) {
+        if (strcmp(s_engines[i]->name, name) == 0) {
+            return s_engines[i];
+        }
+    }
+
+    return NULL;
+}
+
+bool
+chip8_engine_use (const chip8_engine_t *engine)
+{
+    assert(engine != NULL);
+
+    if (!engine->init()) {
+        /* A failed init may have detached the previous engine */
+        s_current->init();
+        return false;
+    }
+
+    s_current = engine;
+    return true;
+}
+
+/* Returns instructions per second, 0 if nothing ran */
+static double
+time_engine (const chip8_engine_t *engine, uint32_t count)
+{
+    struct timespec begin;
+    struct timespec end;
+    uint32_t total = 0;
+    uint32_t chunk;
+    uint32_t ran;
+    double elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    while (total < count) {
+        chunk = (count - total < CALIBRATION_CHUNK) ?
+                count - total : CALIBRATION_CHUNK;
+        ran = engine->run(chunk);
+        total += ran;
+        if (ran < chunk) {
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = (end.tv_sec - begin.tv_sec) +
+              (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    return (elapsed > 0) ? total / elapsed : 0.0;
+}
+
+const chip8_engine_t *
+chip8_engine_calibrate (uint32_t count)
+{
+    static _Thread_local chip8_state_t s_start;
+    chip8_counters_t counters;
+    const chip8_engine_t *best = s_engines[0];
+    double best_rate = -1.0;
+    double rate;
+    size_t i;
+
+    /* Nothing to choose from, don't run the program for nothing */
+    if (NUM_ENGINES == 1) {
+        chip8_engine_use(best);
+        return s_current;
+    }
+
+    chip8_save_state(&s_start);
+    chip8_get_counters(&counters);
+
+    for (i = 0; i < NUM_ENGINES; i++) {
+        if (!s_engines[i]->init()) {
+            continue;
+        }
+
+        rate = time_engine(s_engines[i], count);
+        chip8_restore_state(&s_start);
+        chip8_set_counters(&counters);
+
+        if (rate > best_rate) {
+            best_rate = rate;
+            best = s_engines[i];
+        }
+    }
+
+    if (!chip8_engine_use(best)) {
+        /* The interpreter always initializes */
+        chip8_engine_use(s_engines[0]);
+    }
+
+    return s_current;
+}
+
+const chip8_engine_t *
+chip8_engine_current (void)
+{
+    return s_current;
+}
+
+uint32_t
+chip8_engine_run (uint32_t count)
+{
+    return s_current->run(count);
+}
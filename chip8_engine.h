@@ -0,0 +1,78 @@
+/*
+ * chip8_engine - CHIP8 Execution Engines
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_ENGINE_H__
+#define __CHIP8_ENGINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+
+/**
+ * @brief      A way of executing the machine on the calling thread.
+ *
+ * Every engine works on the same machine state, so switching engines
+ * between calls to run() is always safe.
+ */
+typedef struct chip8_engine_s {
+    const char *name;
+    /* Prepares to run the program in memory, false if the engine can't */
+    bool        (*init)(void);
+    /* Same contract as chip8_run() */
+    uint32_t    (*run)(uint32_t count);
+} chip8_engine_t;
+
+/**
+ * @brief      Gets the number of engines compiled in
+ */
+size_t chip8_engine_count(void);
+
+/**
+ * @brief      Gets an engine by index, 0 is the reference interpreter
+ */
+const chip8_engine_t *chip8_engine_get(size_t index);
+
+/**
+ * @brief      Looks up an engine by name
+ *
+ * @return     The engine, or NULL if none is called name
+ */
+const chip8_engine_t *chip8_engine_find(const char *name);
+
+/**
+ * @brief      Makes an engine the current one
+ *
+ * @return     false if the engine cannot run the loaded program, the
+ *             current engine is left unchanged
+ */
+bool chip8_engine_use(const chip8_engine_t *engine);
+
+/**
+ * @brief      Times every engine on the loaded program and uses the fastest.
+ *
+ * Each engine runs up to count instructions from the current state, which
+ * is restored afterwards along with the usage counters. Ties go to the engine registered first. With
+ * only the interpreter compiled in, it is used without running anything.
+ *
+ * @param[in]  count  Instructions to time each engine with
+ *
+ * @return     The engine now in use
+ */
+const chip8_engine_t *chip8_engine_calibrate(uint32_t count);
+
+/**
+ * @brief      Gets the current engine, the interpreter until another is used
+ */
+const chip8_engine_t *chip8_engine_current(void);
+
+/**
+ * @brief      Runs the current engine, see chip8_run()
+ */
+uint32_t chip8_engine_run(uint32_t count);
+
+#endif /* __CHIP8_ENGINE_H__ */
@@ -0,0 +1,229 @@
+/*
+ * chip8_env - CHIP8 Interpreter Vectorized Environments
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_env.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "chip8.h"
+#include "chip8_utils.h"
+
+#define DEFAULT_INSTRUCTIONS_PER_FRAME  10
+#define DEFAULT_FRAMES_PER_STEP         4
+
+typedef struct env_slot_s {
+    chip8_state_t  *state;
+    uint32_t        steps;
+    uint8_t         last_reward_value;
+    bool            needs_reset;
+} env_slot_t;
+
+struct chip8_env_s {
+    chip8_env_config_t  config;
+    unsigned            num_envs;
+    /* Post-boot snapshot every episode starts from */
+    chip8_state_t       boot_state;
+    env_slot_t         *slots;
+    /* Slot snapshots, each only as large as the classic boot_state */
+    uint8_t            *states;
+};
+
+void
+chip8_env_config_init (chip8_env_config_t *config)
+{
+    assert(config != NULL);
+
+    memset(config, 0, sizeof(*config));
+    config->instructions_per_frame = DEFAULT_INSTRUCTIONS_PER_FRAME;
+    config->frames_per_step = DEFAULT_FRAMES_PER_STEP;
+    config->reward_addr = CHIP8_ENV_NO_ADDR;
+    config->done_addr = CHIP8_ENV_NO_ADDR;
+}
+
+static bool
+addr_valid (int32_t addr)
+{
+    /* Environments run classic programs, which never see past 4 KB */
+    return addr == CHIP8_ENV_NO_ADDR ||
+           (addr >= 0 && addr < CLASSIC_MEMORY_SIZE);
+}
+
+chip8_env_t *
+chip8_env_create (const chip8_env_config_t *config, const uint8_t *rom,
+                  size_t rom_len, unsigned num_envs)
+{
+    chip8_env_t *env;
+    size_t stride;
+    unsigned i;
+
+    assert(config != NULL);
+    assert(rom != NULL);
+
+    if (num_envs == 0 || !addr_valid(config->reward_addr) ||
+        !addr_valid(config->done_addr)) {
+        return NULL;
+    }
+
+    env = calloc(1, sizeof(*env));
+    if (env == NULL) {
+        return NULL;
+    }
+
+    env->slots = calloc(num_envs, sizeof(*env->slots));
+    if (env->slots == NULL) {
+        free(env);
+        return NULL;
+    }
+
+    env->config = *config;
+    env->num_envs = num_envs;
+
+    /* Boot once, this snapshot replaces chip8_init() and the loader for
+     * every later episode. */
+    chip8_init();
+    if (chip8_load_program_buffer(rom, rom_len) != 0) {
+        chip8_env_destroy(env);
+        return NULL;
+    }
+    chip8_save_state(&env->boot_state);
+
+    stride = chip8_state_size(&env->boot_state);
+    stride = (stride + _Alignof(chip8_state_t) - 1) &
+             ~(_Alignof(chip8_state_t) - 1);
+    env->states = malloc(stride * num_envs);
+    if (env->states == NULL) {
+        chip8_env_destroy(env);
+        return NULL;
+    }
+    for (i = 0; i < num_envs; i++) {
+        env->slots[i].state = (chip8_state_t *)&env->states[stride * i];
+    }
+
+    chip8_env_reset(env, NULL);
+
+    return (env);
+}
+
+void
+chip8_env_destroy (chip8_env_t *env)
+{
+    if (env != NULL) {
+        free(env->states);
+        free(env->slots);
+        free(env);
+    }
+}
+
+unsigned
+chip8_env_count (const chip8_env_t *env)
+{
+    return env->num_envs;
+}
+
+static uint8_t
+read_byte (const chip8_state_t *state, int32_t addr)
+{
+    return (addr == CHIP8_ENV_NO_ADDR) ? 0 : state->memory[addr];
+}
+
+static void
+reset_slot (chip8_env_t *env, unsigned i)
+{
+    env_slot_t *slot = &env->slots[i];
+
+    memcpy(slot->state, &env->boot_state, chip8_state_size(&env->boot_state));
+    /* Each environment gets its own random sequence */
+    slot->state->utils.random_state = (env->config.seed + i) ?
+                                     (env->config.seed + i) : 1;
+    slot->steps = 0;
+    slot->last_reward_value = read_byte(slot->state, env->config.reward_addr);
+    slot->needs_reset = false;
+}
+
+/* Observations keep a fixed size whatever the display mode */
+static void
+write_observation (uint8_t *dst)
+{
+    size_t size = chip8_get_vram_packed(0, dst);
+
+    memset(&dst[size], 0, CHIP8_ENV_OBSERVATION_SIZE - size);
+}
+
+void
+chip8_env_reset (chip8_env_t *env, uint8_t *observations)
+{
+    unsigned i;
+
+    assert(env != NULL);
+
+    for (i = 0; i < env->num_envs; i++) {
+        reset_slot(env, i);
+        if (observations != NULL) {
+            chip8_restore_state(env->slots[i].state);
+            write_observation(&observations[i * CHIP8_ENV_OBSERVATION_SIZE]);
+        }
+    }
+}
+
+void
+chip8_env_step (chip8_env_t *env, const uint8_t *actions,
+                uint8_t *observations, int32_t *rewards, uint8_t *dones)
+{
+    const chip8_env_config_t *config = &env->config;
+    env_slot_t *slot;
+    uint8_t action;
+    uint8_t value;
+    bool done;
+    unsigned i;
+
+    assert(env != NULL);
+    assert(actions != NULL);
+    assert(observations != NULL);
+
+    for (i = 0; i < env->num_envs; i++) {
+        slot = &env->slots[i];
+        action = actions[i];
+
+        if (slot->needs_reset) {
+            reset_slot(env, i);
+        }
+
+        chip8_restore_state(slot->state);
+
+        if (action < CHIP8_KEY_MAX) {
+            key_pressed(action);
+        }
+        run_frames(config->frames_per_step, config->instructions_per_frame);
+        if (action < CHIP8_KEY_MAX) {
+            key_released(action);
+        }
+
+        chip8_save_state(slot->state);
+        slot->steps++;
+
+        write_observation(&observations[i * CHIP8_ENV_OBSERVATION_SIZE]);
+
+        value = read_byte(slot->state, config->reward_addr);
+        if (rewards != NULL) {
+            /* Scores are a byte wide, so wrap the difference the same way */
+            rewards[i] = (int8_t)(uint8_t)(value - slot->last_reward_value);
+        }
+        slot->last_reward_value = value;
+
+        done = (config->done_addr != CHIP8_ENV_NO_ADDR &&
+                slot->state->memory[config->done_addr] == config->done_value);
+        done = done || (config->max_episode_steps != 0 &&
+                        slot->steps >= config->max_episode_steps);
+        /* A faulted program never moves again */
+        done = done || slot->state->fault != CHIP8_FAULT_NONE;
+        slot->needs_reset = done;
+        if (dones != NULL) {
+            dones[i] = done;
+        }
+    }
+}
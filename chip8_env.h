@@ -0,0 +1,116 @@
+/*
+ * chip8_env - CHIP8 Interpreter Vectorized Environments
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_ENV_H__
+#define __CHIP8_ENV_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+
+/* Bytes of observation written per environment, the first plane of the
+ * packed display in its current resolution (see chip8_get_vram_packed())
+ * zero-padded to the size of a 128x64 frame */
+#define CHIP8_ENV_OBSERVATION_SIZE  PACKED_VRAM_SIZE
+
+/* Action value for "no key held", 0-15 hold the matching key */
+#define CHIP8_ENV_NO_ACTION         CHIP8_KEY_MAX
+
+/* Marks an unused memory address in the configuration */
+#define CHIP8_ENV_NO_ADDR           (-1)
+
+/**
+ * @brief      Environment configuration, shared by every environment
+ */
+typedef struct chip8_env_config_s {
+    /* Instructions executed per 1/60s frame */
+    uint32_t    instructions_per_frame;
+    /* Frames each action is held for */
+    uint32_t    frames_per_step;
+    /* Reward is the change of the byte at this address, or CHIP8_ENV_NO_ADDR */
+    int32_t     reward_addr;
+    /* The episode ends once the byte at done_addr equals done_value */
+    int32_t     done_addr;
+    uint8_t     done_value;
+    /* Episodes are cut short after this many steps, 0 for no limit */
+    uint32_t    max_episode_steps;
+    /* Seeds the RNG of environment i with seed + i */
+    uint32_t    seed;
+} chip8_env_config_t;
+
+typedef struct chip8_env_s chip8_env_t;
+
+/**
+ * @brief      Fills a configuration with sensible defaults
+ *
+ * @param[out] config  The configuration
+ */
+void chip8_env_config_init(chip8_env_config_t *config);
+
+/**
+ * @brief      Creates a batch of environments running the same program.
+ *
+ * The machine is booted once and the post-boot snapshot is cached, every
+ * reset restores it without touching the loader again.
+ *
+ * @param[in]  config    The configuration
+ * @param[in]  rom       The program image
+ * @param[in]  rom_len   Length of the program image
+ * @param[in]  num_envs  Number of environments in the batch
+ *
+ * @return     The batch, or NULL if the program does not fit or on
+ *             allocation failure
+ */
+chip8_env_t *chip8_env_create(const chip8_env_config_t *config,
+                              const uint8_t *rom, size_t rom_len,
+                              unsigned num_envs);
+
+/**
+ * @brief      Destroys a batch of environments
+ *
+ * @param[in]  env   The batch
+ */
+void chip8_env_destroy(chip8_env_t *env);
+
+/**
+ * @brief      Gets the number of environments in the batch
+ */
+unsigned chip8_env_count(const chip8_env_t *env);
+
+/**
+ * @brief      Resets every environment to the post-boot snapshot
+ *
+ * Like chip8_env_step(), replaces the machine state of the calling thread
+ * when observations are requested.
+ *
+ * @param[in]  env           The batch
+ * @param[out] observations  num_envs * CHIP8_ENV_OBSERVATION_SIZE bytes,
+ *                           may be NULL
+ */
+void chip8_env_reset(chip8_env_t *env, uint8_t *observations);
+
+/**
+ * @brief      Steps every environment once.
+ *
+ * Observations are written straight into the caller's array, environment i
+ * at offset i * CHIP8_ENV_OBSERVATION_SIZE. An environment reporting done
+ * shows its final frame; it restarts from the snapshot on its next step.
+ *
+ * All environments run on the calling thread and replace its machine
+ * state. Batches on different threads do not interfere.
+ *
+ * @param[in]  env           The batch
+ * @param[in]  actions       num_envs actions, see CHIP8_ENV_NO_ACTION
+ * @param[out] observations  num_envs * CHIP8_ENV_OBSERVATION_SIZE bytes
+ * @param[out] rewards       num_envs rewards, may be NULL
+ * @param[out] dones         num_envs done flags, may be NULL
+ */
+void chip8_env_step(chip8_env_t *env, const uint8_t *actions,
+                    uint8_t *observations, int32_t *rewards, uint8_t *dones);
+
+#endif /* __CHIP8_ENV_H__ */
@@ -0,0 +1,501 @@
+/*
+ * chip8_explore - CHIP8 Interpreter State-Space Explorer
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_explore.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "chip8.h"
+#include "chip8_utils.h"
+
+#define DEFAULT_INSTRUCTIONS_PER_FRAME  10
+#define DEFAULT_FRAMES_PER_INPUT        4
+#define DEFAULT_MAX_STATES              65536
+#define MIN_HASH_SET_SLOTS              1024
+
+/* Hash set slots hold the state hash, 0 marks an empty slot */
+#define HASH_SET_EMPTY                  0
+
+typedef struct explore_entry_s {
+    /* Must be first, callers only ever see the node */
+    chip8_explore_node_t        node;
+    /* Snapshot to expand from, freed once expanded */
+    chip8_state_t              *state;
+    /* Discovery order, keeps the queue stable */
+    uint64_t                    seq;
+    struct explore_entry_s     *next_alloc;
+} explore_entry_t;
+
+typedef struct explore_s {
+    const chip8_explore_config_t   *config;
+    /* Every state shares the start state's memory layout */
+    size_t                          state_size;
+
+    /* Concurrent, insert-only open-addressing set of state hashes */
+    _Atomic uint64_t               *hash_set;
+    size_t                          hash_set_mask;
+
+    /* Everything below is protected by lock */
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  work_available;
+    explore_entry_t               **heap;
+    size_t                          heap_len;
+    size_t                          heap_cap;
+    explore_entry_t                *all_entries;
+    unsigned                        active_workers;
+    uint64_t                        next_seq;
+    bool                            out_of_memory;
+
+    atomic_bool                     stop;
+    atomic_uint_fast64_t            unique_states;
+    atomic_uint_fast64_t            duplicate_states;
+    atomic_uint_fast64_t            expanded_states;
+    atomic_uint_fast32_t            max_depth_reached;
+} explore_t;
+
+void
+chip8_explore_config_init (chip8_explore_config_t *config)
+{
+    assert(config != NULL);
+
+    memset(config, 0, sizeof(*config));
+    config->strategy = CHIP8_EXPLORE_BFS;
+    config->instructions_per_frame = DEFAULT_INSTRUCTIONS_PER_FRAME;
+    config->frames_per_input = DEFAULT_FRAMES_PER_INPUT;
+    config->max_states = DEFAULT_MAX_STATES;
+}
+
+uint64_t
+chip8_explore_state_hash (const chip8_state_t *state)
+{
+    uint64_t h = 0;
+
+    /* Hash every field chip8_restore_state() restores, one by one so that
+     * struct padding never leaks in */
+    h = hash_bytes(h, &state->xochip, sizeof(state->xochip));
+    h = hash_bytes(h, state->memory, state->xochip ? MEMORY_SIZE :
+                                                     CLASSIC_MEMORY_SIZE);
+    h = hash_bytes(h, state->v_regs, sizeof(state->v_regs));
+    h = hash_bytes(h, &state->i_reg, sizeof(state->i_reg));
+    h = hash_bytes(h, &state->pc, sizeof(state->pc));
+    h = hash_bytes(h, &state->stack_ptr, sizeof(state->stack_ptr));
+    h = hash_bytes(h, &state->paused_for_key_ld,
+                   sizeof(state->paused_for_key_ld));
+    h = hash_bytes(h, state->vram, sizeof(state->vram));
+    h = hash_bytes(h, &state->plane_mask, sizeof(state->plane_mask));
+    h = hash_bytes(h, &state->hires, sizeof(state->hires));
+    h = hash_bytes(h, state->rpl_flags, sizeof(state->rpl_flags));
+    h = hash_bytes(h, state->audio_pattern, sizeof(state->audio_pattern));
+    h = hash_bytes(h, &state->audio_pitch, sizeof(state->audio_pitch));
+    h = hash_bytes(h, &state->fault, sizeof(state->fault));
+    h = hash_bytes(h, state->utils.keys_pressed,
+                   sizeof(state->utils.keys_pressed));
+    h = hash_bytes(h, &state->utils.delay_timer,
+                   sizeof(state->utils.delay_timer));
+    h = hash_bytes(h, &state->utils.sound_timer,
+                   sizeof(state->utils.sound_timer));
+    h = hash_bytes(h, &state->utils.random_state,
+                   sizeof(state->utils.random_state));
+
+    return (h == HASH_SET_EMPTY) ? 1 : h;
+}
+
+uint32_t
+chip8_explore_node_path (const chip8_explore_node_t *node,
+                         uint8_t *inputs, uint32_t max)
+{
+    uint32_t len = node->depth;
+
+    for (; node->parent != NULL; node = node->parent) {
+        if (node->depth <= max) {
+            inputs[node->depth - 1] = node->input;
+        }
+    }
+
+    return (len);
+}
+
+/* Returns true if the hash was not in the set yet */
+static bool
+hash_set_insert (explore_t *ex, uint64_t hash)
+{
+    size_t slot = hash & ex->hash_set_mask;
+    uint64_t expected;
+
+    for (;;) {
+        expected = atomic_load_explicit(&ex->hash_set[slot],
+                                        memory_order_relaxed);
+        if (expected == hash) {
+            return false;
+        }
+
+        if (expected == HASH_SET_EMPTY) {
+            if (atomic_compare_exchange_strong(&ex->hash_set[slot],
+                                               &expected, hash)) {
+                return true;
+            }
+            /* Lost the race for this slot, see who won */
+            if (expected == hash) {
+                return false;
+            }
+        }
+
+        slot = (slot + 1) & ex->hash_set_mask;
+    }
+}
+
+static bool
+entry_before (const explore_t *ex, const explore_entry_t *a,
+              const explore_entry_t *b)
+{
+    if (ex->config->strategy == CHIP8_EXPLORE_BEST_FIRST) {
+        if (a->node.score != b->node.score) {
+            return a->node.score > b->node.score;
+        }
+    } else if (a->node.depth != b->node.depth) {
+        return a->node.depth < b->node.depth;
+    }
+
+    return a->seq < b->seq;
+}
+
+/* Called with ex->lock held */
+static bool
+queue_push (explore_t *ex, explore_entry_t *entry)
+{
+    size_t i;
+    explore_entry_t **heap;
+
+    if (ex->heap_len == ex->heap_cap) {
+        heap = realloc(ex->heap, ex->heap_cap * 2 * sizeof(*heap));
+        if (heap == NULL) {
+            return false;
+        }
+        ex->heap = heap;
+        ex->heap_cap *= 2;
+    }
+
+    i = ex->heap_len++;
+    while (i > 0 && entry_before(ex, entry, ex->heap[(i - 1) / 2])) {
+        ex->heap[i] = ex->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    ex->heap[i] = entry;
+
+    return true;
+}
+
+/* Called with ex->lock held */
+static explore_entry_t *
+queue_pop (explore_t *ex)
+{
+    explore_entry_t *top = ex->heap[0];
+    explore_entry_t *last = ex->heap[--ex->heap_len];
+    size_t i = 0;
+    size_t child;
+
+    while ((child = 2 * i + 1) < ex->heap_len) {
+        if (child + 1 < ex->heap_len &&
+            entry_before(ex, ex->heap[child + 1], ex->heap[child])) {
+            child++;
+        }
+        if (!entry_before(ex, ex->heap[child], last)) {
+            break;
+        }
+        ex->heap[i] = ex->heap[child];
+        i = child;
+    }
+    ex->heap[i] = last;
+
+    return (top);
+}
+
+static void
+record_depth (explore_t *ex, uint32_t depth)
+{
+    uint_fast32_t seen = atomic_load(&ex->max_depth_reached);
+
+    while (depth > seen &&
+           !atomic_compare_exchange_weak(&ex->max_depth_reached, &seen, depth)) {
+    }
+}
+
+static void
+discover (explore_t *ex, const explore_entry_t *parent, uint8_t input,
+          const chip8_state_t *state, uint64_t hash)
+{
+    const chip8_explore_config_t *config = ex->config;
+    explore_entry_t *entry;
+    bool expand;
+
+    if (atomic_fetch_add(&ex->unique_states, 1) + 1 >= config->max_states) {
+        atomic_store(&ex->stop, true);
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        goto out_of_memory;
+    }
+
+    entry->node.parent = &parent->node;
+    entry->node.hash = hash;
+    entry->node.depth = parent->node.depth + 1;
+    entry->node.input = input;
+    if (config->strategy == CHIP8_EXPLORE_BEST_FIRST && config->score) {
+        entry->node.score = config->score(state, config->arg);
+    }
+    record_depth(ex, entry->node.depth);
+
+    if (config->visit && !config->visit(&entry->node, state, config->arg)) {
+        atomic_store(&ex->stop, true);
+    }
+
+    expand = (config->max_depth == 0 || entry->node.depth < config->max_depth);
+    if (expand) {
+        entry->state = malloc(ex->state_size);
+        if (entry->state == NULL) {
+            free(entry);
+            goto out_of_memory;
+        }
+        memcpy(entry->state, state, ex->state_size);
+    }
+
+    pthread_mutex_lock(&ex->lock);
+    entry->seq = ex->next_seq++;
+    entry->next_alloc = ex->all_entries;
+    ex->all_entries = entry;
+    if (expand) {
+        if (queue_push(ex, entry)) {
+            pthread_cond_signal(&ex->work_available);
+        } else {
+            free(entry->state);
+            entry->state = NULL;
+            ex->out_of_memory = true;
+            atomic_store(&ex->stop, true);
+        }
+    }
+    pthread_mutex_unlock(&ex->lock);
+    return;
+
+out_of_memory:
+    pthread_mutex_lock(&ex->lock);
+    ex->out_of_memory = true;
+    pthread_mutex_unlock(&ex->lock);
+    atomic_store(&ex->stop, true);
+}
+
+static void
+expand (explore_t *ex, explore_entry_t *entry, chip8_state_t *scratch)
+{
+    const chip8_explore_config_t *config = ex->config;
+    uint8_t input;
+    uint64_t hash;
+
+    for (input = 0; input < CHIP8_EXPLORE_NUM_INPUTS; input++) {
+        if (atomic_load_explicit(&ex->stop, memory_order_relaxed)) {
+            break;
+        }
+
+        chip8_restore_state(entry->state);
+
+        if (input != CHIP8_EXPLORE_NO_KEY) {
+            key_pressed(input);
+        }
+        run_frames(config->frames_per_input, config->instructions_per_frame);
+        if (input != CHIP8_EXPLORE_NO_KEY) {
+            key_released(input);
+        }
+
+        chip8_save_state(scratch);
+        hash = chip8_explore_state_hash(scratch);
+
+        if (hash_set_insert(ex, hash)) {
+            discover(ex, entry, input, scratch, hash);
+        } else {
+            atomic_fetch_add_explicit(&ex->duplicate_states, 1,
+                                      memory_order_relaxed);
+        }
+    }
+
+    atomic_fetch_add_explicit(&ex->expanded_states, 1, memory_order_relaxed);
+}
+
+static void *
+explore_worker (void *arg)
+{
+    explore_t *ex = arg;
+    explore_entry_t *entry;
+    chip8_state_t *scratch = malloc(ex->state_size);
+
+    if (scratch == NULL) {
+        pthread_mutex_lock(&ex->lock);
+        ex->out_of_memory = true;
+        pthread_mutex_unlock(&ex->lock);
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&ex->lock);
+        while (ex->heap_len == 0 && ex->active_workers > 0 &&
+               !atomic_load(&ex->stop)) {
+            pthread_cond_wait(&ex->work_available, &ex->lock);
+        }
+
+        if (ex->heap_len == 0 || atomic_load(&ex->stop)) {
+            /* Either everybody is idle with nothing left to do, or the
+             * search was cut short. Wake the others so they notice. */
+            pthread_cond_broadcast(&ex->work_available);
+            pthread_mutex_unlock(&ex->lock);
+            break;
+        }
+
+        entry = queue_pop(ex);
+        ex->active_workers++;
+        pthread_mutex_unlock(&ex->lock);
+
+        expand(ex, entry, scratch);
+        free(entry->state);
+        entry->state = NULL;
+
+        pthread_mutex_lock(&ex->lock);
+        ex->active_workers--;
+        if (ex->active_workers == 0 && ex->heap_len == 0) {
+            pthread_cond_broadcast(&ex->work_available);
+        }
+        pthread_mutex_unlock(&ex->lock);
+    }
+
+    free(scratch);
+    return NULL;
+}
+
+static unsigned
+get_num_threads (const chip8_explore_config_t *config)
+{
+    long online;
+
+    if (config->num_threads != 0) {
+        return config->num_threads;
+    }
+
+    online = sysconf(_SC_NPROCESSORS_ONLN);
+    return (online > 0) ? (unsigned)online : 1;
+}
+
+static void
+free_entries (explore_t *ex)
+{
+    explore_entry_t *entry = ex->all_entries;
+    explore_entry_t *next;
+
+    /* Unexpanded entries still own their snapshot */
+    while (entry != NULL) {
+        next = entry->next_alloc;
+        free(entry->state);
+        free(entry);
+        entry = next;
+    }
+}
+
+int
+chip8_explore (const chip8_explore_config_t *config,
+               const chip8_state_t *start,
+               chip8_explore_stats_t *stats)
+{
+    explore_t ex;
+    explore_entry_t *root = NULL;
+    pthread_t *threads = NULL;
+    unsigned num_threads = get_num_threads(config);
+    unsigned started = 0;
+    size_t slots = MIN_HASH_SET_SLOTS;
+    int rc = -1;
+
+    assert(config != NULL);
+    assert(start != NULL);
+    assert(config->max_states > 0);
+
+    memset(&ex, 0, sizeof(ex));
+    ex.config = config;
+    ex.state_size = chip8_state_size(start);
+    pthread_mutex_init(&ex.lock, NULL);
+    pthread_cond_init(&ex.work_available, NULL);
+    atomic_init(&ex.stop, false);
+    atomic_init(&ex.unique_states, 0);
+    atomic_init(&ex.duplicate_states, 0);
+    atomic_init(&ex.expanded_states, 0);
+    atomic_init(&ex.max_depth_reached, 0);
+
+    /* Keep the load factor at or below one half, the search stops at
+     * max_states so the set never needs to grow. */
+    while (slots < config->max_states * 2) {
+        slots *= 2;
+    }
+    ex.hash_set = calloc(slots, sizeof(*ex.hash_set));
+    ex.hash_set_mask = slots - 1;
+    ex.heap_cap = 1024;
+    ex.heap = malloc(ex.heap_cap * sizeof(*ex.heap));
+    threads = calloc(num_threads, sizeof(*threads));
+    root = calloc(1, sizeof(*root));
+    if (ex.hash_set == NULL || ex.heap == NULL || threads == NULL ||
+        root == NULL) {
+        free(root);
+        goto out;
+    }
+
+    root->state = malloc(ex.state_size);
+    if (root->state == NULL) {
+        free(root);
+        goto out;
+    }
+    memcpy(root->state, start, ex.state_size);
+    root->node.hash = chip8_explore_state_hash(start);
+    root->seq = ex.next_seq++;
+    ex.all_entries = root;
+    hash_set_insert(&ex, root->node.hash);
+    atomic_store(&ex.unique_states, 1);
+    queue_push(&ex, root);
+
+    for (started = 0; started < num_threads; started++) {
+        if (pthread_create(&threads[started], NULL, explore_worker, &ex) != 0) {
+            break;
+        }
+    }
+
+    if (started == 0) {
+        /* Nothing could be spawned, search on the calling thread instead.
+         * The caller's machine is clobbered either way. */
+        explore_worker(&ex);
+    }
+
+    while (started > 0) {
+        pthread_join(threads[--started], NULL);
+    }
+
+    if (stats != NULL) {
+        stats->unique_states = atomic_load(&ex.unique_states);
+        stats->duplicate_states = atomic_load(&ex.duplicate_states);
+        stats->expanded_states = atomic_load(&ex.expanded_states);
+        stats->max_depth_reached = atomic_load(&ex.max_depth_reached);
+        stats->exhausted = (ex.heap_len == 0 && !atomic_load(&ex.stop));
+    }
+
+    rc = ex.out_of_memory ? -1 : 0;
+
+out:
+    free_entries(&ex);
+    free(ex.heap);
+    free((void *)ex.hash_set);
+    free(threads);
+    pthread_cond_destroy(&ex.work_available);
+    pthread_mutex_destroy(&ex.lock);
+
+    return (rc);
+}
@@ -0,0 +1,121 @@
+/*
+ * chip8_explore - CHIP8 Interpreter State-Space Explorer
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_EXPLORE_H__
+#define __CHIP8_EXPLORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+/* Input applied when expanding a state: one of the keys, or no key */
+#define CHIP8_EXPLORE_NO_KEY    CHIP8_KEY_MAX
+#define CHIP8_EXPLORE_NUM_INPUTS (CHIP8_KEY_MAX + 1)
+
+/**
+ * @brief      Order in which discovered states are expanded
+ */
+typedef enum {
+    CHIP8_EXPLORE_BFS,
+    CHIP8_EXPLORE_BEST_FIRST,
+} chip8_explore_strategy_et;
+
+/**
+ * @brief      A discovered state. Only the path information is kept once a
+ *             node has been expanded.
+ */
+typedef struct chip8_explore_node_s {
+    const struct chip8_explore_node_s  *parent;
+    uint64_t                            hash;
+    int64_t                             score;
+    uint32_t                            depth;
+    /* Input which led here from the parent, CHIP8_EXPLORE_NO_KEY for none */
+    uint8_t                             input;
+} chip8_explore_node_t;
+
+/**
+ * @brief      Search configuration
+ */
+typedef struct chip8_explore_config_s {
+    chip8_explore_strategy_et   strategy;
+    /* Worker threads, 0 to use every online core */
+    unsigned                    num_threads;
+    /* Instructions executed per 1/60s frame */
+    uint32_t                    instructions_per_frame;
+    /* Frames each input is held for before the next one is chosen */
+    uint32_t                    frames_per_input;
+    /* States at this depth are not expanded further, 0 for no limit */
+    uint32_t                    max_depth;
+    /* Stop once this many unique states were found */
+    uint64_t                    max_states;
+    /* Best-first priority, higher is expanded sooner. Ignored for BFS. */
+    int64_t                   (*score)(const chip8_state_t *state, void *arg);
+    /* Called for every newly discovered state, possibly from several
+     * threads at once. Returning false stops the search. May be NULL. */
+    bool                      (*visit)(const chip8_explore_node_t *node,
+                                       const chip8_state_t *state, void *arg);
+    void                       *arg;
+} chip8_explore_config_t;
+
+/**
+ * @brief      Outcome of a search
+ */
+typedef struct chip8_explore_stats_s {
+    uint64_t    unique_states;
+    uint64_t    duplicate_states;
+    uint64_t    expanded_states;
+    uint32_t    max_depth_reached;
+    /* true if the search ended because the frontier emptied */
+    bool        exhausted;
+} chip8_explore_stats_t;
+
+/**
+ * @brief      Fills a configuration with sensible defaults
+ *
+ * @param[out] config  The configuration
+ */
+void chip8_explore_config_init(chip8_explore_config_t *config);
+
+/**
+ * @brief      Searches the inputs reachable from a start state.
+ *
+ * Every input is applied to every discovered state, the resulting machine
+ * is hashed and states seen before are pruned. Nodes passed to the visit
+ * callback remain valid until chip8_explore() returns.
+ *
+ * @param[in]  config  The search configuration
+ * @param[in]  start   The state to search from
+ * @param[out] stats   Search statistics, may be NULL
+ *
+ * @return     0 on success, -1 if resources could not be allocated
+ */
+int chip8_explore(const chip8_explore_config_t *config,
+                  const chip8_state_t *start,
+                  chip8_explore_stats_t *stats);
+
+/**
+ * @brief      Computes the hash used to deduplicate states
+ *
+ * @param[in]  state  The state
+ *
+ * @return     The hash of memory, registers, VRAM and timers
+ */
+uint64_t chip8_explore_state_hash(const chip8_state_t *state);
+
+/**
+ * @brief      Recovers the inputs leading from the start state to a node
+ *
+ * @param[in]  node    The node
+ * @param[out] inputs  Receives node->depth inputs, oldest first
+ * @param[in]  max     Capacity of inputs
+ *
+ * @return     The number of inputs in the path (may exceed max)
+ */
+uint32_t chip8_explore_node_path(const chip8_explore_node_t *node,
+                                 uint8_t *inputs, uint32_t max);
+
+#endif /* __CHIP8_EXPLORE_H__ */
@@ -0,0 +1,47 @@
+/*
+ * chip8_frontend - CHIP8 Display and Input Frontends
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_FRONTEND_H__
+#define __CHIP8_FRONTEND_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+/**
+ * @brief      A copy of the screen, taken once per main loop pass
+ */
+typedef struct chip8_frontend_frame_s {
+    int         width;
+    int         height;
+    /* Planes in use, 1 unless the program is XO-CHIP */
+    int         planes;
+    /* See chip8_get_vram_packed() */
+    uint8_t     packed[NUM_PLANES][PACKED_VRAM_SIZE];
+} chip8_frontend_frame_t;
+
+/**
+ * @brief      Where frames are shown and keys come from.
+ *
+ * Every call is made from the main loop's thread. Each pass polls, runs
+ * the engine, uploads the screen if it changed and then presents.
+ */
+typedef struct chip8_frontend_s {
+    const char *name;
+    /* Opens the display, false if it cannot */
+    bool        (*init)(void);
+    void        (*deinit)(void);
+    /* Handles waiting input, false once the user asked to quit */
+    bool        (*poll)(void);
+    /* Takes a frame that differs from the one uploaded before, false if
+     * it could not and wants it again next pass */
+    bool        (*upload)(const chip8_frontend_frame_t *frame);
+    /* Shows the last frame uploaded, and paces the main loop */
+    void        (*present)(void);
+} chip8_frontend_t;
+
+#endif /* __CHIP8_FRONTEND_H__ */
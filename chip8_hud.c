@@ -0,0 +1,130 @@
+/*
+ * chip8_hud - CHIP8 Frontend Performance Metrics
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_hud.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *s_phase_names[CHIP8_HUD_PHASE_MAX] = {
+    [CHIP8_HUD_EMULATE] = "emulate",
+    [CHIP8_HUD_UPLOAD]  = "upload",
+    [CHIP8_HUD_PRESENT] = "present",
+};
+
+/* The last CHIP8_HUD_WINDOW frames, oldest overwritten first */
+static uint64_t s_phase_ns[CHIP8_HUD_PHASE_MAX][CHIP8_HUD_WINDOW];
+static uint64_t s_num_frames;
+
+/* The interval in progress */
+static uint64_t s_interval_start;
+static uint64_t s_interval_frames;
+static uint64_t s_interval_instructions;
+
+static chip8_hud_stats_t s_stats;
+
+static int
+compare_u64 (const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void
+compute_percentiles (void)
+{
+    uint64_t sorted[CHIP8_HUD_WINDOW];
+    size_t n = (s_num_frames < CHIP8_HUD_WINDOW) ?
+               s_num_frames : CHIP8_HUD_WINDOW;
+    int phase;
+
+    for (phase = 0; phase < CHIP8_HUD_PHASE_MAX; phase++) {
+        memcpy(sorted, s_phase_ns[phase], n * sizeof(sorted[0]));
+        qsort(sorted, n, sizeof(sorted[0]), compare_u64);
+        s_stats.p50_ns[phase] = sorted[(n - 1) * 50 / 100];
+        s_stats.p99_ns[phase] = sorted[(n - 1) * 99 / 100];
+    }
+}
+
+uint64_t
+chip8_hud_now (void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+void
+chip8_hud_reset (uint64_t now)
+{
+    memset(s_phase_ns, 0, sizeof(s_phase_ns));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_num_frames = 0;
+    s_interval_start = now;
+    s_interval_frames = 0;
+    s_interval_instructions = 0;
+}
+
+bool
+chip8_hud_frame (uint64_t now, const uint64_t *phase_ns,
+                 uint32_t instructions)
+{
+    double elapsed;
+    int phase;
+
+    for (phase = 0; phase < CHIP8_HUD_PHASE_MAX; phase++) {
+        s_phase_ns[phase][s_num_frames % CHIP8_HUD_WINDOW] = phase_ns[phase];
+    }
+    s_num_frames++;
+    s_interval_frames++;
+    s_interval_instructions += instructions;
+
+    if (now - s_interval_start < CHIP8_HUD_INTERVAL_NS) {
+        return false;
+    }
+
+    /* Sorting waits for the end of an interval, not every frame */
+    elapsed = (now - s_interval_start) / 1e9;
+    s_stats.ips = s_interval_instructions / elapsed;
+    s_stats.fps = s_interval_frames / elapsed;
+    s_stats.ipf = (double)s_interval_instructions / s_interval_frames;
+    compute_percentiles();
+
+    s_interval_start = now;
+    s_interval_frames = 0;
+    s_interval_instructions = 0;
+
+    return true;
+}
+
+void
+chip8_hud_get_stats (chip8_hud_stats_t *stats)
+{
+    memcpy(stats, &s_stats, sizeof(*stats));
+}
+
+void
+chip8_hud_format (const chip8_hud_stats_t *stats, const char *separator,
+                  char *text, size_t len)
+{
+    size_t used;
+    int phase;
+
+    used = snprintf(text, len, "%.2fM ips %.1f fps %.1f ipf",
+                    stats->ips / 1e6, stats->fps, stats->ipf);
+
+    for (phase = 0; phase < CHIP8_HUD_PHASE_MAX && used < len; phase++) {
+        used += snprintf(&text[used], len - used,
+                         "%s%-7s p50 %.2f p99 %.2f ms", separator,
+                         s_phase_names[phase], stats->p50_ns[phase] / 1e6,
+                         stats->p99_ns[phase] / 1e6);
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * chip8_hud - CHIP8 Frontend Performance Metrics
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_HUD_H__
+#define __CHIP8_HUD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Frames the frame time percentiles cover */
+#define CHIP8_HUD_WINDOW        128
+/* How often the numbers are recomputed */
+#define CHIP8_HUD_INTERVAL_NS   500000000ull
+
+/**
+ * @brief      The parts of a frame that are timed
+ */
+typedef enum {
+    /* Running the engine, timers and audio */
+    CHIP8_HUD_EMULATE,
+    /* Copying changed VRAM into the texture */
+    CHIP8_HUD_UPLOAD,
+    /* Drawing the texture and presenting */
+    CHIP8_HUD_PRESENT,
+    CHIP8_HUD_PHASE_MAX,
+} chip8_hud_phase_et;
+
+/**
+ * @brief      The numbers shown, as of the last full interval
+ */
+typedef struct chip8_hud_stats_s {
+    double      ips;
+    double      fps;
+    /* Instructions actually run per frame, on average */
+    double      ipf;
+    uint64_t    p50_ns[CHIP8_HUD_PHASE_MAX];
+    uint64_t    p99_ns[CHIP8_HUD_PHASE_MAX];
+} chip8_hud_stats_t;
+
+/**
+ * @brief      Gets the time on the clock frames are measured with
+ *
+ * @returns    Nanoseconds
+ */
+uint64_t chip8_hud_now(void);
+
+/**
+ * @brief      Forgets every frame and starts the first interval
+ *
+ * @param[in]  now     From chip8_hud_now()
+ */
+void chip8_hud_reset(uint64_t now);
+
+/**
+ * @brief      Records a finished frame
+ *
+ * @param[in]  now           When the frame finished, from chip8_hud_now()
+ * @param[in]  phase_ns      Time spent in each chip8_hud_phase_et
+ * @param[in]  instructions  Instructions run during the frame
+ *
+ * @returns    true if the interval ended and the stats changed
+ */
+bool chip8_hud_frame(uint64_t now, const uint64_t *phase_ns,
+                     uint32_t instructions);
+
+/**
+ * @brief      Gets the stats of the last full interval
+ */
+void chip8_hud_get_stats(chip8_hud_stats_t *stats);
+
+/**
+ * @brief      Formats the stats as text: the rates, then the times of
+ *             each phase, separated by separator
+ *
+ * @param[out] text       The text, truncated to len
+ * @param[in]  separator  Goes between groups, e.g. "\n"
+ */
+void chip8_hud_format(const chip8_hud_stats_t *stats, const char *separator,
+                      char *text, size_t len);
+
+#endif /* __CHIP8_HUD_H__ */
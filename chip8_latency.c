@@ -0,0 +1,146 @@
+/*
+ * chip8_latency - CHIP8 Input-to-Photon Latency Measurement
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_latency.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Draws the 8x8 block at I over the whole 64x32 screen on each press:
+ *
+ *   0x200  00E0  CLS
+ *   0x202  A21E  LD I, block
+ *   0x204  F00A  LD V0, K          wait for a press
+ *   0x206  6100  LD V1, 0
+ *   0x208  6200  LD V2, 0
+ *   0x20A  D128  DRW V2, V1, 8
+ *   0x20C  7208  ADD V2, 8
+ *   0x20E  3240  SE V2, 64
+ *   0x210  120A  JP 0x20A
+ *   0x212  7108  ADD V1, 8
+ *   0x214  3120  SE V1, 32
+ *   0x216  1208  JP 0x208
+ *   0x218  E09E  SKP V0            wait for the release
+ *   0x21A  1204  JP 0x204
+ *   0x21C  1218  JP 0x218
+ *   0x21E  block */
+const uint8_t chip8_latency_rom[] = {
+    0x00, 0xE0, 0xA2, 0x1E, 0xF0, 0x0A, 0x61, 0x00,
+    0x62, 0x00, 0xD1, 0x28, 0x72, 0x08, 0x32, 0x40,
+    0x12, 0x0A, 0x71, 0x08, 0x31, 0x20, 0x12, 0x08,
+    0xE0, 0x9E, 0x12, 0x04, 0x12, 0x18,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+const size_t chip8_latency_rom_size = sizeof(chip8_latency_rom);
+
+static uint64_t s_samples[CHIP8_LATENCY_MAX_SAMPLES];
+static uint32_t s_num_samples;
+static uint32_t s_num_missed;
+static uint32_t s_target;
+
+static bool s_pressed;
+static uint64_t s_pressed_at;
+static uint64_t s_next_press;
+/* xorshift32, a fixed sequence of gaps for every run */
+static uint32_t s_gap_state;
+
+static uint64_t
+next_gap (void)
+{
+    uint32_t x = s_gap_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_gap_state = x;
+
+    return CHIP8_LATENCY_MIN_GAP_NS +
+           x % (CHIP8_LATENCY_MAX_GAP_NS - CHIP8_LATENCY_MIN_GAP_NS);
+}
+
+void
+chip8_latency_start (uint32_t samples, uint64_t now)
+{
+    s_target = (samples < CHIP8_LATENCY_MAX_SAMPLES) ?
+               samples : CHIP8_LATENCY_MAX_SAMPLES;
+    s_num_samples = 0;
+    s_num_missed = 0;
+    s_pressed = false;
+    s_gap_state = 0x1A7E5C;
+    s_next_press = now + next_gap();
+}
+
+chip8_latency_action_et
+chip8_latency_poll (uint64_t now, bool ready)
+{
+    if (!ready || s_pressed || s_num_samples + s_num_missed >= s_target ||
+        now < s_next_press) {
+        return CHIP8_LATENCY_NONE;
+    }
+
+    s_pressed = true;
+    s_pressed_at = now;
+
+    return CHIP8_LATENCY_PRESS;
+}
+
+chip8_latency_action_et
+chip8_latency_presented (uint64_t now, bool changed)
+{
+    if (!s_pressed ||
+        (!changed && now - s_pressed_at < CHIP8_LATENCY_TIMEOUT_NS)) {
+        return CHIP8_LATENCY_NONE;
+    }
+
+    if (changed) {
+        s_samples[s_num_samples++] = now - s_pressed_at;
+    } else {
+        s_num_missed++;
+    }
+    s_pressed = false;
+    s_next_press = now + next_gap();
+
+    return (s_num_samples + s_num_missed >= s_target) ?
+           CHIP8_LATENCY_DONE : CHIP8_LATENCY_RELEASE;
+}
+
+static int
+compare_latency (const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+void
+chip8_latency_report (const char *label, char *text, size_t len)
+{
+    static uint64_t s_sorted[CHIP8_LATENCY_MAX_SAMPLES];
+    uint32_t n = s_num_samples;
+    uint64_t total = 0;
+    uint32_t i;
+
+    if (n == 0) {
+        snprintf(text, len, "%s: no samples, %u missed", label,
+                 s_num_missed);
+        return;
+    }
+
+    memcpy(s_sorted, s_samples, n * sizeof(s_sorted[0]));
+    qsort(s_sorted, n, sizeof(s_sorted[0]), compare_latency);
+    for (i = 0; i < n; i++) {
+        total += s_sorted[i];
+    }
+
+    snprintf(text, len, "%s: n=%u missed=%u min %.2f p50 %.2f p90 %.2f "
+             "p99 %.2f max %.2f mean %.2f ms", label, n, s_num_missed,
+             s_sorted[0] / 1e6, s_sorted[(n - 1) * 50 / 100] / 1e6,
+             s_sorted[(n - 1) * 90 / 100] / 1e6,
+             s_sorted[(n - 1) * 99 / 100] / 1e6, s_sorted[n - 1] / 1e6,
+             total / 1e6 / n);
+}
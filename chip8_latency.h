@@ -0,0 +1,80 @@
+/*
+ * chip8_latency - CHIP8 Input-to-Photon Latency Measurement
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_LATENCY_H__
+#define __CHIP8_LATENCY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CHIP8_LATENCY_MAX_SAMPLES   4096
+/* Presses are spread over this much time after the last one was seen, so
+ * they land at every point of the display refresh */
+#define CHIP8_LATENCY_MIN_GAP_NS    100000000ull
+#define CHIP8_LATENCY_MAX_GAP_NS    200000000ull
+/* A press with no change on screen by then is counted as missed */
+#define CHIP8_LATENCY_TIMEOUT_NS    2000000000ull
+
+/**
+ * @brief      A test program that inverts the whole screen on every key
+ *             press. The first pixel changes three instructions after the
+ *             press is seen.
+ */
+extern const uint8_t chip8_latency_rom[];
+extern const size_t chip8_latency_rom_size;
+
+/**
+ * @brief      What the frontend should do with the synthetic key
+ */
+typedef enum {
+    CHIP8_LATENCY_NONE,
+    CHIP8_LATENCY_PRESS,
+    CHIP8_LATENCY_RELEASE,
+    /* Release it, every sample has been taken */
+    CHIP8_LATENCY_DONE,
+} chip8_latency_action_et;
+
+/**
+ * @brief      Starts a new measurement
+ *
+ * @param[in]  samples  Presses to measure, up to CHIP8_LATENCY_MAX_SAMPLES
+ * @param[in]  now      Nanoseconds on a monotonic clock
+ */
+void chip8_latency_start(uint32_t samples, uint64_t now);
+
+/**
+ * @brief      Call before polling for input.
+ *
+ * @param[in]  now      Nanoseconds on a monotonic clock
+ * @param[in]  ready    The program is waiting for a key, so a press now
+ *                      changes the screen rather than landing in the
+ *                      middle of drawing the last one
+ *
+ * @returns    CHIP8_LATENCY_PRESS when a key press should be injected,
+ *             which is timed from now
+ */
+chip8_latency_action_et chip8_latency_poll(uint64_t now, bool ready);
+
+/**
+ * @brief      Call once a frame has been presented
+ *
+ * @param[in]  now      When presenting returned
+ * @param[in]  changed  Whether the frame differed from the last one
+ *
+ * @returns    CHIP8_LATENCY_RELEASE once the press showed up or timed out,
+ *             CHIP8_LATENCY_DONE after the last one
+ */
+chip8_latency_action_et chip8_latency_presented(uint64_t now, bool changed);
+
+/**
+ * @brief      Formats the latency distribution on one line
+ *
+ * @param[in]  label    Describes the settings measured
+ */
+void chip8_latency_report(const char *label, char *text, size_t len);
+
+#endif /* __CHIP8_LATENCY_H__ */
@@ -0,0 +1,323 @@
+/*
+ * chip8_metrics - CHIP8 Prometheus Metrics Export
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define METRICS_TEXT_SIZE       4096
+#define METRICS_MAX_PATH        512
+#define METRICS_REQUEST_SIZE    1024
+/* How long a connection gets to send a request before the metrics are
+ * sent anyway, so plain readers like socat work too */
+#define METRICS_REQUEST_TIMEOUT_MS  100
+
+/* macOS has SO_NOSIGPIPE instead */
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* The latest snapshot from the emulation thread */
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static chip8_metrics_t s_snapshot;
+
+static bool s_running = false;
+static pthread_t s_thread;
+static char s_path[METRICS_MAX_PATH];
+/* -1 when writing a file */
+static int s_listen_fd = -1;
+/* Written to by chip8_metrics_stop() to wake the serving thread */
+static int s_stop_pipe[2] = { -1, -1 };
+
+static size_t
+append_metric (char *text, size_t len, size_t used, const char *name,
+               const char *type, const char *help, const char *value)
+{
+    if (used >= len) {
+        return used;
+    }
+
+    return used + snprintf(&text[used], len - used,
+                           "# HELP %s %s\n# TYPE %s %s\n%s %s\n",
+                           name, help, name, type, name, value);
+}
+
+#define APPEND_U64(_name, _type, _help, _value)                         \
+    do {                                                                \
+        snprintf(value, sizeof(value), "%llu",                          \
+                 (unsigned long long)(_value));                         \
+        used = append_metric(text, len, used, _name, _type, _help,      \
+                             value);                                    \
+    } while (0)
+
+size_t
+chip8_metrics_format (const chip8_metrics_t *metrics, char *text,
+                      size_t len)
+{
+    char value[32];
+    size_t used = 0;
+
+    APPEND_U64("chip8_instructions_total", "counter",
+               "Instructions executed.", metrics->instructions);
+    APPEND_U64("chip8_frames_presented_total", "counter",
+               "Frames presented to the window.", metrics->frames_presented);
+    APPEND_U64("chip8_frames_dropped_total", "counter",
+               "60 Hz frames that passed without a present.",
+               metrics->frames_dropped);
+    APPEND_U64("chip8_draws_total", "counter",
+               "DRW instructions executed.", metrics->draws);
+    APPEND_U64("chip8_collisions_total", "counter",
+               "DRW instructions that set VF.", metrics->collisions);
+    snprintf(value, sizeof(value), "%.9f", metrics->key_wait_ns / 1e9);
+    used = append_metric(text, len, used, "chip8_key_wait_seconds_total",
+                         "counter", "Time stalled on LD Vx, K.", value);
+    APPEND_U64("chip8_timer_ticks_total", "counter",
+               "Delay and sound timer decrements.", metrics->timer_ticks);
+    APPEND_U64("chip8_audio_underruns_total", "counter",
+               "Times the audio device ran out of samples.",
+               metrics->audio_underruns);
+    APPEND_U64("chip8_instructions_per_pass", "gauge",
+               "Instructions run per main loop pass.",
+               metrics->instructions_per_pass);
+    APPEND_U64("chip8_waiting_for_key", "gauge",
+               "1 while stalled on LD Vx, K.", metrics->waiting_for_key);
+    APPEND_U64("chip8_faulted", "gauge",
+               "1 once the program has faulted.", metrics->faulted);
+
+    return (used < len) ? used : len - 1;
+}
+
+void
+chip8_metrics_publish (const chip8_metrics_t *metrics)
+{
+    pthread_mutex_lock(&s_lock);
+    memcpy(&s_snapshot, metrics, sizeof(s_snapshot));
+    pthread_mutex_unlock(&s_lock);
+}
+
+static size_t
+format_snapshot (char *text, size_t len)
+{
+    chip8_metrics_t metrics;
+
+    pthread_mutex_lock(&s_lock);
+    memcpy(&metrics, &s_snapshot, sizeof(metrics));
+    pthread_mutex_unlock(&s_lock);
+
+    return chip8_metrics_format(&metrics, text, len);
+}
+
+static void
+send_all (int fd, const char *data, size_t len)
+{
+    ssize_t sent;
+
+    while (len > 0) {
+        sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return;
+        }
+        data += sent;
+        len -= sent;
+    }
+}
+
+static void
+serve_connection (int fd)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    char request[METRICS_REQUEST_SIZE];
+    char text[METRICS_TEXT_SIZE];
+    char header[256];
+    ssize_t request_len = 0;
+    size_t len;
+    int header_len;
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    if (poll(&pfd, 1, METRICS_REQUEST_TIMEOUT_MS) > 0) {
+        request_len = recv(fd, request, sizeof(request), 0);
+    }
+
+    len = format_snapshot(text, sizeof(text));
+
+    if (request_len >= 4 && memcmp(request, "GET ", 4) == 0) {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: %zu\r\n"
+                              "Connection: close\r\n\r\n", len);
+        send_all(fd, header, header_len);
+    }
+    send_all(fd, text, len);
+}
+
+/* Replaces the file in one step, readers never see half of it */
+static void
+write_file (void)
+{
+    char text[METRICS_TEXT_SIZE];
+    char tmp[METRICS_MAX_PATH + 8];
+    size_t len;
+    FILE *fp;
+    bool ok;
+
+    len = format_snapshot(text, sizeof(text));
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", s_path);
+    fp = fopen(tmp, "w");
+    if (fp == NULL) {
+        return;
+    }
+    ok = (fwrite(text, 1, len, fp) == len);
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp, s_path) != 0) {
+        unlink(tmp);
+    }
+}
+
+static void *
+serve (void *arg)
+{
+    struct pollfd fds[2] = {
+        { .fd = s_stop_pipe[0], .events = POLLIN },
+        { .fd = s_listen_fd, .events = POLLIN },
+    };
+    bool listening = (s_listen_fd >= 0);
+    int timeout = listening ? -1 : CHIP8_METRICS_FILE_INTERVAL_MS;
+    int fd;
+
+    for (;;) {
+        if (!listening) {
+            write_file();
+        }
+
+        if (poll(fds, listening ? 2 : 1, timeout) < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+
+        if (listening && (fds[1].revents & POLLIN)) {
+            fd = accept(s_listen_fd, NULL, NULL);
+            if (fd >= 0) {
+                serve_connection(fd);
+                close(fd);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static bool
+open_socket (const char *path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    struct stat st;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Metrics socket path %s is too long\n", path);
+        return false;
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    /* Left behind by an earlier run. Never remove anything else. */
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    s_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s_listen_fd < 0 ||
+        bind(s_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(s_listen_fd, 8) != 0) {
+        printf("Unable to serve metrics on %s - %s\n", path,
+               strerror(errno));
+        if (s_listen_fd >= 0) {
+            close(s_listen_fd);
+            s_listen_fd = -1;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool
+chip8_metrics_start (const char *target)
+{
+    size_t prefix_len = strlen(CHIP8_METRICS_UNIX_PREFIX);
+    bool unix_socket = (strncmp(target, CHIP8_METRICS_UNIX_PREFIX,
+                                prefix_len) == 0);
+
+    if (s_running) {
+        return false;
+    }
+
+    if (unix_socket) {
+        target += prefix_len;
+    }
+    if (snprintf(s_path, sizeof(s_path), "%s", target) >= sizeof(s_path)) {
+        printf("Metrics path %s is too long\n", target);
+        return false;
+    }
+
+    if (unix_socket && !open_socket(s_path)) {
+        return false;
+    }
+
+    if (pipe(s_stop_pipe) != 0 ||
+        pthread_create(&s_thread, NULL, serve, NULL) != 0) {
+        printf("Unable to start serving metrics - %s\n", strerror(errno));
+        chip8_metrics_stop();
+        return false;
+    }
+
+    s_running = true;
+    return true;
+}
+
+void
+chip8_metrics_stop (void)
+{
+    if (s_running) {
+        (void)!write(s_stop_pipe[1], "", 1);
+        pthread_join(s_thread, NULL);
+        s_running = false;
+
+        if (s_listen_fd < 0) {
+            write_file();
+        }
+    }
+
+    if (s_listen_fd >= 0) {
+        close(s_listen_fd);
+        s_listen_fd = -1;
+        unlink(s_path);
+    }
+    if (s_stop_pipe[0] >= 0) {
+        close(s_stop_pipe[0]);
+        close(s_stop_pipe[1]);
+        s_stop_pipe[0] = -1;
+        s_stop_pipe[1] = -1;
+    }
+}
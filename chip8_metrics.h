@@ -0,0 +1,74 @@
+/*
+ * chip8_metrics - CHIP8 Prometheus Metrics Export
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_METRICS_H__
+#define __CHIP8_METRICS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Targets starting with this are UNIX domain sockets, anything else is a
+ * file */
+#define CHIP8_METRICS_UNIX_PREFIX   "unix:"
+/* How often a metrics file is rewritten */
+#define CHIP8_METRICS_FILE_INTERVAL_MS  1000
+
+/**
+ * @brief      Everything exported, as seen by the emulation thread
+ */
+typedef struct chip8_metrics_s {
+    /* Counters */
+    uint64_t    instructions;
+    uint64_t    frames_presented;
+    uint64_t    frames_dropped;
+    uint64_t    draws;
+    uint64_t    collisions;
+    uint64_t    key_wait_ns;
+    uint64_t    timer_ticks;
+    uint64_t    audio_underruns;
+    /* Gauges */
+    uint32_t    instructions_per_pass;
+    bool        waiting_for_key;
+    bool        faulted;
+} chip8_metrics_t;
+
+/**
+ * @brief      Starts serving metrics from a background thread.
+ *
+ * A unix:<path> target is a UNIX domain socket. Each connection gets the
+ * latest snapshot in Prometheus text format, as an HTTP response if it
+ * sent a GET. Any other target is a file, rewritten atomically every
+ * CHIP8_METRICS_FILE_INTERVAL_MS, e.g. for the node_exporter textfile
+ * collector.
+ *
+ * @param[in]  target  Where to serve them
+ *
+ * @returns    true on success, prints why not otherwise
+ */
+bool chip8_metrics_start(const char *target);
+
+/**
+ * @brief      Stops serving, writing the file a last time
+ */
+void chip8_metrics_stop(void);
+
+/**
+ * @brief      Publishes a snapshot. Call from the emulation thread.
+ *
+ * Copies it under a lock, formatting happens on the serving thread.
+ */
+void chip8_metrics_publish(const chip8_metrics_t *metrics);
+
+/**
+ * @brief      Formats metrics in Prometheus text format
+ *
+ * @returns    The length of the text, truncated to len
+ */
+size_t chip8_metrics_format(const chip8_metrics_t *metrics, char *text,
+                            size_t len);
+
+#endif /* __CHIP8_METRICS_H__ */
@@ -0,0 +1,189 @@
+/*
+ * chip8_pack - CHIP8 ROM Packs
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_pack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "chip8.h"
+
+/* Every entry is checked once here, lookups and loads trust them */
+static bool
+check_pack (const char *path, const chip8_pack_t *pack)
+{
+    const chip8_pack_header_t *header = pack->header;
+    const chip8_pack_entry_t *entry;
+    size_t index_end;
+    uint32_t i;
+
+    if (pack->size < sizeof(*header) || header->magic != CHIP8_PACK_MAGIC) {
+        printf("%s is not a CHIP8 ROM pack\n", path);
+        return false;
+    }
+    if (header->version != CHIP8_PACK_VERSION ||
+        header->entry_size != sizeof(*entry)) {
+        printf("%s is version %u, expected %u\n", path, header->version,
+               CHIP8_PACK_VERSION);
+        return false;
+    }
+
+    index_end = sizeof(*header) + (size_t)header->num_entries * sizeof(*entry);
+    if (header->num_entries > pack->size / sizeof(*entry) ||
+        index_end > pack->size) {
+        printf("%s is truncated\n", path);
+        return false;
+    }
+
+    for (i = 0; i < header->num_entries; i++) {
+        entry = &pack->entries[i];
+        if (memchr(entry->name, '\0', sizeof(entry->name)) == NULL ||
+            entry->offset < index_end || entry->offset > pack->size ||
+            entry->size > pack->size - entry->offset ||
+            (i > 0 && entry->hash < pack->entries[i - 1].hash)) {
+            printf("%s: entry %u is corrupt\n", path, i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+chip8_pack_open (const char *path, chip8_pack_t *pack)
+{
+    struct stat st;
+    void *base;
+    int fd;
+
+    memset(pack, 0, sizeof(*pack));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Unable to open %s - %s\n", path, strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("%s is empty\n", path);
+        close(fd);
+        return false;
+    }
+
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Unable to map %s - %s\n", path, strerror(errno));
+        return false;
+    }
+
+    pack->base = base;
+    pack->size = st.st_size;
+    pack->header = base;
+    pack->entries = (const chip8_pack_entry_t *)(pack->header + 1);
+
+    if (!check_pack(path, pack)) {
+        chip8_pack_close(pack);
+        return false;
+    }
+
+    return true;
+}
+
+void
+chip8_pack_close (chip8_pack_t *pack)
+{
+    if (pack->base != NULL) {
+        munmap((void *)pack->base, pack->size);
+    }
+    memset(pack, 0, sizeof(*pack));
+}
+
+const chip8_pack_entry_t *
+chip8_pack_find_hash (const chip8_pack_t *pack, uint64_t hash)
+{
+    const chip8_pack_entry_t *entries = pack->entries;
+    uint32_t lo = 0;
+    uint32_t hi = pack->header->num_entries;
+    uint32_t mid;
+
+    /* The first entry with the hash */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (entries[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < pack->header->num_entries && entries[lo].hash == hash) {
+        return &entries[lo];
+    }
+    return NULL;
+}
+
+const chip8_pack_entry_t *
+chip8_pack_find_name (const chip8_pack_t *pack, const char *name)
+{
+    uint32_t i;
+
+    /* Names are only looked up once per run, the index is in hash
+     * order */
+    for (i = 0; i < pack->header->num_entries; i++) {
+        if (strcmp(pack->entries[i].name, name) == 0) {
+            return &pack->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+const chip8_pack_entry_t *
+chip8_pack_find (const chip8_pack_t *pack, const char *key)
+{
+    const chip8_pack_entry_t *entry;
+    size_t i;
+
+    for (i = 0; i < CHIP8_PACK_HASH_DIGITS; i++) {
+        if (!isxdigit((unsigned char)key[i])) {
+            break;
+        }
+    }
+    if (i == CHIP8_PACK_HASH_DIGITS && key[i] == '\0') {
+        entry = chip8_pack_find_hash(pack, strtoull(key, NULL, 16));
+        if (entry != NULL) {
+            return entry;
+        }
+    }
+
+    /* A name can look like a hash too */
+    return chip8_pack_find_name(pack, key);
+}
+
+const uint8_t *
+chip8_pack_image (const chip8_pack_t *pack, const chip8_pack_entry_t *entry)
+{
+    return &pack->base[entry->offset];
+}
+
+int
+chip8_pack_load (const chip8_pack_t *pack, const chip8_pack_entry_t *entry)
+{
+    if (entry->offset > pack->size ||
+        entry->size > pack->size - entry->offset) {
+        return (-1);
+    }
+
+    return chip8_load_program_buffer(chip8_pack_image(pack, entry),
+                                     entry->size);
+}
@@ -0,0 +1,127 @@
+/*
+ * chip8_pack - CHIP8 ROM Packs
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_PACK_H__
+#define __CHIP8_PACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* "C8PK" */
+#define CHIP8_PACK_MAGIC        0x4B503843u
+#define CHIP8_PACK_VERSION      1
+#define CHIP8_PACK_MAX_NAME     48
+/* A hash written as hex, see chip8_pack_find() */
+#define CHIP8_PACK_HASH_DIGITS  16
+
+/**
+ * @brief      How a program expects to be run
+ */
+typedef enum {
+    CHIP8_PACK_PROFILE_CHIP8,
+    CHIP8_PACK_PROFILE_XOCHIP,
+} chip8_pack_profile_et;
+
+/**
+ * @brief      The start of a pack, in the byte order of the machine that
+ *             wrote it.
+ *
+ * The header is followed by num_entries entries in increasing order of
+ * hash, then the program images they point at.
+ */
+typedef struct chip8_pack_header_s {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    num_entries;
+    uint32_t    entry_size;
+} chip8_pack_header_t;
+
+/**
+ * @brief      One program of a pack
+ */
+typedef struct chip8_pack_entry_s {
+    /* NUL terminated, unique within the pack */
+    char        name[CHIP8_PACK_MAX_NAME];
+    /* hash_bytes(0, image, size) */
+    uint64_t    hash;
+    /* Of the image, from the start of the pack */
+    uint32_t    offset;
+    uint32_t    size;
+    /* See chip8_pack_profile_et */
+    uint32_t    profile;
+    /* Suggested instructions per frame, 0 for no suggestion */
+    uint32_t    instructions_per_frame;
+} chip8_pack_entry_t;
+
+/**
+ * @brief      An open pack, mapped read-only and shared by every thread
+ */
+typedef struct chip8_pack_s {
+    const uint8_t               *base;
+    size_t                      size;
+    const chip8_pack_header_t   *header;
+    const chip8_pack_entry_t    *entries;
+} chip8_pack_t;
+
+/**
+ * @brief      Maps a pack and checks every entry lies within it
+ *
+ * @param[in]  path    The pack file
+ * @param[out] pack    The open pack
+ *
+ * @returns    true on success, prints why not otherwise
+ */
+bool chip8_pack_open(const char *path, chip8_pack_t *pack);
+
+/**
+ * @brief      Unmaps a pack, its entries and images go with it
+ */
+void chip8_pack_close(chip8_pack_t *pack);
+
+/**
+ * @brief      Finds a program by the hash of its image
+ *
+ * @returns    The entry, NULL if there is none
+ */
+const chip8_pack_entry_t *chip8_pack_find_hash(const chip8_pack_t *pack,
+                                               uint64_t hash);
+
+/**
+ * @brief      Finds a program by name
+ *
+ * @returns    The entry, NULL if there is none
+ */
+const chip8_pack_entry_t *chip8_pack_find_name(const chip8_pack_t *pack,
+                                               const char *name);
+
+/**
+ * @brief      Finds a program by hash if key is CHIP8_PACK_HASH_DIGITS hex
+ *             digits, otherwise by name
+ *
+ * @returns    The entry, NULL if there is none
+ */
+const chip8_pack_entry_t *chip8_pack_find(const chip8_pack_t *pack,
+                                          const char *key);
+
+/**
+ * @brief      Gets the image of a program
+ */
+const uint8_t *chip8_pack_image(const chip8_pack_t *pack,
+                                const chip8_pack_entry_t *entry);
+
+/**
+ * @brief      Loads a program into the calling thread's machine, see
+ *             chip8_load_program_buffer()
+ *
+ * Does not set up XO-CHIP, call chip8_set_xochip() first as the profile
+ * suggests.
+ *
+ * @returns    0 on success, -1 if the image does not fit in memory
+ */
+int chip8_pack_load(const chip8_pack_t *pack, const chip8_pack_entry_t *entry);
+
+#endif /* __CHIP8_PACK_H__ */
@@ -0,0 +1,39 @@
+/*
+ * chip8_plugin - CHIP8 Host Call Plugins
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_plugin.h"
+
+#include <stdio.h>
+#include <dlfcn.h>
+
+bool
+chip8_plugin_load (const char *path)
+{
+    chip8_plugin_init_t init;
+    void *handle;
+
+    handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        printf("Unable to load plugin %s - %s\n", path, dlerror());
+        return false;
+    }
+
+    /* POSIX guarantees data and function pointers convert */
+    *(void **)&init = dlsym(handle, CHIP8_PLUGIN_INIT);
+    if (init == NULL) {
+        printf("Plugin %s has no %s()\n", path, CHIP8_PLUGIN_INIT);
+        dlclose(handle);
+        return false;
+    }
+
+    /* Stays loaded even on failure, some routines may already be set */
+    if (!init(chip8_rt_set_host_call)) {
+        printf("Plugin %s failed to initialize\n", path);
+        return false;
+    }
+
+    return true;
+}
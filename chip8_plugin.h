@@ -0,0 +1,43 @@
+/*
+ * chip8_plugin - CHIP8 Host Call Plugins
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_PLUGIN_H__
+#define __CHIP8_PLUGIN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8_rt.h"
+
+/* The function every plugin exports */
+#define CHIP8_PLUGIN_INIT       "chip8_plugin_init"
+
+/* chip8_rt_set_host_call(), handed to plugins so they need no symbols
+ * from the executable */
+typedef bool (*chip8_plugin_set_t)(uint16_t addr, chip8_host_call_t call,
+                                   void *ctx);
+
+/**
+ * @brief       The signature of CHIP8_PLUGIN_INIT.
+ *
+ * Sets the plugin's SYS routines with set.
+ *
+ * @returns     false if the plugin cannot be used
+ */
+typedef bool (*chip8_plugin_init_t)(chip8_plugin_set_t set);
+
+/**
+ * @brief       Loads a shared library and lets it set its SYS routines.
+ *
+ * Plugins stay loaded until exit. Prints why on failure.
+ *
+ * @param[in]   path    The shared library
+ *
+ * @returns     true on success
+ */
+bool chip8_plugin_load(const char *path);
+
+#endif /* __CHIP8_PLUGIN_H__ */
@@ -0,0 +1,145 @@
+/*
+ * chip8_record - CHIP8 Gameplay Recording
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_record.h"
+
+#include <string.h>
+
+#include "chip8_codec.h"
+#include "chip8_writer.h"
+
+/* Only touched by the emulation thread */
+static int s_stream = -1;
+static uint64_t s_dropped;
+static chip8_frontend_frame_t s_prev;
+static bool s_have_prev;
+
+void
+chip8_record_publish (const chip8_frontend_frame_t *screen, uint64_t frame)
+{
+    static uint8_t s_message[CHIP8_CODEC_MAX_VARINT + CHIP8_CODEC_MAX_FRAME];
+    static uint8_t s_encoded[CHIP8_CODEC_MAX_FRAME];
+    size_t len;
+    size_t used;
+    int plane;
+
+    if (s_stream < 0) {
+        return;
+    }
+
+    len = chip8_codec_encode_frame(s_have_prev ? &s_prev : NULL, screen,
+                                   frame, s_encoded);
+    used = chip8_codec_put_varint(s_message, len);
+    memcpy(&s_message[used], s_encoded, len);
+    used += len;
+
+    if (!chip8_writer_write(s_stream, s_message, used)) {
+        /* The delta after a gap would be against a frame that is not in
+         * the file */
+        s_dropped++;
+        s_have_prev = false;
+        return;
+    }
+
+    s_prev.width = screen->width;
+    s_prev.height = screen->height;
+    s_prev.planes = screen->planes;
+    for (plane = 0; plane < screen->planes; plane++) {
+        memcpy(s_prev.packed[plane], screen->packed[plane],
+               screen->width / 8 * screen->height);
+    }
+    s_have_prev = true;
+}
+
+bool
+chip8_record_start (const char *path)
+{
+    uint8_t header[CHIP8_RECORD_MAGIC_LEN + 1];
+
+    if (s_stream >= 0) {
+        return false;
+    }
+
+    s_stream = chip8_writer_open(path, CHIP8_RECORD_QUEUE_SIZE,
+                                 CHIP8_WRITER_DROP);
+    if (s_stream < 0) {
+        return false;
+    }
+
+    memcpy(header, CHIP8_RECORD_MAGIC, CHIP8_RECORD_MAGIC_LEN);
+    header[CHIP8_RECORD_MAGIC_LEN] = CHIP8_RECORD_VERSION;
+    chip8_writer_write(s_stream, header, sizeof(header));
+
+    s_dropped = 0;
+    s_have_prev = false;
+    return true;
+}
+
+void
+chip8_record_stop (void)
+{
+    chip8_writer_stats_t stats;
+
+    if (s_stream < 0) {
+        return;
+    }
+
+    if (!chip8_writer_close(s_stream, &stats)) {
+        printf("Writing the recording failed, it is incomplete\n");
+    }
+    s_stream = -1;
+
+    if (s_dropped > 0) {
+        printf("The recording dropped %llu frames it could not keep up "
+               "with\n", (unsigned long long)s_dropped);
+    }
+}
+
+bool
+chip8_record_read_header (FILE *fp)
+{
+    uint8_t header[CHIP8_RECORD_MAGIC_LEN + 1];
+
+    return (fread(header, 1, sizeof(header), fp) == sizeof(header) &&
+            memcmp(header, CHIP8_RECORD_MAGIC, CHIP8_RECORD_MAGIC_LEN) == 0 &&
+            header[CHIP8_RECORD_MAGIC_LEN] == CHIP8_RECORD_VERSION);
+}
+
+int
+chip8_record_read (FILE *fp, chip8_frontend_frame_t *frame, uint64_t *number)
+{
+    static _Thread_local uint8_t s_encoded[CHIP8_CODEC_MAX_FRAME];
+    uint8_t varint[CHIP8_CODEC_MAX_VARINT];
+    chip8_codec_type_et type;
+    uint64_t len;
+    size_t n = 0;
+    int c;
+
+    do {
+        c = fgetc(fp);
+        if (c == EOF) {
+            /* A frame cut short by a crash ends the recording too */
+            return 0;
+        }
+        varint[n++] = c;
+    } while ((c & 0x80) && n < sizeof(varint));
+
+    if (chip8_codec_get_varint(varint, n, &len) != n ||
+        len == 0 || len > sizeof(s_encoded)) {
+        return (-1);
+    }
+    if (fread(s_encoded, 1, len, fp) != len) {
+        return 0;
+    }
+
+    /* A delta first fails here, against the blank frame it gets */
+    if (chip8_codec_decode_frame(s_encoded, len, frame, number,
+                                 &type) != len) {
+        return (-1);
+    }
+
+    return 1;
+}
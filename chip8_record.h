@@ -0,0 +1,75 @@
+/*
+ * chip8_record - CHIP8 Gameplay Recording
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_RECORD_H__
+#define __CHIP8_RECORD_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8_frontend.h"
+
+/* Starts a recording, followed by the version byte */
+#define CHIP8_RECORD_MAGIC      "C8RC"
+#define CHIP8_RECORD_MAGIC_LEN  4
+#define CHIP8_RECORD_VERSION    1
+/* Bytes waiting to be written, minutes of typical frames */
+#define CHIP8_RECORD_QUEUE_SIZE (1 << 20)
+
+/**
+ * @brief      Starts recording to a file, written by the chip8_writer
+ *             I/O thread.
+ *
+ * After the magic and version, the file holds a keyframe and then the
+ * deltas of each changed frame. Each is a varint length and a frame from
+ * chip8_codec_encode_frame(), numbered with its 1/60s tick from
+ * get_frame_ticks(). Ticks that are not there repeat the frame before.
+ *
+ * @param[in]  path    The recording, replaced if it exists
+ *
+ * @returns    true on success, prints why not otherwise
+ */
+bool chip8_record_start(const char *path);
+
+/**
+ * @brief      Writes out the frames still queued and closes the file
+ */
+void chip8_record_stop(void);
+
+/**
+ * @brief      Encodes a frame and queues it for the writer. Call from the
+ *             emulation thread, never blocks.
+ *
+ * A frame published while the queue is full is dropped and counted, the
+ * next one is written as a keyframe.
+ *
+ * @param[in]  screen  The frame
+ * @param[in]  frame   Its tick, greater than the last one published
+ */
+void chip8_record_publish(const chip8_frontend_frame_t *screen,
+                          uint64_t frame);
+
+/**
+ * @brief      Checks the start of a recording
+ *
+ * @returns    true if fp is at the first frame of a recording
+ */
+bool chip8_record_read_header(FILE *fp);
+
+/**
+ * @brief      Reads the next frame of a recording
+ *
+ * @param[in,out] frame   The frame before, zeroed for the first one. On
+ *                        return the next frame.
+ * @param[out]    number  Its tick
+ *
+ * @returns    1 for a frame, 0 at the end, -1 if the file is corrupt
+ */
+int chip8_record_read(FILE *fp, chip8_frontend_frame_t *frame,
+                      uint64_t *number);
+
+#endif /* __CHIP8_RECORD_H__ */
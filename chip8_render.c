@@ -0,0 +1,199 @@
+/*
+ * chip8_render - CHIP8 Framebuffer Conversion
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_render.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#define GLYPH_WIDTH     3
+#define GLYPH_HEIGHT    5
+
+/* The eight pixels of every possible source byte, leftmost first. Built
+ * for one color pair at a time, per thread. */
+static _Thread_local uint32_t s_byte_pixels[256][8];
+static _Thread_local uint32_t s_lut_fg;
+static _Thread_local uint32_t s_lut_bg;
+static _Thread_local bool s_lut_valid = false;
+
+static void
+build_lut (uint32_t fg, uint32_t bg)
+{
+    int byte;
+    int i;
+
+    for (byte = 0; byte < 256; byte++) {
+        for (i = 0; i < 8; i++) {
+            s_byte_pixels[byte][i] = (byte & (0x80 >> i)) ? fg : bg;
+        }
+    }
+
+    s_lut_fg = fg;
+    s_lut_bg = bg;
+    s_lut_valid = true;
+}
+
+/* The four pixels of every pair of plane nibbles, index (plane1 << 4) |
+ * plane0, leftmost first. Built for one palette at a time, per thread. */
+static _Thread_local uint32_t s_nibble_pixels[256][4];
+static _Thread_local uint32_t s_lut_palette[CHIP8_RENDER_NUM_COLORS];
+static _Thread_local bool s_planes_lut_valid = false;
+
+static void
+build_planes_lut (const uint32_t *palette)
+{
+    int index;
+    int color;
+    int i;
+
+    for (index = 0; index < 256; index++) {
+        for (i = 0; i < 4; i++) {
+            color = ((index >> (3 - i)) & 0x1) |
+                    (((index >> (7 - i)) & 0x1) << 1);
+            s_nibble_pixels[index][i] = palette[color];
+        }
+    }
+
+    memcpy(s_lut_palette, palette, sizeof(s_lut_palette));
+    s_planes_lut_valid = true;
+}
+
+void
+chip8_render_expand (uint32_t *dst, int pitch, const uint8_t *packed,
+                     int width, int height, uint32_t fg, uint32_t bg)
+{
+    uint32_t *row;
+    int x;
+    int y;
+
+    assert(width % 8 == 0);
+
+    if (!s_lut_valid || fg != s_lut_fg || bg != s_lut_bg) {
+        build_lut(fg, bg);
+    }
+
+    for (y = 0; y < height; y++) {
+        row = (uint32_t *)((uint8_t *)dst + y * pitch);
+        for (x = 0; x < width / 8; x++) {
+            memcpy(&row[x * 8], s_byte_pixels[*packed++],
+                   sizeof(s_byte_pixels[0]));
+        }
+    }
+}
+
+void
+chip8_render_expand_planes (uint32_t *dst, int pitch,
+                            const uint8_t *plane0, const uint8_t *plane1,
+                            int width, int height,
+                            const uint32_t *palette)
+{
+    uint32_t *row;
+    uint8_t lo;
+    uint8_t hi;
+    int x;
+    int y;
+
+    assert(width % 8 == 0);
+
+    if (!s_planes_lut_valid ||
+        memcmp(palette, s_lut_palette, sizeof(s_lut_palette)) != 0) {
+        build_planes_lut(palette);
+    }
+
+    for (y = 0; y < height; y++) {
+        row = (uint32_t *)((uint8_t *)dst + y * pitch);
+        for (x = 0; x < width / 8; x++) {
+            lo = *plane0++;
+            hi = *plane1++;
+            memcpy(&row[x * 8],
+                   s_nibble_pixels[(hi & 0xF0) | (lo >> 4)],
+                   sizeof(s_nibble_pixels[0]));
+            memcpy(&row[x * 8 + 4],
+                   s_nibble_pixels[((hi & 0x0F) << 4) | (lo & 0x0F)],
+                   sizeof(s_nibble_pixels[0]));
+        }
+    }
+}
+
+/* Rows of each glyph, top first, 3 bits each with the leftmost pixel in
+ * bit 2 */
+static const uint8_t s_glyphs[128][GLYPH_HEIGHT] = {
+    ['0'] = { 7, 5, 5, 5, 7 }, ['1'] = { 2, 6, 2, 2, 7 },
+    ['2'] = { 7, 1, 7, 4, 7 }, ['3'] = { 7, 1, 3, 1, 7 },
+    ['4'] = { 5, 5, 7, 1, 1 }, ['5'] = { 7, 4, 7, 1, 7 },
+    ['6'] = { 7, 4, 7, 5, 7 }, ['7'] = { 7, 1, 1, 2, 2 },
+    ['8'] = { 7, 5, 7, 5, 7 }, ['9'] = { 7, 5, 7, 1, 7 },
+    ['A'] = { 2, 5, 7, 5, 5 }, ['B'] = { 6, 5, 6, 5, 6 },
+    ['C'] = { 3, 4, 4, 4, 3 }, ['D'] = { 6, 5, 5, 5, 6 },
+    ['E'] = { 7, 4, 6, 4, 7 }, ['F'] = { 7, 4, 6, 4, 4 },
+    ['G'] = { 3, 4, 5, 5, 3 }, ['H'] = { 5, 5, 7, 5, 5 },
+    ['I'] = { 7, 2, 2, 2, 7 }, ['J'] = { 1, 1, 1, 5, 2 },
+    ['K'] = { 5, 5, 6, 5, 5 }, ['L'] = { 4, 4, 4, 4, 7 },
+    ['M'] = { 5, 7, 7, 5, 5 }, ['N'] = { 6, 5, 5, 5, 5 },
+    ['O'] = { 2, 5, 5, 5, 2 }, ['P'] = { 6, 5, 6, 4, 4 },
+    ['Q'] = { 2, 5, 5, 6, 3 }, ['R'] = { 6, 5, 6, 5, 5 },
+    ['S'] = { 3, 4, 2, 1, 6 }, ['T'] = { 7, 2, 2, 2, 2 },
+    ['U'] = { 5, 5, 5, 5, 7 }, ['V'] = { 5, 5, 5, 5, 2 },
+    ['W'] = { 5, 5, 7, 7, 5 }, ['X'] = { 5, 5, 2, 5, 5 },
+    ['Y'] = { 5, 5, 2, 2, 2 }, ['Z'] = { 7, 1, 2, 4, 7 },
+    ['.'] = { 0, 0, 0, 0, 2 }, [','] = { 0, 0, 0, 2, 4 },
+    [':'] = { 0, 2, 0, 2, 0 }, ['/'] = { 1, 1, 2, 4, 4 },
+    ['%'] = { 5, 1, 2, 4, 5 }, ['-'] = { 0, 0, 7, 0, 0 },
+    ['='] = { 0, 7, 0, 7, 0 }, ['('] = { 1, 2, 2, 2, 1 },
+    [')'] = { 4, 2, 2, 2, 4 },
+};
+
+static void
+draw_glyph (uint32_t *dst, int pitch, int width, int height, int x, int y,
+            int scale, const uint8_t *glyph, uint32_t color)
+{
+    uint32_t *row;
+    int gx;
+    int gy;
+    int px;
+    int py;
+
+    for (gy = 0; gy < GLYPH_HEIGHT * scale; gy++) {
+        py = y + gy;
+        if (py < 0 || py >= height) {
+            continue;
+        }
+        row = (uint32_t *)((uint8_t *)dst + py * pitch);
+        for (gx = 0; gx < GLYPH_WIDTH * scale; gx++) {
+            px = x + gx;
+            if (px >= 0 && px < width &&
+                (glyph[gy / scale] & (0x4 >> (gx / scale)))) {
+                row[px] = color;
+            }
+        }
+    }
+}
+
+void
+chip8_render_text (uint32_t *dst, int pitch, int width, int height,
+                   int x, int y, int scale, const char *text,
+                   uint32_t color)
+{
+    int left = x;
+    int c;
+
+    for (; *text != '\0'; text++) {
+        if (*text == '\n') {
+            x = left;
+            y += CHIP8_RENDER_CELL_HEIGHT * scale;
+            continue;
+        }
+
+        c = toupper((unsigned char)*text);
+        if (c < 128) {
+            draw_glyph(dst, pitch, width, height, x, y, scale, s_glyphs[c],
+                       color);
+        }
+        x += CHIP8_RENDER_CELL_WIDTH * scale;
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * chip8_render - CHIP8 Framebuffer Conversion
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_RENDER_H__
+#define __CHIP8_RENDER_H__
+
+#include <stdint.h>
+
+#define CHIP8_RENDER_DEFAULT_FG 0xFFFFFFFF
+#define CHIP8_RENDER_DEFAULT_BG 0xFF000000
+/* XO-CHIP colors of pixels lit in the second plane only, and in both */
+#define CHIP8_RENDER_DEFAULT_FG2    0xFFFF6600
+#define CHIP8_RENDER_DEFAULT_BLEND  0xFF662200
+
+#define CHIP8_RENDER_NUM_COLORS 4
+
+/* The built-in font has 3x5 pixel glyphs, drawn in 4x6 cells */
+#define CHIP8_RENDER_CELL_WIDTH     4
+#define CHIP8_RENDER_CELL_HEIGHT    6
+
+/**
+ * @brief      Expands a 1 bit per pixel image into ARGB8888 pixels.
+ *
+ * Each source byte is a single copy of eight pixels from a lookup table,
+ * rebuilt only when the colors change.
+ *
+ * @param[out] dst     The first row of destination pixels
+ * @param[in]  pitch   Bytes between the starts of destination rows
+ * @param[in]  packed  Source rows, MSB-first, see chip8_get_vram_packed()
+ * @param[in]  width   Width in pixels, a multiple of 8
+ * @param[in]  height  Height in pixels
+ * @param[in]  fg      Color of set pixels
+ * @param[in]  bg      Color of clear pixels
+ */
+void chip8_render_expand(uint32_t *dst, int pitch, const uint8_t *packed,
+                         int width, int height, uint32_t fg, uint32_t bg);
+
+/**
+ * @brief      Expands two 1 bit per pixel planes into ARGB8888 pixels.
+ *
+ * Works like chip8_render_expand(), four pixels at a time from a lookup
+ * table indexed by a nibble of each plane.
+ *
+ * @param[out] dst      The first row of destination pixels
+ * @param[in]  pitch    Bytes between the starts of destination rows
+ * @param[in]  plane0   Source rows of the first plane
+ * @param[in]  plane1   Source rows of the second plane
+ * @param[in]  width    Width in pixels, a multiple of 8
+ * @param[in]  height   Height in pixels
+ * @param[in]  palette  CHIP8_RENDER_NUM_COLORS colors indexed by plane
+ *                      bits, see chip8_get_pixel()
+ */
+void chip8_render_expand_planes(uint32_t *dst, int pitch,
+                                const uint8_t *plane0, const uint8_t *plane1,
+                                int width, int height,
+                                const uint32_t *palette);
+
+/**
+ * @brief      Draws text in ARGB8888 pixels with the built-in font.
+ *
+ * Only the set pixels of each glyph are written. Lowercase letters draw as
+ * uppercase, characters without a glyph as spaces, and a newline starts
+ * the next row of cells. Text is clipped to width and height.
+ *
+ * @param[out] dst     The first row of destination pixels
+ * @param[in]  pitch   Bytes between the starts of destination rows
+ * @param[in]  width   Width of the destination in pixels
+ * @param[in]  height  Height of the destination in pixels
+ * @param[in]  x       Left edge of the first cell
+ * @param[in]  y       Top edge of the first cell
+ * @param[in]  scale   Destination pixels per font pixel, each way
+ * @param[in]  text    The text
+ * @param[in]  color   Color of the glyphs
+ */
+void chip8_render_text(uint32_t *dst, int pitch, int width, int height,
+                       int x, int y, int scale, const char *text,
+                       uint32_t color);
+
+#endif /* __CHIP8_RENDER_H__ */
@@ -0,0 +1,149 @@
+/*
+ * chip8_rt - CHIP8 Runtime for Recompiled Programs
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_RT_H__
+#define __CHIP8_RT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+#include "chip8_utils.h"
+
+/**
+ * @brief       The calling thread's machine, as seen by recompiled code.
+ *
+ * Recompiled code keeps registers in locals and only writes them back
+ * through these pointers before leaving or calling into the interpreter.
+ */
+typedef struct chip8_rt_s {
+    uint8_t    *memory;
+    uint8_t    *v_regs;
+    uint16_t   *i_reg;
+    uint16_t   *pc;
+    uint16_t   *stack_ptr;
+    bool       *paused_for_key_ld;
+    uint8_t    *rpl_flags;
+    bool       *xochip;
+} chip8_rt_t;
+
+/* Font sprites live at the bottom of memory, 5 bytes per digit. Must
+ * match SPRITE_ADDR() in chip8.c */
+#define CHIP8_RT_FONT_ADDR(_digit)  ((_digit) * 5)
+/* SUPER-CHIP big digits follow, 10 bytes per digit. Must match
+ * BIG_SPRITE_ADDR() in chip8.c */
+#define CHIP8_RT_BIG_FONT_ADDR(_digit)  (0x50 + (_digit) * 10)
+/* Bounds of the classic stack. Must match STACK_END_ADDR and
+ * STACK_BASE_ADDR in chip8.c */
+#define CHIP8_RT_STACK_END_ADDR     0xEA0
+#define CHIP8_RT_STACK_BASE_ADDR    0xEFE
+
+/* SYS addresses native routines can be set for. 00XX is left to the
+ * display instructions. */
+#define CHIP8_RT_HOST_CALL_MIN      0x100
+#define CHIP8_RT_HOST_CALL_MAX      0x1000
+
+/**
+ * @brief       A native routine run by SYS NNN (0NNN).
+ *
+ * Runs on the thread executing the machine, with the PC already past the
+ * SYS. It may change anything rt points at, including the PC; recompiled
+ * code is re-checked against memory afterwards.
+ *
+ * @param[in]   rt      The calling thread's machine
+ * @param[in]   ctx     As passed to chip8_rt_set_host_call()
+ *
+ * @returns     false to fault the machine with CHIP8_FAULT_HOST_CALL
+ */
+typedef bool (*chip8_host_call_t)(chip8_rt_t *rt, void *ctx);
+
+/* Same contract as chip8_run() */
+typedef uint32_t (*chip8_native_run_t)(uint32_t count);
+/* Called whenever memory was replaced wholesale */
+typedef void (*chip8_native_invalidate_t)(void);
+
+/**
+ * @brief       Gets the calling thread's machine
+ */
+chip8_rt_t *chip8_rt_get(void);
+
+/**
+ * @brief       Runs the interpreter, without any debugging checks
+ *
+ * @param[in]   count   Maximum number of instructions to execute
+ *
+ * @returns     The number of instructions executed
+ */
+uint32_t chip8_rt_interpret(uint32_t count);
+
+/**
+ * @brief       DRW: draws a sprite from memory into VRAM
+ *
+ * @returns     The new value of VF
+ */
+uint8_t chip8_rt_draw(uint8_t x, uint8_t y, uint16_t sprite_addr,
+                      uint8_t num_bytes);
+
+/**
+ * @brief       CLS: clears VRAM
+ */
+void chip8_rt_clear(void);
+
+/**
+ * @brief       Runs one of the 00XX display instructions, CLS and the
+ *              SUPER-CHIP scroll, resolution and EXIT instructions
+ */
+void chip8_rt_display_op(uint16_t op);
+
+/**
+ * @brief       Makes chip8_run() use native code on the calling thread.
+ *
+ * The interpreter is still used while debugging. invalidate is called
+ * after a program load or a state restore.
+ *
+ * @param[in]   run         The native run loop, NULL to go back to
+ *                          interpreting
+ * @param[in]   invalidate  May be NULL
+ */
+void chip8_rt_set_native(chip8_native_run_t run,
+                         chip8_native_invalidate_t invalidate);
+
+/**
+ * @brief       Makes SYS addr run a native routine instead of faulting.
+ *
+ * The routines are shared by every thread, set them before any machine
+ * runs.
+ *
+ * @param[in]   addr    The SYS address, CHIP8_RT_HOST_CALL_MIN and up
+ * @param[in]   call    The routine, NULL to remove it
+ * @param[in]   ctx     Passed to the routine
+ *
+ * @returns     false if addr is out of range
+ */
+bool chip8_rt_set_host_call(uint16_t addr, chip8_host_call_t call,
+                            void *ctx);
+
+/* Provided by the C file chip8-recomp generates for a program */
+
+/**
+ * @brief       Switches the calling thread to the recompiled code.
+ *
+ * @returns     false if the loaded program is not the one that was
+ *              recompiled, or the machine is in XO-CHIP mode
+ */
+bool chip8_recomp_attach(void);
+
+/**
+ * @brief       Runs the recompiled program, see chip8_run()
+ */
+uint32_t chip8_recomp_run(uint32_t count);
+
+/**
+ * @brief       Re-checks which blocks still match memory
+ */
+void chip8_recomp_invalidate(void);
+
+#endif /* __CHIP8_RT_H__ */
@@ -0,0 +1,219 @@
+/*
+ * chip8_shm - CHIP8 Shared Memory Framebuffer Export
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_shm.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define SHM_MAX_NAME    256
+
+static chip8_shm_t *s_shm = NULL;
+static char s_name[SHM_MAX_NAME];
+/* Only the writer changes published, it keeps its own copy */
+static uint64_t s_published;
+
+bool
+chip8_shm_create (const char *name)
+{
+    int fd;
+
+    if (s_shm != NULL) {
+        return false;
+    }
+    if (snprintf(s_name, sizeof(s_name), "%s", name) >= sizeof(s_name)) {
+        printf("Shared memory name %s is too long\n", name);
+        return false;
+    }
+
+    /* A segment left by a crashed run may have another layout */
+    shm_unlink(s_name);
+    fd = shm_open(s_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("Unable to create shared memory %s - %s\n", s_name,
+               strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, sizeof(*s_shm)) != 0) {
+        printf("Unable to size shared memory %s - %s\n", s_name,
+               strerror(errno));
+        close(fd);
+        shm_unlink(s_name);
+        return false;
+    }
+
+    s_shm = mmap(NULL, sizeof(*s_shm), PROT_READ | PROT_WRITE, MAP_SHARED,
+                 fd, 0);
+    close(fd);
+    if (s_shm == MAP_FAILED) {
+        printf("Unable to map shared memory %s - %s\n", s_name,
+               strerror(errno));
+        s_shm = NULL;
+        shm_unlink(s_name);
+        return false;
+    }
+
+    /* ftruncate() zeroed it, every slot reads as never written. The magic
+     * goes last, readers that see it see the rest. */
+    s_published = 0;
+    s_shm->version = CHIP8_SHM_VERSION;
+    s_shm->num_slots = CHIP8_SHM_SLOTS;
+    s_shm->slot_size = sizeof(chip8_shm_slot_t);
+    atomic_thread_fence(memory_order_release);
+    s_shm->magic = CHIP8_SHM_MAGIC;
+
+    return true;
+}
+
+void
+chip8_shm_destroy (void)
+{
+    if (s_shm == NULL) {
+        return;
+    }
+
+    munmap(s_shm, sizeof(*s_shm));
+    shm_unlink(s_name);
+    s_shm = NULL;
+}
+
+void
+chip8_shm_publish (const chip8_frontend_frame_t *screen, uint64_t frame)
+{
+    chip8_shm_slot_t *slot;
+    struct timespec now;
+    int plane;
+
+    if (s_shm == NULL) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    slot = &s_shm->slots[s_published % CHIP8_SHM_SLOTS];
+
+    /* The odd sequence number has to be visible before any of the data */
+    atomic_store_explicit(&slot->seq, 2 * s_published + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->frame = frame;
+    slot->time_ns = (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+    slot->width = screen->width;
+    slot->height = screen->height;
+    slot->planes = screen->planes;
+    for (plane = 0; plane < screen->planes; plane++) {
+        memcpy(slot->packed[plane], screen->packed[plane],
+               screen->width / 8 * screen->height);
+    }
+
+    atomic_store_explicit(&slot->seq, 2 * s_published + 2,
+                          memory_order_release);
+    atomic_store_explicit(&s_shm->published, ++s_published,
+                          memory_order_release);
+}
+
+const chip8_shm_t *
+chip8_shm_attach (const char *name)
+{
+    chip8_shm_t *shm;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Unable to open shared memory %s - %s\n", name,
+               strerror(errno));
+        return NULL;
+    }
+    shm = mmap(NULL, sizeof(*shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        printf("Unable to map shared memory %s - %s\n", name,
+               strerror(errno));
+        return NULL;
+    }
+
+    if (shm->magic != CHIP8_SHM_MAGIC) {
+        printf("%s is not a CHIP8 framebuffer\n", name);
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (shm->version != CHIP8_SHM_VERSION ||
+        shm->num_slots != CHIP8_SHM_SLOTS ||
+        shm->slot_size != sizeof(chip8_shm_slot_t)) {
+        printf("%s is version %u, expected %u\n", name, shm->version,
+               CHIP8_SHM_VERSION);
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+
+    return shm;
+}
+
+void
+chip8_shm_detach (const chip8_shm_t *shm)
+{
+    if (shm != NULL) {
+        munmap((void *)shm, sizeof(*shm));
+    }
+}
+
+chip8_shm_result_et
+chip8_shm_read_begin (const chip8_shm_t *shm, uint64_t index,
+                      const chip8_shm_slot_t **slot)
+{
+    uint64_t seq;
+
+    *slot = &shm->slots[index % CHIP8_SHM_SLOTS];
+    seq = atomic_load_explicit(&(*slot)->seq, memory_order_acquire);
+    if (seq == 2 * index + 2) {
+        return CHIP8_SHM_OK;
+    }
+
+    /* Still being written, or a frame this slot held before */
+    return (seq < 2 * index + 2) ? CHIP8_SHM_PENDING : CHIP8_SHM_LAPPED;
+}
+
+bool
+chip8_shm_read_end (const chip8_shm_t *shm, uint64_t index)
+{
+    const chip8_shm_slot_t *slot = &shm->slots[index % CHIP8_SHM_SLOTS];
+
+    /* Orders the reads of the data before the second look at seq */
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) ==
+           2 * index + 2;
+}
+
+chip8_shm_result_et
+chip8_shm_read (const chip8_shm_t *shm, uint64_t index,
+                chip8_shm_slot_t *slot)
+{
+    const chip8_shm_slot_t *shared;
+    chip8_shm_result_et result;
+
+    result = chip8_shm_read_begin(shm, index, &shared);
+    if (result != CHIP8_SHM_OK) {
+        return result;
+    }
+
+    /* seq is atomic, the rest is copied after it */
+    memcpy((uint8_t *)slot + offsetof(chip8_shm_slot_t, frame),
+           (const uint8_t *)shared + offsetof(chip8_shm_slot_t, frame),
+           sizeof(*slot) - offsetof(chip8_shm_slot_t, frame));
+    if (!chip8_shm_read_end(shm, index)) {
+        return CHIP8_SHM_LAPPED;
+    }
+    atomic_store_explicit(&slot->seq, 2 * index + 2, memory_order_relaxed);
+
+    return CHIP8_SHM_OK;
+}
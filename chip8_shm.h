@@ -0,0 +1,128 @@
+/*
+ * chip8_shm - CHIP8 Shared Memory Framebuffer Export
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_SHM_H__
+#define __CHIP8_SHM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "chip8.h"
+#include "chip8_frontend.h"
+
+/* "C8FB" */
+#define CHIP8_SHM_MAGIC     0x43384642u
+#define CHIP8_SHM_VERSION   1
+/* About a quarter of a second of changed frames at 60 Hz */
+#define CHIP8_SHM_SLOTS     16
+
+/**
+ * @brief      One frame of the ring.
+ *
+ * seq is twice the frame's index in the ring plus one while it is
+ * written, and plus two once it is complete. A reader of index i checks
+ * seq is 2 * i + 2 before and after looking at the rest.
+ */
+typedef struct chip8_shm_slot_s {
+    _Alignas(64) _Atomic uint64_t seq;
+    /* Main loop pass the frame was drawn in */
+    uint64_t    frame;
+    /* CLOCK_MONOTONIC when it was published */
+    uint64_t    time_ns;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    planes;
+    /* See chip8_get_vram_packed(), planes past the first are only valid
+     * for XO-CHIP */
+    uint8_t     packed[NUM_PLANES][PACKED_VRAM_SIZE];
+} chip8_shm_slot_t;
+
+/**
+ * @brief      The layout of the shared memory segment
+ */
+typedef struct chip8_shm_s {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    num_slots;
+    uint32_t    slot_size;
+    /* Frames published so far, frame i is in slot i % num_slots */
+    _Alignas(64) _Atomic uint64_t published;
+    chip8_shm_slot_t slots[CHIP8_SHM_SLOTS];
+} chip8_shm_t;
+
+/**
+ * @brief      Results of chip8_shm_read()
+ */
+typedef enum {
+    CHIP8_SHM_OK,
+    /* Not published yet */
+    CHIP8_SHM_PENDING,
+    /* Overwritten by a later frame before or while it was read */
+    CHIP8_SHM_LAPPED,
+} chip8_shm_result_et;
+
+/**
+ * @brief      Creates the segment, replacing any left over with that name
+ *
+ * @param[in]  name    A shm_open() name, such as /chip8
+ *
+ * @returns    true on success, prints why not otherwise
+ */
+bool chip8_shm_create(const char *name);
+
+/**
+ * @brief      Unmaps and removes the segment
+ */
+void chip8_shm_destroy(void);
+
+/**
+ * @brief      Adds a frame to the ring. Never blocks, readers that fall
+ *             more than CHIP8_SHM_SLOTS frames behind lose frames.
+ *
+ * Call from one thread only.
+ *
+ * @param[in]  screen  The frame
+ * @param[in]  frame   Its main loop pass
+ */
+void chip8_shm_publish(const chip8_frontend_frame_t *screen, uint64_t frame);
+
+/**
+ * @brief      Maps a segment read-only, for consumers
+ *
+ * @returns    The segment, or NULL if it is missing or of another version
+ */
+const chip8_shm_t *chip8_shm_attach(const char *name);
+
+void chip8_shm_detach(const chip8_shm_t *shm);
+
+/**
+ * @brief      Starts reading frame index in place, zero-copy
+ *
+ * @param[out] slot    Where frame index is
+ *
+ * @returns    CHIP8_SHM_OK, and the slot is valid until
+ *             chip8_shm_read_end() says otherwise
+ */
+chip8_shm_result_et chip8_shm_read_begin(const chip8_shm_t *shm,
+                                         uint64_t index,
+                                         const chip8_shm_slot_t **slot);
+
+/**
+ * @brief      Checks a slot was not overwritten while it was read
+ *
+ * @returns    true if everything read since chip8_shm_read_begin() is
+ *             frame index
+ */
+bool chip8_shm_read_end(const chip8_shm_t *shm, uint64_t index);
+
+/**
+ * @brief      Copies frame index out of the ring
+ */
+chip8_shm_result_et chip8_shm_read(const chip8_shm_t *shm, uint64_t index,
+                                   chip8_shm_slot_t *slot);
+
+#endif /* __CHIP8_SHM_H__ */
@@ -4,14 +4,154 @@
  * Mike Mallin, 2021
  */
 
+#include "chip8_sound.h"
+
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
 #include <SDL2/SDL_mixer.h>
 
+#include "chip8.h"
+
+/* Pattern samples per second at DEFAULT_AUDIO_PITCH */
+#define PATTERN_BASE_RATE	4000.0
+#define PATTERN_BITS		(AUDIO_PATTERN_SIZE * 8)
+#define PATTERN_WORDS		(AUDIO_PATTERN_SIZE / 8)
+#define PATTERN_AMPLITUDE	(INT16_MAX / 8)
+/* Attempts at a consistent read before the callback keeps what it has */
+#define PATTERN_READ_TRIES	4
+
 Mix_Chunk *s_beep_sample = NULL;
 
+/* Output format, as actually opened */
+static int s_output_freq;
+static int s_output_channels;
+
+/* Handoff from the emulation thread to the audio callback. A sequence
+ * lock: the writer makes s_pattern_seq odd while it updates the fields,
+ * the reader retries if the sequence was odd or moved. Neither side
+ * ever blocks the other. */
+static atomic_uint s_pattern_seq;
+static _Atomic uint64_t s_pattern_words[PATTERN_WORDS];
+/* Pattern bits per output sample, 32.32 fixed point */
+static _Atomic uint64_t s_pattern_step;
+static atomic_bool s_pattern_playing;
+
+/* Last published values, only touched by the emulation thread */
+static uint8_t s_published_pattern[AUDIO_PATTERN_SIZE];
+static uint8_t s_published_pitch;
+static bool s_published_playing;
+static bool s_published_valid = false;
+
+/* Callback state, only touched by the audio thread */
+typedef struct pattern_params_s {
+	uint64_t	words[PATTERN_WORDS];
+	uint64_t	step;
+	bool		playing;
+} pattern_params_t;
+
+static pattern_params_t s_params;
+static uint64_t s_phase;
+static uint64_t s_last_callback_ns;
+
+/* Callbacks that came too late to keep the device fed, read from any
+ * thread */
+static _Atomic uint64_t s_underruns;
+
+static bool
+read_pattern_params (pattern_params_t *params)
+{
+	pattern_params_t read;
+	unsigned seq;
+	int tries;
+	int i;
+
+	for (tries = 0; tries < PATTERN_READ_TRIES; tries++) {
+		seq = atomic_load_explicit(&s_pattern_seq, memory_order_acquire);
+		if (seq & 1) {
+			continue;
+		}
+
+		for (i = 0; i < PATTERN_WORDS; i++) {
+			read.words[i] = atomic_load_explicit(&s_pattern_words[i],
+			                                     memory_order_relaxed);
+		}
+		read.step = atomic_load_explicit(&s_pattern_step,
+		                                 memory_order_relaxed);
+		read.playing = atomic_load_explicit(&s_pattern_playing,
+		                                    memory_order_relaxed);
+
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&s_pattern_seq,
+		                         memory_order_relaxed) == seq) {
+			*params = read;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* The device asks for the next buffer as it starts playing the last one.
+ * Asking more than two buffers' worth of time later means it ran dry. */
+static void
+note_callback (int frames)
+{
+	struct timespec ts;
+	uint64_t now;
+	uint64_t period;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+	period = (uint64_t)frames * 1000000000ull / s_output_freq;
+
+	if (s_last_callback_ns != 0 && now - s_last_callback_ns > 2 * period) {
+		atomic_fetch_add_explicit(&s_underruns, 1, memory_order_relaxed);
+	}
+	s_last_callback_ns = now;
+}
+
+/* Runs on the audio thread. SDL_mixer calls the music hook before it
+ * mixes the channels in on top of what the hook wrote. */
+static void
+pattern_callback (void *udata, Uint8 *stream, int len)
+{
+	int16_t *out = (int16_t *)stream;
+	int frames = len / (int)(sizeof(int16_t) * s_output_channels);
+	unsigned bit;
+	int16_t sample;
+	int frame;
+	int c;
+
+	note_callback(frames);
+
+	/* On a torn read, play this buffer with the previous parameters */
+	read_pattern_params(&s_params);
+
+	if (!s_params.playing) {
+		memset(stream, 0, len);
+		return;
+	}
+
+	/* The phase carries over between buffers, so the waveform is
+	 * continuous however the emulation thread is scheduled */
+	for (frame = 0; frame < frames; frame++) {
+		bit = (unsigned)(s_phase >> 32) % PATTERN_BITS;
+		sample = ((s_params.words[bit / 64] >> (63 - bit % 64)) & 0x1) ?
+		         PATTERN_AMPLITUDE : -PATTERN_AMPLITUDE;
+		for (c = 0; c < s_output_channels; c++) {
+			*out++ = sample;
+		}
+		s_phase += s_params.step;
+	}
+}
+
 void
 chip8_sound_init (void)
 {
+	Uint16 format;
 	int result;
 
 	result = Mix_OpenAudio(44100, AUDIO_S16SYS, 2, 512);
@@ -30,6 +170,14 @@ chip8_sound_init (void)
 	if (s_beep_sample == NULL) {
 		fprintf(stderr, "Failed to load ./beep.wav\n");
 	}
+
+	if (Mix_QuerySpec(&s_output_freq, &format, &s_output_channels) == 0 ||
+	    format != AUDIO_S16SYS) {
+		fprintf(stderr, "Unexpected audio format, no pattern playback\n");
+		return;
+	}
+
+	Mix_HookMusic(pattern_callback, NULL);
 }
 
 void
@@ -43,9 +191,62 @@ chip8_sound_beep (void)
 	}
 }
 
+void
+chip8_sound_set_pattern (const uint8_t *pattern, uint8_t pitch, bool playing)
+{
+	uint64_t words[PATTERN_WORDS] = { 0 };
+	uint64_t step;
+	unsigned seq;
+	int i;
+
+	if (s_published_valid && playing == s_published_playing &&
+	    pitch == s_published_pitch &&
+	    memcmp(pattern, s_published_pattern, AUDIO_PATTERN_SIZE) == 0) {
+		return;
+	}
+
+	for (i = 0; i < AUDIO_PATTERN_SIZE; i++) {
+		words[i / 8] |= (uint64_t)pattern[i] << (56 - (i % 8) * 8);
+	}
+
+	/* Resampling ratio, worked out here to keep pow() off the audio
+	 * thread */
+	step = 0;
+	if (s_output_freq > 0) {
+		step = (uint64_t)(PATTERN_BASE_RATE *
+		                  pow(2.0, (pitch - DEFAULT_AUDIO_PITCH) / 48.0) /
+		                  s_output_freq * 4294967296.0);
+	}
+
+	seq = atomic_load_explicit(&s_pattern_seq, memory_order_relaxed);
+	atomic_store_explicit(&s_pattern_seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	for (i = 0; i < PATTERN_WORDS; i++) {
+		atomic_store_explicit(&s_pattern_words[i], words[i],
+		                      memory_order_relaxed);
+	}
+	atomic_store_explicit(&s_pattern_step, step, memory_order_relaxed);
+	atomic_store_explicit(&s_pattern_playing, playing, memory_order_relaxed);
+
+	atomic_store_explicit(&s_pattern_seq, seq + 2, memory_order_release);
+
+	memcpy(s_published_pattern, pattern, AUDIO_PATTERN_SIZE);
+	s_published_pitch = pitch;
+	s_published_playing = playing;
+	s_published_valid = true;
+}
+
 void
 chip8_sound_deinit (void)
 {
+	Mix_HookMusic(NULL, NULL);
 	Mix_FreeChunk(s_beep_sample);
 	Mix_CloseAudio();
 }
+
+uint64_t
+chip8_sound_get_underruns (void)
+{
+	return atomic_load_explicit(&s_underruns, memory_order_relaxed);
+}
@@ -7,6 +7,9 @@
 #ifndef __CHIP8_SOUND_H__
 #define __CHIP8_SOUND_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+
 void
 chip8_sound_init(void);
 
@@ -16,4 +19,26 @@ chip8_sound_deinit(void);
 void
 chip8_sound_beep(void);
 
+/**
+ * @brief      Hands the XO-CHIP audio pattern to the audio callback.
+ *
+ * Call from the emulation thread whenever the machine may have changed
+ * them, unchanged values are not republished. Never blocks on the audio
+ * thread.
+ *
+ * @param[in]  pattern  AUDIO_PATTERN_SIZE bytes, see chip8_get_audio()
+ * @param[in]  pitch    The FX3A pitch
+ * @param[in]  playing  true while the sound timer runs
+ */
+void
+chip8_sound_set_pattern(const uint8_t *pattern, uint8_t pitch, bool playing);
+
+/**
+ * @brief      Gets how many times the audio device ran out of samples.
+ *
+ * Safe from any thread.
+ */
+uint64_t
+chip8_sound_get_underruns(void);
+
 #endif /* __CHIP8_SOUND_H__ */
@@ -0,0 +1,331 @@
+/*
+ * chip8_stream - CHIP8 Spectator Streaming
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_stream.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "chip8_codec.h"
+
+#define STREAM_MAX_PATH     108
+/* A length prefix and the largest frame */
+#define STREAM_MAX_MESSAGE  (CHIP8_CODEC_MAX_VARINT + CHIP8_CODEC_MAX_FRAME)
+/* Set in s_middle when the emulation thread put a frame there that the
+ * serving thread has not taken */
+#define STREAM_FRESH        4
+
+/* macOS has SO_NOSIGPIPE instead */
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef struct stream_frame_s {
+    chip8_frontend_frame_t  screen;
+    uint64_t                number;
+} stream_frame_t;
+
+typedef struct stream_client_s {
+    int                     fd;
+    /* What is left to send of the last message */
+    uint8_t                 out[STREAM_MAX_MESSAGE];
+    size_t                  out_len;
+    size_t                  out_sent;
+    /* The last frame it was sent, deltas are against it */
+    chip8_frontend_frame_t  prev;
+    uint64_t                number;
+    bool                    have_prev;
+} stream_client_t;
+
+/* A triple buffer. The emulation thread fills s_frames[s_back] and swaps
+ * it for the middle one, the serving thread swaps its front one for the
+ * middle one when that is fresh. Neither ever waits. */
+static stream_frame_t s_frames[3];
+static int s_back = 0;
+static int s_front = 1;
+static atomic_uint s_middle = 2;
+
+static bool s_running = false;
+static pthread_t s_thread;
+static char s_path[STREAM_MAX_PATH];
+static int s_listen_fd = -1;
+static int s_stop_pipe[2] = { -1, -1 };
+/* Written to, without blocking, for each published frame */
+static int s_wake_pipe[2] = { -1, -1 };
+
+/* Only touched by the serving thread */
+static stream_client_t s_clients[CHIP8_STREAM_MAX_CLIENTS];
+static unsigned s_num_clients;
+
+void
+chip8_stream_publish (const chip8_frontend_frame_t *screen, uint64_t frame)
+{
+    stream_frame_t *back;
+    int plane;
+
+    if (!s_running) {
+        return;
+    }
+
+    back = &s_frames[s_back];
+    back->screen.width = screen->width;
+    back->screen.height = screen->height;
+    back->screen.planes = screen->planes;
+    for (plane = 0; plane < screen->planes; plane++) {
+        memcpy(back->screen.packed[plane], screen->packed[plane],
+               screen->width / 8 * screen->height);
+    }
+    back->number = frame;
+
+    s_back = atomic_exchange_explicit(&s_middle, s_back | STREAM_FRESH,
+                                      memory_order_acq_rel) & 3;
+
+    /* Full means the serving thread has a wakeup coming anyway */
+    (void)!write(s_wake_pipe[1], "", 1);
+}
+
+static void
+drop_client (unsigned i)
+{
+    close(s_clients[i].fd);
+    s_clients[i] = s_clients[--s_num_clients];
+}
+
+/* Sends what it can without blocking, false if the client went away */
+static bool
+flush_client (stream_client_t *client)
+{
+    ssize_t sent;
+
+    while (client->out_sent < client->out_len) {
+        sent = send(client->fd, &client->out[client->out_sent],
+                    client->out_len - client->out_sent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK ||
+                    errno == EINTR);
+        }
+        client->out_sent += sent;
+    }
+
+    client->out_len = 0;
+    client->out_sent = 0;
+    return true;
+}
+
+static void
+accept_client (void)
+{
+    stream_client_t *client;
+    int fd;
+
+    fd = accept(s_listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    if (s_num_clients == CHIP8_STREAM_MAX_CLIENTS ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        close(fd);
+        return;
+    }
+
+    client = &s_clients[s_num_clients++];
+    client->fd = fd;
+    memcpy(client->out, CHIP8_STREAM_MAGIC, CHIP8_STREAM_MAGIC_LEN);
+    client->out[CHIP8_STREAM_MAGIC_LEN] = CHIP8_STREAM_VERSION;
+    client->out_len = CHIP8_STREAM_MAGIC_LEN + 1;
+    client->out_sent = 0;
+    client->have_prev = false;
+}
+
+/* Queues the latest frame for a client that has sent everything else */
+static void
+queue_frame (stream_client_t *client, const stream_frame_t *latest)
+{
+    static uint8_t s_encoded[CHIP8_CODEC_MAX_FRAME];
+    size_t len;
+
+    len = chip8_codec_encode_frame(client->have_prev ? &client->prev : NULL,
+                                   &latest->screen, latest->number,
+                                   s_encoded);
+    client->out_len = chip8_codec_put_varint(client->out, len);
+    memcpy(&client->out[client->out_len], s_encoded, len);
+    client->out_len += len;
+    client->out_sent = 0;
+
+    client->prev = latest->screen;
+    client->number = latest->number;
+    client->have_prev = true;
+}
+
+static void *
+serve (void *arg)
+{
+    struct pollfd fds[3 + CHIP8_STREAM_MAX_CLIENTS];
+    const stream_frame_t *latest = NULL;
+    stream_client_t *client;
+    char drain[64];
+    unsigned i;
+
+    for (;;) {
+        fds[0] = (struct pollfd){ .fd = s_stop_pipe[0], .events = POLLIN };
+        fds[1] = (struct pollfd){ .fd = s_wake_pipe[0], .events = POLLIN };
+        fds[2] = (struct pollfd){ .fd = s_listen_fd, .events = POLLIN };
+        for (i = 0; i < s_num_clients; i++) {
+            fds[3 + i] = (struct pollfd){
+                .fd = s_clients[i].fd,
+                .events = POLLIN | (s_clients[i].out_len ? POLLOUT : 0),
+            };
+        }
+
+        if (poll(fds, 3 + s_num_clients, -1) < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            while (read(s_wake_pipe[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        if (atomic_load_explicit(&s_middle, memory_order_relaxed) &
+            STREAM_FRESH) {
+            s_front = atomic_exchange_explicit(&s_middle, s_front,
+                                               memory_order_acq_rel) & 3;
+            latest = &s_frames[s_front];
+        }
+
+        /* Backwards, dropping moves the last client into the hole */
+        for (i = s_num_clients; i-- > 0;) {
+            client = &s_clients[i];
+            /* Clients have nothing to say, input is only read to notice
+             * them hang up */
+            if ((fds[3 + i].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                (read(client->fd, drain, sizeof(drain)) <= 0 ||
+                 (fds[3 + i].revents & POLLERR))) {
+                drop_client(i);
+                continue;
+            }
+            if (!flush_client(client)) {
+                drop_client(i);
+                continue;
+            }
+            if (client->out_len == 0 && latest != NULL &&
+                (!client->have_prev || client->number != latest->number)) {
+                queue_frame(client, latest);
+                if (!flush_client(client)) {
+                    drop_client(i);
+                }
+            }
+        }
+
+        /* The hello goes out, and the keyframe after it, once the next
+         * poll says the socket is writable */
+        if (fds[2].revents & POLLIN) {
+            accept_client();
+        }
+    }
+
+    return NULL;
+}
+
+static bool
+open_socket (const char *path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    struct stat st;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Stream socket path %s is too long\n", path);
+        return false;
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    /* Left behind by an earlier run. Never remove anything else. */
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    s_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s_listen_fd < 0 ||
+        bind(s_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(s_listen_fd, 8) != 0) {
+        printf("Unable to stream on %s - %s\n", path, strerror(errno));
+        if (s_listen_fd >= 0) {
+            close(s_listen_fd);
+            s_listen_fd = -1;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool
+chip8_stream_start (const char *path)
+{
+    if (s_running) {
+        return false;
+    }
+    snprintf(s_path, sizeof(s_path), "%s", path);
+
+    if (!open_socket(s_path)) {
+        return false;
+    }
+
+    if (pipe(s_stop_pipe) != 0 || pipe(s_wake_pipe) != 0 ||
+        fcntl(s_wake_pipe[0], F_SETFL, O_NONBLOCK) != 0 ||
+        fcntl(s_wake_pipe[1], F_SETFL, O_NONBLOCK) != 0 ||
+        pthread_create(&s_thread, NULL, serve, NULL) != 0) {
+        printf("Unable to start streaming - %s\n", strerror(errno));
+        chip8_stream_stop();
+        return false;
+    }
+
+    s_running = true;
+    return true;
+}
+
+static void
+close_pipe (int fds[2])
+{
+    if (fds[0] >= 0) {
+        close(fds[0]);
+        close(fds[1]);
+        fds[0] = -1;
+        fds[1] = -1;
+    }
+}
+
+void
+chip8_stream_stop (void)
+{
+    if (s_running) {
+        (void)!write(s_stop_pipe[1], "", 1);
+        pthread_join(s_thread, NULL);
+        s_running = false;
+    }
+
+    while (s_num_clients > 0) {
+        drop_client(s_num_clients - 1);
+    }
+    if (s_listen_fd >= 0) {
+        close(s_listen_fd);
+        s_listen_fd = -1;
+        unlink(s_path);
+    }
+    close_pipe(s_stop_pipe);
+    close_pipe(s_wake_pipe);
+}
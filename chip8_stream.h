@@ -0,0 +1,54 @@
+/*
+ * chip8_stream - CHIP8 Spectator Streaming
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_STREAM_H__
+#define __CHIP8_STREAM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8_frontend.h"
+
+/* Sent on connecting, followed by the version byte */
+#define CHIP8_STREAM_MAGIC      "C8ST"
+#define CHIP8_STREAM_MAGIC_LEN  4
+#define CHIP8_STREAM_VERSION    1
+#define CHIP8_STREAM_MAX_CLIENTS    16
+
+/**
+ * @brief      Starts serving frames on a UNIX domain socket, from a
+ *             background thread.
+ *
+ * After the magic and version, a client gets a keyframe and then deltas.
+ * Each is a varint length and a frame from chip8_codec_encode_frame().
+ * A client still sending the last frame when a new one arrives skips it,
+ * its next delta covers everything it missed.
+ *
+ * @param[in]  path    Where to listen
+ *
+ * @returns    true on success, prints why not otherwise
+ */
+bool chip8_stream_start(const char *path);
+
+/**
+ * @brief      Disconnects every client and stops listening
+ */
+void chip8_stream_stop(void);
+
+/**
+ * @brief      Hands a frame to the serving thread. Call from the emulation
+ *             thread, never blocks.
+ *
+ * Only the latest frame is kept. One published before the serving thread
+ * took the last is replaced.
+ *
+ * @param[in]  screen  The frame
+ * @param[in]  frame   Its main loop pass
+ */
+void chip8_stream_publish(const chip8_frontend_frame_t *screen,
+                          uint64_t frame);
+
+#endif /* __CHIP8_STREAM_H__ */
@@ -0,0 +1,332 @@
+/*
+ * chip8_term - CHIP8 Terminal Frontend
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_term.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "chip8_utils.h"
+
+#define TERM_ENTER      "\x1b[?1049h\x1b[?25l"
+#define TERM_LEAVE      "\x1b[?25h\x1b[?1049l"
+#define TERM_CLEAR      "\x1b[H\x1b[2J"
+/* The longest cursor move, "\x1b[32;128H" */
+#define TERM_MAX_MOVE   16
+#define TERM_MAX_CELL   CHIP8_TERM_MAX_CELL
+/* There is no refresh to wait for, the main loop is paced at 60 Hz all
+ * the same so an unchanged screen costs next to nothing */
+#define TERM_FRAME_NS   (1000000000ull / 60)
+
+/* Indexed by the top pixel in bit 0 and the bottom one in bit 1 */
+static const char *s_half_blocks[] = {
+    " ", "\xE2\x96\x80", "\xE2\x96\x84", "\xE2\x96\x88",
+};
+static const size_t s_half_block_lens[] = { 1, 3, 3, 3 };
+
+/* Indexed by chip8 key, the same layout as the SDL window */
+static const char s_keymap[] = "x123qweasdzc4rfv";
+
+/* What the terminal shows, 0 width until the next frame clears it */
+static uint8_t s_cells[DISPLAY_HEIGHT_PIXELS / 2][DISPLAY_WIDTH_PIXELS];
+static int s_width;
+static int s_height;
+/* Column -1 is just past the last one, where the next character wraps */
+static int s_cursor_row;
+static int s_cursor_col;
+
+static struct termios s_saved_termios;
+static bool s_raw = false;
+static char s_out[CHIP8_TERM_BUFFER_SIZE];
+/* The last chip8_term_render() ran out of room */
+static bool s_render_cut_short;
+static size_t s_out_len;
+static uint64_t s_next_present;
+/* When each key is released, 0 while it is up */
+static uint64_t s_held_until[CHIP8_KEY_MAX];
+
+void
+chip8_term_reset (void)
+{
+    s_width = 0;
+    s_height = 0;
+}
+
+/* Moves the cursor to the cell, returns the bytes written to out */
+static size_t
+move_cursor (int row, int col, char *out)
+{
+    char move[TERM_MAX_MOVE];
+    size_t len;
+    size_t rewrite = 0;
+    int i;
+
+    if (row == s_cursor_row && col == s_cursor_col) {
+        return 0;
+    }
+
+    /* Absolute, 1-based, leaving out what defaults to 1. Relative moves
+     * within the row are never longer. */
+    if (row == 0 && col == 0) {
+        len = snprintf(move, sizeof(move), "\x1b[H");
+    } else if (col == 0) {
+        len = snprintf(move, sizeof(move), "\x1b[%dH", row + 1);
+    } else {
+        len = snprintf(move, sizeof(move), "\x1b[%d;%dH", row + 1, col + 1);
+    }
+
+    if (col == 0 && row == s_cursor_row) {
+        len = snprintf(move, sizeof(move), "\r");
+    } else if (col == 0 && row == s_cursor_row + 1) {
+        len = snprintf(move, sizeof(move), "\r\n");
+    } else if (row == s_cursor_row && s_cursor_col >= 0 &&
+               col > s_cursor_col) {
+        if (col - s_cursor_col == 1) {
+            len = snprintf(move, sizeof(move), "\x1b[C");
+        } else {
+            len = snprintf(move, sizeof(move), "\x1b[%dC",
+                           col - s_cursor_col);
+        }
+
+        /* The cells in between are unchanged, so drawing them again is
+         * a move too */
+        for (i = s_cursor_col; i < col && rewrite < len; i++) {
+            rewrite += s_half_block_lens[s_cells[row][i]];
+        }
+        if (rewrite < len) {
+            len = 0;
+            for (i = s_cursor_col; i < col; i++) {
+                memcpy(&out[len], s_half_blocks[s_cells[row][i]],
+                       s_half_block_lens[s_cells[row][i]]);
+                len += s_half_block_lens[s_cells[row][i]];
+            }
+            return len;
+        }
+    }
+
+    memcpy(out, move, len);
+    return len;
+}
+
+size_t
+chip8_term_render (const chip8_frontend_frame_t *frame, char *out,
+                   size_t len)
+{
+    int stride = frame->width / 8;
+    const uint8_t *top;
+    const uint8_t *bottom;
+    size_t used = 0;
+    uint8_t glyph;
+    uint8_t bit;
+    int plane;
+    int row;
+    int col;
+
+    s_render_cut_short = false;
+    if (frame->width != s_width || frame->height != s_height) {
+        if (len < sizeof(TERM_CLEAR)) {
+            s_render_cut_short = true;
+            return 0;
+        }
+        memcpy(out, TERM_CLEAR, sizeof(TERM_CLEAR) - 1);
+        used = sizeof(TERM_CLEAR) - 1;
+        memset(s_cells, 0, sizeof(s_cells));
+        s_width = frame->width;
+        s_height = frame->height;
+        s_cursor_row = 0;
+        s_cursor_col = 0;
+    }
+
+    for (row = 0; row < frame->height / 2; row++) {
+        for (col = 0; col < frame->width; col++) {
+            bit = 0x80 >> (col % 8);
+            glyph = 0;
+            for (plane = 0; plane < frame->planes; plane++) {
+                top = &frame->packed[plane][2 * row * stride];
+                bottom = top + stride;
+                glyph |= ((top[col / 8] & bit) ? 1 : 0) |
+                         ((bottom[col / 8] & bit) ? 2 : 0);
+            }
+            if (glyph == s_cells[row][col]) {
+                continue;
+            }
+
+            if (len - used < TERM_MAX_CELL) {
+                s_render_cut_short = true;
+                return used;
+            }
+            used += move_cursor(row, col, &out[used]);
+            memcpy(&out[used], s_half_blocks[glyph], s_half_block_lens[glyph]);
+            used += s_half_block_lens[glyph];
+            s_cells[row][col] = glyph;
+
+            s_cursor_row = row;
+            s_cursor_col = (col + 1 < frame->width) ? col + 1 : -1;
+        }
+    }
+
+    return used;
+}
+
+static uint64_t
+term_now (void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void
+term_write (const char *data, size_t len)
+{
+    ssize_t written;
+
+    while (len > 0) {
+        written = write(STDOUT_FILENO, data, len);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        len -= written;
+    }
+}
+
+static bool
+term_init (void)
+{
+    struct termios raw;
+
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO) ||
+        tcgetattr(STDIN_FILENO, &s_saved_termios) != 0) {
+        fprintf(stderr, "The terminal frontend needs a terminal\n");
+        return false;
+    }
+
+    /* Unbuffered keys without echo, Ctrl-C arrives as a key too */
+    raw = s_saved_termios;
+    raw.c_iflag &= ~(IXON | ICRNL | BRKINT | INPCK | ISTRIP);
+    raw.c_oflag &= ~OPOST;
+    raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) {
+        fprintf(stderr, "Unable to set up the terminal - %s\n",
+                strerror(errno));
+        return false;
+    }
+    s_raw = true;
+
+    term_write(TERM_ENTER, sizeof(TERM_ENTER) - 1);
+    chip8_term_reset();
+    s_out_len = 0;
+    s_next_present = term_now();
+
+    return true;
+}
+
+static void
+term_deinit (void)
+{
+    if (!s_raw) {
+        return;
+    }
+
+    term_write(TERM_LEAVE, sizeof(TERM_LEAVE) - 1);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &s_saved_termios);
+    s_raw = false;
+}
+
+static bool
+term_poll (void)
+{
+    char buf[64];
+    uint64_t now = term_now();
+    const char *mapped;
+    chip8_key_et key;
+    ssize_t len;
+    ssize_t i;
+
+    while ((len = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+        for (i = 0; i < len; i++) {
+            if (buf[i] == 0x03) {
+                return false;
+            }
+            mapped = (buf[i] != '\0') ?
+                     strchr(s_keymap, tolower((unsigned char)buf[i])) : NULL;
+            if (mapped == NULL) {
+                continue;
+            }
+            /* Auto-repeat only keeps the key held */
+            key = (chip8_key_et)(mapped - s_keymap);
+            if (s_held_until[key] == 0) {
+                key_pressed(key);
+            }
+            s_held_until[key] = now + CHIP8_TERM_KEY_HOLD_NS;
+        }
+    }
+
+    for (key = 0; key < CHIP8_KEY_MAX; key++) {
+        if (s_held_until[key] != 0 && now >= s_held_until[key]) {
+            key_released(key);
+            s_held_until[key] = 0;
+        }
+    }
+
+    return true;
+}
+
+static bool
+term_upload (const chip8_frontend_frame_t *frame)
+{
+    s_out_len = chip8_term_render(frame, s_out, sizeof(s_out));
+    /* The rest of a frame cut short goes out with the next pass */
+    return !s_render_cut_short;
+}
+
+static void
+term_present (void)
+{
+    struct timespec delay;
+    uint64_t now;
+
+    /* Anything printed, such as the bell, goes out first */
+    fflush(stdout);
+    if (s_out_len > 0) {
+        term_write(s_out, s_out_len);
+        s_out_len = 0;
+    }
+
+    s_next_present += TERM_FRAME_NS;
+    now = term_now();
+    if (s_next_present <= now) {
+        /* Fell behind, start again from now rather than catch up */
+        s_next_present = now;
+        return;
+    }
+
+    delay.tv_sec = (s_next_present - now) / 1000000000ull;
+    delay.tv_nsec = (s_next_present - now) % 1000000000ull;
+    while (nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+    }
+}
+
+const chip8_frontend_t chip8_term_frontend = {
+    .name       = "term",
+    .init       = term_init,
+    .deinit     = term_deinit,
+    .poll       = term_poll,
+    .upload     = term_upload,
+    .present    = term_present,
+};
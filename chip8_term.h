@@ -0,0 +1,60 @@
+/*
+ * chip8_term - CHIP8 Terminal Frontend
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_TERM_H__
+#define __CHIP8_TERM_H__
+
+#include <stddef.h>
+
+#include "chip8_frontend.h"
+
+/* The most a changed cell takes: a cursor move of at most 16 bytes, such
+ * as "\x1b[32;128H", and a half block of up to 3 */
+#define CHIP8_TERM_MAX_CELL     19
+/* Room for a whole frame of the largest screen, a cell to a character
+ * and two rows of pixels, with a cursor move before every cell and the
+ * screen clear first */
+#define CHIP8_TERM_BUFFER_SIZE \
+    (DISPLAY_WIDTH_PIXELS * DISPLAY_HEIGHT_PIXELS / 2 * CHIP8_TERM_MAX_CELL + \
+     16)
+
+/* Terminals only report key presses, a key counts as held until this
+ * long after the last press or auto-repeat of it */
+#define CHIP8_TERM_KEY_HOLD_NS  150000000ull
+
+/**
+ * @brief      Shows the screen in a terminal, two pixels to a character
+ *             cell with the Unicode half blocks. Keys use the same layout
+ *             as the SDL window, Ctrl-C quits.
+ */
+extern const chip8_frontend_t chip8_term_frontend;
+
+/**
+ * @brief      Forgets what the terminal shows, the next frame clears it
+ *             and is drawn in full
+ */
+void chip8_term_reset(void);
+
+/**
+ * @brief      Writes the escapes and characters that turn the last frame
+ *             rendered into this one.
+ *
+ * Only changed cells are written. Before each one the cursor is moved
+ * the cheapest way there: not at all, a carriage return and line feed,
+ * a relative or absolute move, or by rewriting the unchanged cells in
+ * between. Planes are merged, a pixel lit in any plane is shown lit.
+ *
+ * @param[in]  frame   The screen
+ * @param[out] out     The output
+ * @param[in]  len     Size of out, cells that do not fit are left for the
+ *                     next frame
+ *
+ * @returns    The number of bytes written to out
+ */
+size_t chip8_term_render(const chip8_frontend_frame_t *frame, char *out,
+                         size_t len);
+
+#endif /* __CHIP8_TERM_H__ */
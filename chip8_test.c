@@ -17,6 +17,20 @@
 
 #undef chip8_interpret_op
 
+#include "chip8_render.c"
+#include "chip8_hud.c"
+#include "chip8_metrics.c"
+#include "chip8_latency.c"
+#include "chip8_term.c"
+#include "chip8_shm.c"
+#include "chip8_codec.c"
+#include "chip8_pack.c"
+#include "chip8_writer.c"
+#include "chip8_record.c"
+#include "chip8_engine.c"
+#include "chip8_decode.c"
+#include "chip8_cfg.c"
+
 void
 chip8_interpret_op (uint16_t op)
 {
@@ -80,6 +94,30 @@ set_sound_timer (uint8_t ticks)
     assert_int_equal(50, ticks);
 }
 
+void
+key_pressed (chip8_key_et key)
+{
+}
+
+void
+key_released (chip8_key_et key)
+{
+}
+
+static chip8_utils_state_t s_test_utils_state;
+
+void
+chip8_utils_save_state (chip8_utils_state_t *state)
+{
+    *state = s_test_utils_state;
+}
+
+void
+chip8_utils_restore_state (const chip8_utils_state_t *state)
+{
+    s_test_utils_state = *state;
+}
+
 #define DEBUG_PRINTF(fmt, ...) (debug_printf("- "fmt"\n", __VA_ARGS__))
 
 #define BUILD_XNN_OPC(_opc, _x, _nn) (((_opc & 0xF) << 12) | ((_x & 0xF) << 8) | (_nn & 0xFF))
@@ -88,16 +126,21 @@ set_sound_timer (uint8_t ticks)
 #define LOAD_X(_x, _nn) (chip8_interpret_op(BUILD_XNN_OPC(6, _x, _nn)))
 #define LOAD_I(_nnn)    (chip8_interpret_op(BUILD_NNN_OPC(0xA, _nnn)))
 
+static void
+test_set_pixel (int x, int y)
+{
+    s_vram[0][y][x / 64] |= 1ULL << (63 - (x % 64));
+}
+
 static void
 opc_00E0 (void **state)
 {
     /* Clears the display */
-    static uint8_t s_zero[DISPLAY_WIDTH_PIXELS]
-                         [DISPLAY_HEIGHT_PIXELS] = {{0}};
+    static uint64_t s_zero[DISPLAY_HEIGHT_PIXELS][VRAM_ROW_WORDS] = {{0}};
 
-    memset(s_vram, 0xFE, sizeof(s_vram));
+    memset(s_vram[0], 0xFE, sizeof(s_vram[0]));
     chip8_interpret_op(0x00E0);
-    assert_memory_equal(s_vram, s_zero, sizeof(s_vram));
+    assert_memory_equal(s_vram[0], s_zero, sizeof(s_vram[0]));
 }
 
 static void
@@ -791,7 +834,7 @@ opc_DXYN_nop (void **state)
     chip8_interpret_op(0xD001);
     /* Empty sprite at address 0, so no pixels cleared */
     assert_int_equal(s_v_regs[0xF], 0);
-    assert_int_equal(s_vram[0][0], 0);
+    assert_false(chip8_get_pixel(0, 0));
 }
 
 static void
@@ -802,12 +845,14 @@ opc_DXYN_pixel_cleared (void **state)
 
     s_memory[0x300] = 0x8A;
     /* Write some bits to be cleared to VRAM */
-    s_vram[0][0] = 0xFF;
-    s_vram[0][4] = 0xFF;
+    test_set_pixel(0, 0);
+    test_set_pixel(4, 0);
 
     chip8_interpret_op(0xD111);
     assert_int_equal(s_v_regs[0xF], 1);
-    assert_int_equal(s_vram[0][0], 0x0);
+    assert_false(chip8_get_pixel(0, 0));
+    assert_false(chip8_get_pixel(4, 0));
+    assert_true(chip8_get_pixel(6, 0));
 }
 
 static void
@@ -823,13 +868,13 @@ opc_DXYN_multiple_bytes (void **state)
     chip8_interpret_op(0xD22F);
 
     for (i = 0; i < 0xF; i++) {
-        DEBUG_PRINTF("VRAM[%x][%x]: 0x%x", 0, i, s_vram[0][i]);
+        DEBUG_PRINTF("VRAM[%x][%x]: %d", 0, i, chip8_get_pixel(i, 0));
     }
 
     /* Check some pixels */
-    assert_int_equal(s_vram[0][0], 0xFF);
-    assert_int_equal(s_vram[0][1], 0x00);
-    assert_int_equal(s_vram[0][4], 0xFF);
+    assert_true(chip8_get_pixel(0, 0));
+    assert_false(chip8_get_pixel(1, 0));
+    assert_true(chip8_get_pixel(4, 0));
 
     /* Nothing in VRAM at the start of the test, so no pixels cleared */
     assert_int_equal(s_v_regs[0xF], 0x0);
@@ -849,14 +894,15 @@ opc_DXYN_wraparound (void **state)
     chip8_interpret_op(0xD34F);
 
     for (i = 0; i < 0xF; i++) {
-        DEBUG_PRINTF("VRAM[%x][%x]: 0x%x", 0, i, s_vram[0][(i + 30) % 32]);
+        DEBUG_PRINTF("VRAM[%x][%x]: %d", (i + 30) % 32, 0,
+                     chip8_get_pixel(0, (i + 30) % 32));
     }
 
     /* Spot check some pixels */
-    assert_int_equal(s_vram[0][0], 0xFF);
-    assert_int_equal(s_vram[0][1], 0x00);
-    assert_int_equal(s_vram[30][0], 0xFF);
-    assert_int_equal(s_vram[30][1], 0x00);
+    assert_true(chip8_get_pixel(0, 0));
+    assert_false(chip8_get_pixel(1, 0));
+    assert_true(chip8_get_pixel(0, 30));
+    assert_false(chip8_get_pixel(1, 30));
 
     /* Nothing in VRAM before, so no pixels will be cleared */
     assert_int_equal(s_v_regs[0xF], 0);
@@ -1015,14 +1061,19 @@ opc_FX29 (void **state)
 
         /* Hardcoded verification of the sprite address */
         assert_int_equal(i * 5, s_i_reg);
+
+        /* Only the low digit selects the sprite */
+        LOAD_X(0, (i | 0xA0));
+        chip8_interpret_op(0xF029);
+        assert_int_equal(i * 5, s_i_reg);
         DEBUG_PRINTF("I: 0x%x\n", s_i_reg);
 
         chip8_interpret_op(0xD005);
 
         DEBUG_PRINTF("Character 0x%x\n", i);
-        for (y = 0; y < DISPLAY_HEIGHT_PIXELS; y++) {
-            for (x = 0; x < DISPLAY_WIDTH_PIXELS; x++) {
-                DEBUG_PRINTF("0x%x ", s_vram[y][x]);
+        for (y = 0; y < LORES_HEIGHT_PIXELS; y++) {
+            for (x = 0; x < LORES_WIDTH_PIXELS; x++) {
+                DEBUG_PRINTF("%d ", chip8_get_pixel(x, y));
             }
             DEBUG_PRINTF("-\n", NULL);
         }
@@ -1089,6 +1140,263 @@ opc_FX65 (void **state)
     }
 }
 
+static void
+schip_hires_sprite16 (void **state)
+{
+    chip8_interpret_op(0x00FF);
+    assert_true(s_hires);
+
+    memset(&s_memory[0x300], 0xFF, 32);
+    LOAD_X(0, 120);
+    LOAD_X(1, 60);
+    LOAD_I(0x300);
+
+    /* 16x16 at (120, 60), wraps around both edges */
+    chip8_interpret_op(0xD010);
+    assert_int_equal(s_v_regs[0xF], 0);
+    assert_true(chip8_get_pixel(120, 60));
+    assert_true(chip8_get_pixel(127, 63));
+    assert_true(chip8_get_pixel(7, 11));
+    assert_false(chip8_get_pixel(8, 11));
+    assert_false(chip8_get_pixel(7, 12));
+    assert_false(chip8_get_pixel(119, 60));
+
+    chip8_interpret_op(0xD010);
+    assert_int_equal(s_v_regs[0xF], 1);
+    assert_false(chip8_get_pixel(120, 60));
+
+    /* Switching back clears the screen */
+    test_set_pixel(3, 3);
+    chip8_interpret_op(0x00FE);
+    assert_false(s_hires);
+    assert_false(chip8_get_pixel(3, 3));
+}
+
+static void
+schip_scroll_down (void **state)
+{
+    test_set_pixel(5, 0);
+    test_set_pixel(5, 31);
+
+    chip8_interpret_op(0x00C3);
+    assert_false(chip8_get_pixel(5, 0));
+    assert_true(chip8_get_pixel(5, 3));
+    /* Rows scrolled off the bottom are gone */
+    assert_false(chip8_get_pixel(5, 31));
+}
+
+static void
+schip_scroll_sideways (void **state)
+{
+    chip8_interpret_op(0x00FF);
+    test_set_pixel(62, 10);
+    test_set_pixel(125, 10);
+
+    /* Crosses from the first word of the row into the second */
+    chip8_interpret_op(0x00FB);
+    assert_true(chip8_get_pixel(66, 10));
+    assert_false(chip8_get_pixel(62, 10));
+    assert_false(chip8_get_pixel(125, 10));
+    assert_false(chip8_get_pixel(1, 10));
+
+    chip8_interpret_op(0x00FC);
+    assert_true(chip8_get_pixel(62, 10));
+    assert_false(chip8_get_pixel(66, 10));
+
+    /* Low resolution rows stop at 64 pixels */
+    chip8_interpret_op(0x00FE);
+    test_set_pixel(62, 10);
+    chip8_interpret_op(0x00FB);
+    assert_false(chip8_get_pixel(62, 10));
+    assert_int_equal(s_vram[0][10][1], 0);
+}
+
+static void
+schip_big_font (void **state)
+{
+    LOAD_X(0, 0xA);
+    chip8_interpret_op(0xF030);
+    assert_int_equal(s_i_reg, BIG_SPRITE_ADDR(0xA));
+    assert_memory_equal(&s_memory[s_i_reg],
+                        &s_big_character_sprite_data[0xA * 10], 10);
+}
+
+static void
+schip_rpl_flags (void **state)
+{
+    int i;
+
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        LOAD_X(i, (i + 1));
+    }
+    chip8_interpret_op(0xF775);
+
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        LOAD_X(i, 0);
+    }
+    chip8_interpret_op(0xF385);
+
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        assert_int_equal(s_v_regs[i], (i <= 3) ? i + 1 : 0);
+    }
+    assert_int_equal(s_rpl_flags[7], 8);
+    assert_int_equal(s_rpl_flags[8], 0);
+}
+
+static void
+schip_exit (void **state)
+{
+    U16_MEMORY_WRITE(0x200, htons(0x00FD));
+
+    /* Stays parked on the EXIT */
+    assert_int_equal(chip8_run(5), 5);
+    assert_int_equal(s_pc, 0x200);
+}
+
+static void
+xochip_long_i (void **state)
+{
+    chip8_set_xochip(true);
+    U16_MEMORY_WRITE(0x200, htons(0xF000));
+    U16_MEMORY_WRITE(0x202, htons(0xABCD));
+    chip8_step();
+    assert_int_equal(s_i_reg, 0xABCD);
+    assert_int_equal(s_pc, 0x204);
+
+    /* Skips jump over both words */
+    LOAD_X(0, 1);
+    U16_MEMORY_WRITE(0x1FE, htons(0x3001));
+    s_pc = 0x1FE;
+    chip8_step();
+    assert_int_equal(s_pc, 0x204);
+}
+
+static void
+xochip_register_range (void **state)
+{
+    int i;
+
+    chip8_set_xochip(true);
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        LOAD_X(i, (i + 0x10));
+    }
+    s_i_reg = 0x8000;
+
+    /* V2 to V5 */
+    chip8_interpret_op(0x5252);
+    assert_int_equal(s_memory[0x8000], 0x12);
+    assert_int_equal(s_memory[0x8003], 0x15);
+    assert_int_equal(s_memory[0x8004], 0x00);
+    assert_int_equal(s_i_reg, 0x8000);
+
+    /* Backwards, V9 down to V7 */
+    chip8_interpret_op(0x5973);
+    assert_int_equal(s_v_regs[9], 0x12);
+    assert_int_equal(s_v_regs[8], 0x13);
+    assert_int_equal(s_v_regs[7], 0x14);
+    assert_int_equal(s_v_regs[6], 0x16);
+}
+
+static void
+xochip_planes (void **state)
+{
+    chip8_set_xochip(true);
+    memset(&s_memory[0x300], 0x80, 2);
+    LOAD_X(0, 0);
+    LOAD_I(0x300);
+
+    /* Both planes take a byte each */
+    chip8_interpret_op(0xF301);
+    chip8_interpret_op(0xD001);
+    assert_int_equal(chip8_get_pixel(0, 0), 0x3);
+
+    /* Clearing the second plane leaves the first */
+    chip8_interpret_op(0xF201);
+    chip8_interpret_op(0x00E0);
+    assert_int_equal(chip8_get_pixel(0, 0), 0x1);
+
+    /* Drawing to the second plane only */
+    chip8_interpret_op(0xD001);
+    chip8_interpret_op(0x00FB);
+    assert_int_equal(chip8_get_pixel(0, 0), 0x1);
+    assert_int_equal(chip8_get_pixel(4, 0), 0x2);
+}
+
+static void
+xochip_audio (void **state)
+{
+    uint8_t pattern[AUDIO_PATTERN_SIZE];
+    uint8_t pitch;
+    int i;
+
+    chip8_set_xochip(true);
+    for (i = 0; i < AUDIO_PATTERN_SIZE; i++) {
+        s_memory[0x9000 + i] = i + 1;
+    }
+    s_i_reg = 0x9000;
+    LOAD_X(4, 112);
+
+    chip8_interpret_op(0xF002);
+    chip8_interpret_op(0xF43A);
+    chip8_get_audio(pattern, &pitch);
+    assert_memory_equal(pattern, &s_memory[0x9000], AUDIO_PATTERN_SIZE);
+    assert_int_equal(pitch, 112);
+    assert_int_equal(s_i_reg, 0x9000);
+}
+
+static void
+xochip_classic_restore (void **state)
+{
+    static chip8_state_t s_classic;
+
+    chip8_save_state(&s_classic);
+    assert_true(chip8_state_size(&s_classic) < sizeof(s_classic));
+
+    /* A classic PC running past 0xFFF must not find XO-CHIP leftovers */
+    chip8_set_xochip(true);
+    s_memory[0x1000] = 0x12;
+    s_memory[0xFFFF] = 0x34;
+    chip8_restore_state(&s_classic);
+    assert_false(chip8_get_xochip());
+    assert_int_equal(s_memory[0x1000], 0);
+    assert_int_equal(s_memory[0xFFFF], 0);
+
+    chip8_set_xochip(true);
+    chip8_save_state(&s_classic);
+    assert_int_equal(chip8_state_size(&s_classic),
+                     offsetof(chip8_state_t, memory) + MEMORY_SIZE);
+}
+
+static void
+classic_address_wrap (void **state)
+{
+    /* Classic programs never reach past 4 KB */
+    LOAD_X(0, 123);
+    LOAD_I(0xFFF);
+    chip8_interpret_op(0xF033);
+    assert_int_equal(s_memory[0xFFF], 1);
+    assert_int_equal(s_memory[0x000], 2);
+    assert_int_equal(s_memory[0x001], 3);
+    assert_int_equal(s_memory[0x1000], 0);
+
+    /* I as far as FX1E takes it, 16 bits, wraps the same way */
+    LOAD_X(1, 0x5A);
+    s_i_reg = 0xFFFF;
+    chip8_interpret_op(0xF155);
+    assert_int_equal(s_memory[0xFFF], 123);
+    assert_int_equal(s_memory[0x000], 0x5A);
+    LOAD_X(0, 0);
+    LOAD_X(1, 0);
+    chip8_interpret_op(0xF165);
+    assert_int_equal(s_v_regs[0], 123);
+    assert_int_equal(s_v_regs[1], 0x5A);
+
+    /* The stack moves out of the way in XO-CHIP mode */
+    chip8_set_xochip(true);
+    chip8_interpret_op(0x2400);
+    assert_int_equal(s_stack_ptr, XOCHIP_STACK_BASE_ADDR - 2);
+}
+
 static void
 chip8_step_instruction (void **state)
 {
@@ -1097,6 +1405,1124 @@ chip8_step_instruction (void **state)
     assert_int_equal(s_pc, 0x0EEE);
 }
 
+static void
+chip8_save_restore_state (void **state)
+{
+    static chip8_state_t s_saved;
+    int i;
+
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        LOAD_X(i, i * 3);
+    }
+    LOAD_I(0x345);
+    chip8_interpret_op(0x2456);
+    s_memory[0x300] = 0xAB;
+    test_set_pixel(7, 5);
+    s_test_utils_state.delay_timer = 12;
+
+    chip8_save_state(&s_saved);
+    assert_int_equal(s_saved.pc, 0x456);
+    assert_int_equal(s_saved.i_reg, 0x345);
+    assert_int_equal(s_saved.utils.delay_timer, 12);
+
+    /* Trash the machine, then bring it back */
+    chip8_init();
+    s_test_utils_state.delay_timer = 0;
+    chip8_restore_state(&s_saved);
+
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        assert_int_equal(s_v_regs[i], i * 3);
+    }
+    assert_int_equal(s_i_reg, 0x345);
+    assert_int_equal(s_pc, 0x456);
+    assert_int_equal(s_stack_ptr, STACK_BASE_ADDR - 2);
+    assert_int_equal(s_memory[0x300], 0xAB);
+    assert_true(chip8_get_pixel(7, 5));
+    assert_int_equal(s_test_utils_state.delay_timer, 12);
+
+    /* The return address pushed by the CALL came back too */
+    chip8_interpret_op(0x00EE);
+    assert_int_equal(s_pc, PROGRAM_LOAD_ADDR);
+}
+
+static void
+chip8_vram_packed (void **state)
+{
+    uint8_t packed[PACKED_VRAM_SIZE];
+    size_t size;
+
+    test_set_pixel(0, 0);
+    test_set_pixel(9, 0);
+    test_set_pixel(63, 31);
+
+    size = chip8_get_vram_packed(0, packed);
+
+    /* Low resolution frames are 64x32 */
+    assert_int_equal(size, LORES_WIDTH_PIXELS * LORES_HEIGHT_PIXELS / 8);
+    assert_int_equal(packed[0], 0x80);
+    assert_int_equal(packed[1], 0x40);
+    assert_int_equal(packed[2], 0x00);
+    assert_int_equal(packed[size - 1], 0x01);
+
+    chip8_interpret_op(0x00FF);
+    test_set_pixel(127, 63);
+    assert_int_equal(chip8_get_vram_packed(0, packed), PACKED_VRAM_SIZE);
+    assert_int_equal(packed[PACKED_VRAM_SIZE - 1], 0x01);
+}
+
+static void
+chip8_load_buffer (void **state)
+{
+    static uint8_t s_rom[MEMORY_SIZE];
+
+    s_rom[0] = 0x12;
+    s_rom[1] = 0x34;
+    assert_int_equal(chip8_load_program_buffer(s_rom, 2), 0);
+    assert_int_equal(s_memory[PROGRAM_LOAD_ADDR], 0x12);
+    assert_int_equal(s_memory[PROGRAM_LOAD_ADDR + 1], 0x34);
+
+    /* Largest image which still fits */
+    assert_int_equal(chip8_load_program_buffer(
+        s_rom, CLASSIC_MEMORY_SIZE - PROGRAM_LOAD_ADDR), 0);
+    /* One byte too many */
+    assert_int_equal(chip8_load_program_buffer(
+        s_rom, CLASSIC_MEMORY_SIZE - PROGRAM_LOAD_ADDR + 1), -1);
+
+    /* XO-CHIP programs can fill all of memory */
+    chip8_set_xochip(true);
+    assert_int_equal(chip8_load_program_buffer(
+        s_rom, MEMORY_SIZE - PROGRAM_LOAD_ADDR), 0);
+    assert_int_equal(chip8_load_program_buffer(
+        s_rom, MEMORY_SIZE - PROGRAM_LOAD_ADDR + 1), -1);
+}
+
+static void
+chip8_run_instructions (void **state)
+{
+    /* 0x200: ADD V0, 1 ; JP 0x200 */
+    U16_MEMORY_WRITE(0x200, htons(0x7001));
+    U16_MEMORY_WRITE(0x202, htons(0x1200));
+
+    assert_int_equal(chip8_run(10), 10);
+    assert_int_equal(s_v_regs[0], 5);
+    assert_int_equal(chip8_get_stop_reason(NULL), CHIP8_STOP_NONE);
+
+    /* LD V1, K stops the run until a key arrives */
+    U16_MEMORY_WRITE(0x200, htons(0xF10A));
+    assert_int_equal(chip8_run(10), 1);
+    assert_int_equal(chip8_get_stop_reason(NULL), CHIP8_STOP_KEY_WAIT);
+    chip8_notify_key_pressed(CHIP8_KEY_3);
+    assert_int_equal(s_v_regs[1], CHIP8_KEY_3);
+}
+
+static void
+chip8_run_fault (void **state)
+{
+    static chip8_state_t s_faulted;
+    uint16_t addr = 0;
+
+    /* 0x200: ADD V0, 1 ; SYS 0x123 */
+    U16_MEMORY_WRITE(0x200, htons(0x7001));
+    U16_MEMORY_WRITE(0x202, htons(0x0123));
+
+    assert_int_equal(chip8_run(10), 2);
+    assert_int_equal(chip8_get_stop_reason(&addr), CHIP8_STOP_FAULT);
+    assert_int_equal(addr, 0x202);
+    assert_int_equal(chip8_get_fault(NULL), CHIP8_FAULT_BAD_OPCODE);
+    assert_int_equal(s_pc, 0x202);
+
+    /* Stays stopped, also across a snapshot */
+    chip8_save_state(&s_faulted);
+    chip8_init();
+    chip8_restore_state(&s_faulted);
+    assert_int_equal(chip8_run(10), 0);
+    assert_int_equal(chip8_get_fault(&addr), CHIP8_FAULT_BAD_OPCODE);
+    assert_int_equal(addr, 0x202);
+}
+
+static void
+chip8_stack_bounds (void **state)
+{
+    uint32_t depth;
+
+    /* RET with nothing to return to */
+    U16_MEMORY_WRITE(0x200, htons(0x00EE));
+    chip8_run(1);
+    assert_int_equal(chip8_get_fault(NULL), CHIP8_FAULT_STACK_UNDERFLOW);
+    assert_int_equal(s_stack_ptr, STACK_BASE_ADDR);
+
+    /* 0x300: CALL 0x300, until the stack runs out */
+    chip8_init();
+    U16_MEMORY_WRITE(0x300, htons(0x2300));
+    s_pc = 0x300;
+    depth = chip8_run(1000) - 1;
+    assert_int_equal(chip8_get_fault(NULL), CHIP8_FAULT_STACK_OVERFLOW);
+    assert_int_equal(depth, (STACK_BASE_ADDR - STACK_END_ADDR) / 2 + 1);
+    assert_int_equal(s_pc, 0x300);
+    assert_int_equal(s_memory[STACK_END_ADDR - 1], 0);
+}
+
+static void
+chip8_run_breakpoint (void **state)
+{
+    uint16_t addr = 0;
+
+    U16_MEMORY_WRITE(0x200, htons(0x7001));
+    U16_MEMORY_WRITE(0x202, htons(0x7101));
+    U16_MEMORY_WRITE(0x204, htons(0x1200));
+
+    chip8_set_breakpoint(0x202, true);
+    assert_true(chip8_get_breakpoint(0x202));
+
+    assert_int_equal(chip8_run(100), 1);
+    assert_int_equal(chip8_get_stop_reason(&addr), CHIP8_STOP_BREAKPOINT);
+    assert_int_equal(addr, 0x202);
+    assert_int_equal(s_pc, 0x202);
+    assert_int_equal(s_v_regs[1], 0);
+
+    /* Resuming executes the instruction under the breakpoint, then stops
+     * at it again on the next pass through the loop */
+    assert_int_equal(chip8_run(100), 3);
+    assert_int_equal(chip8_get_stop_reason(NULL), CHIP8_STOP_BREAKPOINT);
+    assert_int_equal(s_v_regs[0], 2);
+    assert_int_equal(s_v_regs[1], 1);
+
+    chip8_set_breakpoint(0x202, false);
+    assert_false(chip8_get_breakpoint(0x202));
+    assert_int_equal(chip8_run(100), 100);
+}
+
+static void
+chip8_run_watchpoint (void **state)
+{
+    uint16_t addr = 0;
+
+    /* LD I, 0x300 ; LD B, V0 ; LD [I], V3 */
+    U16_MEMORY_WRITE(0x200, htons(0xA300));
+    U16_MEMORY_WRITE(0x202, htons(0xF033));
+    U16_MEMORY_WRITE(0x204, htons(0xF355));
+    U16_MEMORY_WRITE(0x206, htons(0x1206));
+
+    chip8_set_watchpoint(0x303, 1, true);
+    assert_true(chip8_get_watchpoint(0x303));
+    assert_false(chip8_get_watchpoint(0x302));
+
+    /* LD B writes 0x300-0x302 and goes unnoticed, LD [I], V3 hits */
+    assert_int_equal(chip8_run(100), 3);
+    assert_int_equal(chip8_get_stop_reason(&addr), CHIP8_STOP_WATCHPOINT);
+    assert_int_equal(addr, 0x303);
+    assert_int_equal(s_pc, 0x206);
+
+    chip8_set_watchpoint(0x303, 1, false);
+    assert_int_equal(chip8_run(100), 100);
+
+    /* LD I, 0xFFE ; LD [I], V3 wraps around to 0x000-0x001 */
+    U16_MEMORY_WRITE(0x208, htons(0xAFFE));
+    U16_MEMORY_WRITE(0x20A, htons(0xF355));
+    U16_MEMORY_WRITE(0x20C, htons(0x120C));
+    chip8_set_watchpoint(0x001, 1, true);
+    s_pc = 0x208;
+    assert_int_equal(chip8_run(100), 2);
+    assert_int_equal(chip8_get_stop_reason(&addr), CHIP8_STOP_WATCHPOINT);
+    assert_int_equal(addr, 0x001);
+    chip8_set_watchpoint(0x001, 1, false);
+}
+
+static void
+chip8_run_trace (void **state)
+{
+    static const char s_expected[] =
+        "before\nPC: 0x200 - 0xa300\nPC: 0x202 - 0x1202\n";
+    char path[] = "/tmp/chip8-test-trace-XXXXXX";
+    char text[sizeof(s_expected) + 1];
+    int saved;
+    int fd;
+
+    fd = mkstemp(path);
+    assert_true(fd >= 0);
+    fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    /* LD I, 0x300 ; JP 0x202 */
+    U16_MEMORY_WRITE(0x200, htons(0xA300));
+    U16_MEMORY_WRITE(0x202, htons(0x1202));
+
+    /* Lines go on after what was printed before tracing */
+    printf("before\n");
+    chip8_set_trace(true);
+    assert_int_equal(chip8_run(2), 2);
+    chip8_set_trace(false);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    fd = open(path, O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(read(fd, text, sizeof(text)), sizeof(s_expected) - 1);
+    assert_memory_equal(text, s_expected, sizeof(s_expected) - 1);
+    close(fd);
+    unlink(path);
+}
+
+static void
+render_expand_pitch (void **state)
+{
+    /* Two rows of 16 pixels into rows of 20 pixels */
+    static const uint8_t packed[] = { 0x80, 0x01, 0x5A, 0xFF };
+    uint32_t pixels[2][20];
+    int x;
+
+    memset(pixels, 0xAB, sizeof(pixels));
+    chip8_render_expand(&pixels[0][0], sizeof(pixels[0]), packed, 16, 2,
+                        0xFF00FF00, 0xFF000000);
+
+    for (x = 0; x < 16; x++) {
+        assert_int_equal(pixels[0][x],
+                         (x == 0 || x == 15) ? 0xFF00FF00 : 0xFF000000);
+        assert_int_equal(pixels[1][x],
+                         ((0x5AFF << x) & 0x8000) ? 0xFF00FF00 : 0xFF000000);
+    }
+
+    /* Padding past the width is left alone */
+    assert_int_equal(pixels[0][16], 0xABABABAB);
+    assert_int_equal(pixels[1][19], 0xABABABAB);
+}
+
+static void
+render_text_glyphs (void **state)
+{
+    uint32_t pixels[12][24];
+    int x;
+
+    /* Cells of 8x12 at scale 2, clipped 8 rows down */
+    memset(pixels, 0, sizeof(pixels));
+    chip8_render_text(&pixels[0][0], sizeof(pixels[0]), 24, 8, 0, 0, 2,
+                      "1\x7f-", 0xFFFFFFFF);
+
+    for (x = 0; x < 8; x++) {
+        /* The top of the 1 is its middle pixel, doubled each way */
+        assert_int_equal(pixels[0][x], (x == 2 || x == 3) ? 0xFFFFFFFF : 0);
+        assert_int_equal(pixels[1][x], (x == 2 || x == 3) ? 0xFFFFFFFF : 0);
+        /* Its base is past the clip */
+        assert_int_equal(pixels[8][x], 0);
+        /* DEL has no glyph */
+        assert_int_equal(pixels[4][x + 8], 0);
+        /* The dash is the third row of the third cell */
+        assert_int_equal(pixels[4][x + 16], (x < 6) ? 0xFFFFFFFF : 0);
+        assert_int_equal(pixels[3][x + 16], 0);
+    }
+
+    /* Lowercase draws as uppercase, a newline moves down a cell */
+    memset(pixels, 0, sizeof(pixels));
+    chip8_render_text(&pixels[0][0], sizeof(pixels[0]), 24, 12, 0, 0, 1,
+                      "a\n-", 0xFFFFFFFF);
+    assert_int_equal(pixels[0][0], 0);
+    assert_int_equal(pixels[0][1], 0xFFFFFFFF);
+    assert_int_equal(pixels[CHIP8_RENDER_CELL_HEIGHT + 2][0], 0xFFFFFFFF);
+}
+
+static void
+hud_percentiles (void **state)
+{
+    uint64_t phase_ns[CHIP8_HUD_PHASE_MAX];
+    chip8_hud_stats_t stats;
+    uint64_t now = 1000;
+    char text[256];
+    int frame;
+
+    chip8_hud_reset(now);
+
+    /* 100 frames of 1..100 us over half a second, then a slow frame */
+    for (frame = 1; frame <= 100; frame++) {
+        phase_ns[CHIP8_HUD_EMULATE] = frame * 1000;
+        phase_ns[CHIP8_HUD_UPLOAD] = 0;
+        phase_ns[CHIP8_HUD_PRESENT] = 5000;
+        now += CHIP8_HUD_INTERVAL_NS / 100;
+        assert_int_equal(chip8_hud_frame(now, phase_ns, 10), frame == 100);
+    }
+
+    chip8_hud_get_stats(&stats);
+    assert_int_equal(stats.p50_ns[CHIP8_HUD_EMULATE], 50000);
+    assert_int_equal(stats.p99_ns[CHIP8_HUD_EMULATE], 99000);
+    assert_int_equal(stats.p99_ns[CHIP8_HUD_PRESENT], 5000);
+    assert_true(stats.fps > 199.9 && stats.fps < 200.1);
+    assert_true(stats.ips > 1999 && stats.ips < 2001);
+    assert_true(stats.ipf == 10.0);
+
+    chip8_hud_format(&stats, "\n", text, sizeof(text));
+    assert_non_null(strstr(text, "200.0 fps 10.0 ipf\nemulate p50 0.05"));
+}
+
+static uint32_t s_native_count;
+static uint32_t s_native_invalidations;
+
+static uint32_t
+test_native_run (uint32_t count)
+{
+    s_native_count += count;
+    return chip8_rt_interpret(count);
+}
+
+static void
+test_native_invalidate (void)
+{
+    s_native_invalidations++;
+}
+
+static void
+chip8_run_native (void **state)
+{
+    static chip8_state_t s_snapshot;
+
+    s_native_count = 0;
+    s_native_invalidations = 0;
+
+    /* LD I, 0x300 ; JP 0x202 */
+    U16_MEMORY_WRITE(0x200, htons(0xA300));
+    U16_MEMORY_WRITE(0x202, htons(0x1202));
+
+    chip8_rt_set_native(test_native_run, test_native_invalidate);
+    assert_int_equal(chip8_run(10), 10);
+    assert_int_equal(s_native_count, 10);
+    assert_int_equal(s_i_reg, 0x300);
+
+    /* Debugging always interprets */
+    chip8_set_breakpoint(0x202, true);
+    assert_int_equal(chip8_run(10), 0);
+    assert_int_equal(s_native_count, 10);
+    chip8_set_breakpoint(0x202, false);
+    assert_int_equal(chip8_run(10), 10);
+    assert_int_equal(s_native_count, 20);
+
+    chip8_save_state(&s_snapshot);
+    chip8_restore_state(&s_snapshot);
+    assert_int_equal(s_native_invalidations, 1);
+
+    chip8_rt_set_native(NULL, NULL);
+    assert_int_equal(chip8_run(10), 10);
+    assert_int_equal(s_native_count, 20);
+}
+
+static bool
+test_engine_init (void)
+{
+    chip8_rt_set_native(test_native_run, test_native_invalidate);
+    return true;
+}
+
+/* Gets as far as detaching whatever engine was attached */
+static bool
+test_engine_init_fails (void)
+{
+    chip8_rt_set_native(NULL, NULL);
+    return false;
+}
+
+static void
+chip8_engines (void **state)
+{
+    static const chip8_engine_t s_native = {
+        .name = "native", .init = test_engine_init, .run = chip8_run,
+    };
+    static const chip8_engine_t s_broken = {
+        .name = "broken", .init = test_engine_init_fails, .run = chip8_run,
+    };
+    const chip8_engine_t *interp = chip8_engine_get(0);
+
+    assert_string_equal(interp->name, "interp");
+    assert_true(chip8_engine_find("interp") == interp);
+    assert_null(chip8_engine_find("native"));
+    assert_null(chip8_engine_get(chip8_engine_count()));
+
+    s_native_count = 0;
+    /* JP 0x200 ; JP 0x202 */
+    U16_MEMORY_WRITE(0x200, htons(0x1200));
+    U16_MEMORY_WRITE(0x202, htons(0x1202));
+
+    assert_true(chip8_engine_use(&s_native));
+    assert_true(chip8_engine_current() == &s_native);
+    assert_int_equal(chip8_engine_run(10), 10);
+    assert_int_equal(s_native_count, 10);
+
+    /* The failed engine detached the native code, which comes back */
+    assert_false(chip8_engine_use(&s_broken));
+    assert_true(chip8_engine_current() == &s_native);
+    assert_int_equal(chip8_engine_run(10), 10);
+    assert_int_equal(s_native_count, 20);
+
+    /* Only the interpreter to pick, so nothing runs */
+    s_pc = 0x202;
+    assert_true(chip8_engine_calibrate(1000) == interp);
+    assert_true(chip8_engine_current() == interp);
+    assert_int_equal(s_pc, 0x202);
+    assert_int_equal(chip8_engine_run(10), 10);
+    assert_int_equal(s_native_count, 20);
+}
+
+static void
+chip8_usage_counters (void **state)
+{
+    chip8_counters_t before;
+    chip8_counters_t after;
+
+    chip8_get_counters(&before);
+
+    /* 0x200: DRW V0, V0, 1 ; DRW V0, V0, 1 ; JP 0x206 */
+    U16_MEMORY_WRITE(0x200, htons(0xD001));
+    U16_MEMORY_WRITE(0x202, htons(0xD001));
+    U16_MEMORY_WRITE(0x204, htons(0x1206));
+    U16_MEMORY_WRITE(0x206, htons(0x1206));
+    s_i_reg = 0x300;
+    s_memory[0x300] = 0x80;
+
+    assert_int_equal(chip8_run(3), 3);
+    chip8_step();
+
+    /* The second draw erases the first, a collision. chip8_init() and
+     * snapshots leave the counters alone. */
+    chip8_init();
+    chip8_get_counters(&after);
+    assert_int_equal(after.instructions - before.instructions, 4);
+    assert_int_equal(after.draws - before.draws, 2);
+    assert_int_equal(after.collisions - before.collisions, 1);
+
+    chip8_set_counters(&before);
+    chip8_get_counters(&after);
+    assert_memory_equal(&after, &before, sizeof(after));
+}
+
+static void
+metrics_text_format (void **state)
+{
+    chip8_metrics_t metrics = {
+        .instructions = 1234567890123ull,
+        .key_wait_ns = 2500000000ull,
+        .waiting_for_key = true,
+    };
+    char text[METRICS_TEXT_SIZE];
+    char small[64];
+    size_t len;
+
+    len = chip8_metrics_format(&metrics, text, sizeof(text));
+    assert_int_equal(len, strlen(text));
+    assert_non_null(strstr(text, "# TYPE chip8_instructions_total counter\n"
+                                 "chip8_instructions_total 1234567890123\n"));
+    assert_non_null(strstr(text, "chip8_key_wait_seconds_total 2.500000000\n"));
+    assert_non_null(strstr(text, "# TYPE chip8_waiting_for_key gauge\n"
+                                 "chip8_waiting_for_key 1\n"));
+
+    /* Truncated, but still terminated */
+    len = chip8_metrics_format(&metrics, small, sizeof(small));
+    assert_int_equal(len, sizeof(small) - 1);
+    assert_int_equal(strlen(small), sizeof(small) - 1);
+}
+
+static void
+latency_rom_inverts (void **state)
+{
+    /* CLS, LD I and LD K, then waits */
+    assert_int_equal(chip8_load_program_buffer(chip8_latency_rom,
+                                               chip8_latency_rom_size), 0);
+    assert_int_equal(chip8_run(100), 3);
+    assert_int_equal(chip8_get_stop_reason(NULL), CHIP8_STOP_KEY_WAIT);
+    assert_int_equal(s_vram[0][0][0], 0);
+
+    /* The press lights the top-left block three instructions later */
+    chip8_notify_key_pressed(CHIP8_KEY_0);
+    assert_int_equal(chip8_run(3), 3);
+    assert_int_equal(s_vram[0][0][0], 0xFFull << 56);
+    assert_int_equal(s_vram[0][7][0], 0xFFull << 56);
+    assert_int_equal(s_vram[0][8][0], 0);
+}
+
+static void
+latency_samples (void **state)
+{
+    char report[256];
+    uint64_t now = 0;
+
+    chip8_latency_start(2, now);
+    assert_int_equal(chip8_latency_poll(now, true), CHIP8_LATENCY_NONE);
+
+    /* Presses wait for the gap, and for the program */
+    now += CHIP8_LATENCY_MAX_GAP_NS;
+    assert_int_equal(chip8_latency_poll(now, false), CHIP8_LATENCY_NONE);
+    assert_int_equal(chip8_latency_presented(now, true), CHIP8_LATENCY_NONE);
+    assert_int_equal(chip8_latency_poll(now, true), CHIP8_LATENCY_PRESS);
+    assert_int_equal(chip8_latency_poll(now, true), CHIP8_LATENCY_NONE);
+    assert_int_equal(chip8_latency_presented(now + 1000000, false),
+                     CHIP8_LATENCY_NONE);
+    assert_int_equal(chip8_latency_presented(now + 5000000, true),
+                     CHIP8_LATENCY_RELEASE);
+
+    /* The second never shows up */
+    now += 2 * CHIP8_LATENCY_MAX_GAP_NS;
+    assert_int_equal(chip8_latency_poll(now, true), CHIP8_LATENCY_PRESS);
+    assert_int_equal(chip8_latency_presented(now + CHIP8_LATENCY_TIMEOUT_NS,
+                                             false), CHIP8_LATENCY_DONE);
+    assert_int_equal(chip8_latency_poll(now + 10 * CHIP8_LATENCY_TIMEOUT_NS,
+                                        true), CHIP8_LATENCY_NONE);
+
+    chip8_latency_report("test", report, sizeof(report));
+    assert_string_equal(report, "test: n=1 missed=1 min 5.00 p50 5.00 "
+                                "p90 5.00 p99 5.00 max 5.00 mean 5.00 ms");
+}
+
+static void
+term_render_diff (void **state)
+{
+    static chip8_frontend_frame_t s_frame = {
+        .width = 64, .height = 32, .planes = 1,
+    };
+    char out[CHIP8_TERM_BUFFER_SIZE];
+    size_t len;
+
+    /* The first frame clears the screen. The second cell follows the
+     * first without a move. */
+    s_frame.packed[0][0] = 0x80;
+    s_frame.packed[0][8] = 0x40;
+    chip8_term_reset();
+    len = chip8_term_render(&s_frame, out, sizeof(out));
+    assert_int_equal(len, 7 + 3 + 3);
+    assert_memory_equal(out, "\x1b[H\x1b[2J\xE2\x96\x80\xE2\x96\x84", len);
+
+    /* Nothing changed, nothing written */
+    assert_int_equal(chip8_term_render(&s_frame, out, sizeof(out)), 0);
+
+    /* Pixel (10, 4) is the top of cell (10, 2) */
+    s_frame.packed[0][4 * 8 + 1] = 0x20;
+    len = chip8_term_render(&s_frame, out, sizeof(out));
+    assert_int_equal(len, 7 + 3);
+    assert_memory_equal(out, "\x1b[3;11H\xE2\x96\x80", len);
+
+    /* Close by on the same row, the unchanged cells are cheaper */
+    s_frame.packed[0][4 * 8 + 1] = 0x24;
+    len = chip8_term_render(&s_frame, out, sizeof(out));
+    assert_int_equal(len, 2 + 3);
+    assert_memory_equal(out, "  \xE2\x96\x80", len);
+
+    /* A full buffer leaves the rest for the next frame, here a move home
+     * and four cells fit */
+    memset(s_frame.packed[0], 0xFF, 64 / 8 * 32);
+    assert_int_equal(chip8_term_render(&s_frame, out, 32), 3 + 4 * 3);
+    assert_true(s_render_cut_short);
+    len = chip8_term_render(&s_frame, out, sizeof(out));
+    assert_true(len > 0);
+    assert_false(s_render_cut_short);
+    assert_int_equal(chip8_term_render(&s_frame, out, sizeof(out)), 0);
+
+    /* The largest screen always fits in whole, here one cell in three
+     * changes, which needs a move before each */
+    s_frame.width = 128;
+    s_frame.height = 64;
+    memset(s_frame.packed[0], 0x92, sizeof(s_frame.packed[0]));
+    len = chip8_term_render(&s_frame, out, sizeof(out));
+    assert_false(s_render_cut_short);
+    assert_int_equal(chip8_term_render(&s_frame, out, sizeof(out)), 0);
+}
+
+static void
+shm_frame_ring (void **state)
+{
+    static chip8_frontend_frame_t s_frame = {
+        .width = 64, .height = 32, .planes = 1,
+    };
+    static chip8_shm_slot_t s_slot;
+    const chip8_shm_slot_t *shared;
+    const chip8_shm_t *shm;
+    char name[64];
+    uint64_t i;
+
+    snprintf(name, sizeof(name), "/chip8-test-%d", (int)getpid());
+    assert_true(chip8_shm_create(name));
+    shm = chip8_shm_attach(name);
+    assert_non_null(shm);
+    assert_int_equal(chip8_shm_read(shm, 0, &s_slot), CHIP8_SHM_PENDING);
+
+    for (i = 0; i < CHIP8_SHM_SLOTS + 2; i++) {
+        s_frame.packed[0][0] = i;
+        chip8_shm_publish(&s_frame, 100 + i);
+    }
+    assert_int_equal(atomic_load(&shm->published), CHIP8_SHM_SLOTS + 2);
+
+    /* The first two were overwritten by the last two */
+    assert_int_equal(chip8_shm_read(shm, 1, &s_slot), CHIP8_SHM_LAPPED);
+    assert_int_equal(chip8_shm_read(shm, CHIP8_SHM_SLOTS + 1, &s_slot),
+                     CHIP8_SHM_OK);
+    assert_int_equal(s_slot.frame, 100 + CHIP8_SHM_SLOTS + 1);
+    assert_int_equal(s_slot.width, 64);
+    assert_int_equal(s_slot.packed[0][0], CHIP8_SHM_SLOTS + 1);
+    assert_int_equal(chip8_shm_read(shm, CHIP8_SHM_SLOTS + 2, &s_slot),
+                     CHIP8_SHM_PENDING);
+
+    /* In place, a frame published meanwhile invalidates the read */
+    assert_int_equal(chip8_shm_read_begin(shm, 2, &shared), CHIP8_SHM_OK);
+    assert_int_equal(shared->packed[0][0], 2);
+    assert_true(chip8_shm_read_end(shm, 2));
+    chip8_shm_publish(&s_frame, 200);
+    assert_false(chip8_shm_read_end(shm, 2));
+
+    chip8_shm_detach(shm);
+    chip8_shm_destroy();
+    assert_null(chip8_shm_attach(name));
+}
+
+static void
+codec_frame_deltas (void **state)
+{
+    static chip8_frontend_frame_t s_prev = {
+        .width = 64, .height = 32, .planes = 1,
+    };
+    static chip8_frontend_frame_t s_cur;
+    static chip8_frontend_frame_t s_decoded;
+    uint8_t out[CHIP8_CODEC_MAX_FRAME];
+    chip8_codec_type_et type;
+    uint64_t number;
+    uint64_t value;
+    size_t len;
+    int i;
+
+    len = chip8_codec_put_varint(out, 300);
+    assert_int_equal(len, 2);
+    assert_int_equal(chip8_codec_get_varint(out, len, &value), 2);
+    assert_int_equal(value, 300);
+    assert_int_equal(chip8_codec_get_varint(out, 1, &value), 0);
+
+    /* A blank keyframe is just its header and empty planes */
+    len = chip8_codec_encode_frame(NULL, &s_prev, 7, out);
+    assert_int_equal(len, 6);
+    assert_int_equal(chip8_codec_decode_frame(out, len, &s_decoded, &number,
+                                              &type), len);
+    assert_int_equal(type, CHIP8_CODEC_KEYFRAME);
+    assert_int_equal(number, 7);
+    assert_int_equal(s_decoded.width, 64);
+
+    /* Two changes a byte apart share one run, far apart they do not */
+    s_cur = s_prev;
+    s_cur.packed[0][10] = 0x81;
+    s_cur.packed[0][12] = 0x18;
+    s_cur.packed[0][200] = 0xFF;
+    len = chip8_codec_encode_frame(&s_prev, &s_cur, 8, out);
+    assert_int_equal(len, 6 + (2 + 3) + (3 + 1));
+    assert_int_equal(chip8_codec_decode_frame(out, len, &s_decoded, &number,
+                                              &type), len);
+    assert_int_equal(type, CHIP8_CODEC_DELTA);
+    assert_memory_equal(s_decoded.packed[0], s_cur.packed[0],
+                        PACKED_VRAM_SIZE);
+
+    /* The worst case fits, and truncation is caught */
+    for (i = 0; i < PACKED_VRAM_SIZE; i++) {
+        s_cur.packed[0][i] = (i % 3) ? 0x55 : 0;
+        s_cur.packed[1][i] = 0xAA;
+    }
+    s_cur.width = 128;
+    s_cur.height = 64;
+    s_cur.planes = 2;
+    len = chip8_codec_encode_frame(&s_prev, &s_cur, 9, out);
+    assert_true(len <= CHIP8_CODEC_MAX_FRAME);
+    assert_int_equal(out[0], CHIP8_CODEC_KEYFRAME);
+    assert_int_equal(chip8_codec_decode_frame(out, len - 1, &s_decoded,
+                                              &number, &type), 0);
+    assert_int_equal(chip8_codec_decode_frame(out, len, &s_decoded, &number,
+                                              &type), len);
+    assert_memory_equal(s_decoded.packed, s_cur.packed,
+                        sizeof(s_cur.packed));
+
+    /* A delta of another resolution is refused */
+    len = chip8_codec_encode_frame(&s_cur, &s_cur, 10, out);
+    s_decoded.width = 64;
+    assert_int_equal(chip8_codec_decode_frame(out, len, &s_decoded, &number,
+                                              &type), 0);
+}
+
+static void
+pack_lookup_and_load (void **state)
+{
+    static const uint8_t s_images[] = { 0x00, 0xE0, 0x12, 0x02, 0x12, 0x04 };
+    struct test_pack_s {
+        chip8_pack_header_t header;
+        chip8_pack_entry_t  entries[2];
+        uint8_t             images[sizeof(s_images)];
+    } file = {
+        .header = {
+            .magic = CHIP8_PACK_MAGIC, .version = CHIP8_PACK_VERSION,
+            .num_entries = 2, .entry_size = sizeof(chip8_pack_entry_t),
+        },
+        .entries = {
+            { .name = "blank", .hash = 0x5, .size = 2,
+              .profile = CHIP8_PACK_PROFILE_XOCHIP },
+            { .name = "loop", .hash = 0xC8, .size = 4,
+              .instructions_per_frame = 15 },
+        },
+    };
+    const chip8_pack_entry_t *entry;
+    chip8_pack_t pack;
+    char path[] = "/tmp/chip8-test-pack-XXXXXX";
+    int fd;
+
+    file.entries[0].offset = offsetof(struct test_pack_s, images);
+    file.entries[1].offset = file.entries[0].offset + 2;
+    memcpy(file.images, s_images, sizeof(s_images));
+
+    fd = mkstemp(path);
+    assert_true(fd >= 0);
+    assert_int_equal(write(fd, &file, sizeof(file)), sizeof(file));
+
+    assert_true(chip8_pack_open(path, &pack));
+    assert_true(chip8_pack_find_hash(&pack, 0xC8) == &pack.entries[1]);
+    assert_null(chip8_pack_find_hash(&pack, 0x6));
+    assert_true(chip8_pack_find_name(&pack, "blank") ==
+                &pack.entries[0]);
+    assert_true(chip8_pack_find(&pack, "00000000000000c8") ==
+                &pack.entries[1]);
+    assert_null(chip8_pack_find(&pack, "c8"));
+
+    chip8_init();
+    entry = chip8_pack_find(&pack, "loop");
+    assert_int_equal(chip8_pack_load(&pack, entry), 0);
+    assert_memory_equal(&s_memory[PROGRAM_LOAD_ADDR], &s_images[2], 4);
+    chip8_pack_close(&pack);
+
+    /* An image past the end of the file is refused when opening */
+    file.entries[1].size = sizeof(file);
+    assert_int_equal(pwrite(fd, &file, sizeof(file), 0), sizeof(file));
+    assert_false(chip8_pack_open(path, &pack));
+
+    close(fd);
+    unlink(path);
+}
+
+static void
+writer_queue_policies (void **state)
+{
+    static uint8_t s_data[10000];
+    static uint8_t s_read[sizeof(s_data) + 1];
+    char path[] = "/tmp/chip8-test-writer-XXXXXX";
+    chip8_writer_stats_t stats;
+    int pipe_fds[2];
+    ssize_t len;
+    size_t i;
+    FILE *fp;
+    int stream;
+    int fd;
+
+    fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+    for (i = 0; i < sizeof(s_data); i++) {
+        s_data[i] = i * 7;
+    }
+
+    /* Blocking writes larger than the queue go in pieces, in order */
+    stream = chip8_writer_open(path, 100, CHIP8_WRITER_BLOCK);
+    assert_true(stream >= 0);
+    assert_non_null(chip8_writer_backend());
+    assert_int_equal(chip8_writer_space(stream), WRITER_MIN_QUEUE);
+    for (i = 0; i < 3; i++) {
+        assert_true(chip8_writer_write(stream, s_data, sizeof(s_data)));
+    }
+    assert_true(chip8_writer_close(stream, &stats));
+    assert_int_equal(stats.written, 3 * sizeof(s_data));
+    assert_int_equal(stats.dropped_writes, 0);
+    assert_false(stats.failed);
+    assert_null(chip8_writer_backend());
+
+    fp = fopen(path, "rb");
+    assert_non_null(fp);
+    for (i = 0; i < 3; i++) {
+        assert_int_equal(fread(s_read, 1, sizeof(s_data), fp),
+                         sizeof(s_data));
+        assert_memory_equal(s_read, s_data, sizeof(s_data));
+    }
+    assert_int_equal(fread(s_read, 1, 1, fp), 0);
+    fclose(fp);
+
+    /* A dropping write that could never fit leaves nothing behind */
+    stream = chip8_writer_open(path, 100, CHIP8_WRITER_DROP);
+    assert_true(stream >= 0);
+    assert_false(chip8_writer_write(stream, s_data, sizeof(s_data)));
+    assert_true(chip8_writer_write(stream, s_data, 10));
+    assert_true(chip8_writer_close(stream, &stats));
+    assert_int_equal(stats.written, 10);
+    assert_int_equal(stats.dropped_writes, 1);
+    assert_int_equal(stats.dropped_bytes, sizeof(s_data));
+
+    fp = fopen(path, "rb");
+    assert_non_null(fp);
+    assert_int_equal(fread(s_read, 1, sizeof(s_read), fp), 10);
+    assert_memory_equal(s_read, s_data, 10);
+    fclose(fp);
+    unlink(path);
+
+    /* Pipes cannot be written at an offset */
+    assert_int_equal(pipe(pipe_fds), 0);
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", pipe_fds[1]);
+    stream = chip8_writer_open(path, 100, CHIP8_WRITER_BLOCK);
+    assert_true(stream >= 0);
+    assert_true(chip8_writer_write(stream, s_data, sizeof(s_data)));
+    assert_true(chip8_writer_close(stream, &stats));
+    assert_false(stats.failed);
+    close(pipe_fds[1]);
+    for (i = 0; i < sizeof(s_data); i += len) {
+        len = read(pipe_fds[0], &s_read[i], sizeof(s_data) - i);
+        assert_true(len > 0);
+    }
+    assert_memory_equal(s_read, s_data, sizeof(s_data));
+    close(pipe_fds[0]);
+}
+
+static void
+record_round_trip (void **state)
+{
+    static chip8_frontend_frame_t s_frame = {
+        .width = 64, .height = 32, .planes = 1,
+    };
+    static chip8_frontend_frame_t s_read;
+    char path[] = "/tmp/chip8-test-record-XXXXXX";
+    uint64_t number;
+    FILE *fp;
+    int fd;
+
+    fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+
+    /* A keyframe, a delta, and a keyframe for the new resolution */
+    assert_true(chip8_record_start(path));
+    chip8_record_publish(&s_frame, 0);
+    s_frame.packed[0][5] = 0x3C;
+    chip8_record_publish(&s_frame, 4);
+    s_frame.width = 128;
+    s_frame.height = 64;
+    s_frame.packed[0][PACKED_VRAM_SIZE - 1] = 0x01;
+    chip8_record_publish(&s_frame, 9);
+    chip8_record_stop();
+
+    fp = fopen(path, "rb");
+    assert_non_null(fp);
+    assert_true(chip8_record_read_header(fp));
+    assert_int_equal(chip8_record_read(fp, &s_read, &number), 1);
+    assert_int_equal(number, 0);
+    assert_int_equal(s_read.packed[0][5], 0);
+    assert_int_equal(chip8_record_read(fp, &s_read, &number), 1);
+    assert_int_equal(number, 4);
+    assert_int_equal(s_read.packed[0][5], 0x3C);
+    assert_int_equal(chip8_record_read(fp, &s_read, &number), 1);
+    assert_int_equal(number, 9);
+    assert_int_equal(s_read.width, 128);
+    assert_memory_equal(s_read.packed[0], s_frame.packed[0],
+                        PACKED_VRAM_SIZE);
+    assert_int_equal(chip8_record_read(fp, &s_read, &number), 0);
+    fclose(fp);
+
+    /* Nothing is written once stopped */
+    chip8_record_publish(&s_frame, 10);
+    unlink(path);
+}
+
+/* SYS routine: V0 = V0 * V1, fails on overflow after moving the PC */
+static bool
+test_host_mul (chip8_rt_t *rt, void *ctx)
+{
+    unsigned product = rt->v_regs[0] * rt->v_regs[1];
+
+    (*(unsigned *)ctx)++;
+    if (product > 0xFF) {
+        *rt->pc = 0x400;
+        return false;
+    }
+    rt->v_regs[0] = product;
+
+    return true;
+}
+
+static void
+chip8_host_call (void **state)
+{
+    unsigned calls = 0;
+    uint16_t addr = 0;
+
+    /* 00XX belongs to the display instructions */
+    assert_false(chip8_rt_set_host_call(0x0E0, test_host_mul, &calls));
+    assert_false(chip8_rt_set_host_call(0x1000, test_host_mul, &calls));
+    assert_true(chip8_rt_set_host_call(0x300, test_host_mul, &calls));
+
+    /* 0x200: SYS 0x300 ; SYS 0x300 */
+    U16_MEMORY_WRITE(0x200, htons(0x0300));
+    U16_MEMORY_WRITE(0x202, htons(0x0300));
+    s_v_regs[0] = 3;
+    s_v_regs[1] = 5;
+    assert_int_equal(chip8_run(1), 1);
+    assert_int_equal(s_v_regs[0], 15);
+    assert_int_equal(s_pc, 0x202);
+
+    /* A failed call faults on the SYS, wherever it left the PC */
+    s_v_regs[1] = 100;
+    assert_int_equal(chip8_run(10), 1);
+    assert_int_equal(chip8_get_fault(&addr), CHIP8_FAULT_HOST_CALL);
+    assert_int_equal(addr, 0x202);
+    assert_int_equal(s_pc, 0x202);
+    assert_int_equal(calls, 2);
+
+    /* Without a routine SYS is an invalid instruction again */
+    assert_true(chip8_rt_set_host_call(0x300, NULL, NULL));
+    chip8_init();
+    U16_MEMORY_WRITE(0x200, htons(0x0300));
+    chip8_run(1);
+    assert_int_equal(chip8_get_fault(NULL), CHIP8_FAULT_BAD_OPCODE);
+    assert_int_equal(calls, 2);
+}
+
+static void
+decode_flags_and_operands (void **state)
+{
+    static uint8_t s_mem[MEMORY_SIZE];
+    chip8_insn_t insn;
+
+    chip8_decode(0x00C3, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_DRAW);
+    assert_string_equal(insn.text, "SCD 3");
+
+    chip8_decode(0x00FD, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_HALT);
+
+    /* SYS is not an invalid instruction, a plugin may implement it */
+    chip8_decode(0x0123, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_HOST_CALL);
+    assert_int_equal(insn.target, 0x123);
+    assert_string_equal(insn.text, "SYS 0x123");
+
+    chip8_decode(0x2456, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_CALL);
+    assert_int_equal(insn.target, 0x456);
+
+    chip8_decode(0xB300, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_INDIRECT);
+    assert_int_equal(insn.target, 0x300);
+
+    chip8_decode(0x8AB6, &insn);
+    assert_int_equal(insn.flags, 0);
+    assert_string_equal(insn.text, "SHR VA");
+
+    chip8_decode(0xE19E, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_SKIP);
+    assert_string_equal(insn.text, "SKP V1");
+
+    chip8_decode(0xF530, &insn);
+    assert_int_equal(insn.flags, 0);
+    assert_string_equal(insn.text, "LD HF, V5");
+
+    /* XO-CHIP only */
+    chip8_decode(0x5122, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_MEM_WRITE | CHIP8_INSN_XOCHIP);
+    assert_string_equal(insn.text, "LD [I], V1 - V2");
+
+    chip8_decode(0xF201, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_XOCHIP);
+    assert_string_equal(insn.text, "PLANE 2");
+
+    /* The long load takes its operand from the next word */
+    s_mem[0x300] = 0xF0;
+    s_mem[0x302] = 0x12;
+    s_mem[0x303] = 0x34;
+    chip8_decode_at(s_mem, 0x300, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_SETS_I | CHIP8_INSN_LONG |
+                                 CHIP8_INSN_XOCHIP);
+    assert_int_equal(insn.size, 4);
+    assert_int_equal(insn.target, 0x1234);
+    assert_string_equal(insn.text, "LD I, 0x1234");
+
+    /* Holes in each class */
+    chip8_decode(0x5121, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_UNSUPPORTED);
+    assert_string_equal(insn.text, "DW 0x5121");
+    chip8_decode(0x8AB8, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_UNSUPPORTED);
+    chip8_decode(0x9121, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_UNSUPPORTED);
+    chip8_decode(0xF100, &insn);
+    assert_int_equal(insn.flags, CHIP8_INSN_UNSUPPORTED);
+    assert_int_equal(insn.size, 2);
+}
+
+static void
+cfg_blocks_and_issues (void **state)
+{
+    static const uint8_t s_rom[] = {
+        0x22, 0x10,             /* 0x200: CALL 0x210 */
+        0x30, 0x00,             /* 0x202: SE V0, 0x00 */
+        0xF0, 0x00, 0x12, 0x0A, /* 0x204: LD I, long */
+        0x01, 0x23,             /* 0x208: SYS 0x123 */
+        0x12, 0x0A,             /* 0x20A: JP 0x20A */
+        0x00, 0x00, 0x00, 0x00,
+        0xA2, 0x20,             /* 0x210: LD I, 0x220 */
+        0x80, 0x08,             /* 0x212: DW 0x8008 */
+    };
+    static uint8_t s_mem[MEMORY_SIZE];
+    static chip8_cfg_t s_cfg;
+    const chip8_cfg_block_t *block;
+
+    memcpy(&s_mem[0x200], s_rom, sizeof(s_rom));
+
+    assert_int_equal(chip8_cfg_analyze(&s_cfg, s_mem, 0x200, sizeof(s_rom),
+                                       true), 0);
+    assert_int_equal(s_cfg.num_blocks, 6);
+    assert_int_equal(s_cfg.num_subroutines, 1);
+    assert_int_equal(s_cfg.subroutines[0], 0x210);
+
+    block = chip8_cfg_find_block(&s_cfg, 0x200);
+    assert_non_null(block);
+    assert_int_equal(block->call_target, 0x210);
+    assert_int_equal(block->num_succ, 1);
+    assert_int_equal(block->succ[0], 0x202);
+
+    /* An XO-CHIP skip passes over all four bytes of the long load */
+    block = chip8_cfg_find_block(&s_cfg, 0x202);
+    assert_non_null(block);
+    assert_int_equal(block->num_succ, 2);
+    assert_int_equal(block->succ[0], 0x204);
+    assert_int_equal(block->succ[1], 0x208);
+    assert_false(chip8_cfg_is_data(&s_cfg, 0x206));
+
+    /* SYS ends its block but carries on to the next instruction */
+    block = chip8_cfg_find_block(&s_cfg, 0x208);
+    assert_non_null(block);
+    assert_int_equal(block->num_succ, 1);
+    assert_int_equal(block->succ[0], 0x20A);
+
+    block = chip8_cfg_find_block(&s_cfg, 0x210);
+    assert_non_null(block);
+    assert_int_equal(block->num_insns, 2);
+    assert_int_equal(block->num_succ, 0);
+    assert_int_equal(block->routine, 0x210);
+    assert_null(chip8_cfg_find_block(&s_cfg, 0x20C));
+    assert_true(chip8_cfg_is_data(&s_cfg, 0x20C));
+    assert_true(s_cfg.byte_flags[0x220] & CHIP8_CFG_DATA_REF);
+
+    assert_int_equal(s_cfg.num_issues, 2);
+    assert_int_equal(s_cfg.issues[0].addr, 0x208);
+    assert_int_equal(s_cfg.issues[0].kind, CHIP8_INSN_HOST_CALL);
+    assert_int_equal(s_cfg.issues[1].addr, 0x212);
+    assert_int_equal(s_cfg.issues[1].kind, CHIP8_INSN_UNSUPPORTED);
+    chip8_cfg_free(&s_cfg);
+
+    /* A classic skip passes over two bytes only, landing inside the long
+     * load where the operand decodes as JP 0x20A */
+    assert_int_equal(chip8_cfg_analyze(&s_cfg, s_mem, 0x200, sizeof(s_rom),
+                                       false), 0);
+    block = chip8_cfg_find_block(&s_cfg, 0x202);
+    assert_non_null(block);
+    assert_int_equal(block->succ[1], 0x206);
+    assert_int_equal(s_cfg.byte_flags[0x206] & (CHIP8_CFG_CODE |
+                                                CHIP8_CFG_OPERAND),
+                     CHIP8_CFG_CODE | CHIP8_CFG_OPERAND);
+    assert_true(s_cfg.byte_flags[0x20A] & CHIP8_CFG_LEADER);
+    chip8_cfg_free(&s_cfg);
+}
+
 static int
 chip8_test_init (void **state)
 {
@@ -1173,6 +2599,45 @@ main(int argc, char *argv[])
         cmocka_unit_test_setup(opc_FX33, chip8_test_init),
         cmocka_unit_test_setup(opc_FX55, chip8_test_init),
         cmocka_unit_test_setup(opc_FX65, chip8_test_init),
+        cmocka_unit_test_setup(schip_hires_sprite16, chip8_test_init),
+        cmocka_unit_test_setup(schip_scroll_down, chip8_test_init),
+        cmocka_unit_test_setup(schip_scroll_sideways, chip8_test_init),
+        cmocka_unit_test_setup(schip_big_font, chip8_test_init),
+        cmocka_unit_test_setup(schip_rpl_flags, chip8_test_init),
+        cmocka_unit_test_setup(schip_exit, chip8_test_init),
+        cmocka_unit_test_setup(xochip_long_i, chip8_test_init),
+        cmocka_unit_test_setup(xochip_register_range, chip8_test_init),
+        cmocka_unit_test_setup(xochip_planes, chip8_test_init),
+        cmocka_unit_test_setup(xochip_audio, chip8_test_init),
+        cmocka_unit_test_setup(xochip_classic_restore, chip8_test_init),
+        cmocka_unit_test_setup(classic_address_wrap, chip8_test_init),
+        cmocka_unit_test_setup(chip8_save_restore_state, chip8_test_init),
+        cmocka_unit_test_setup(chip8_vram_packed, chip8_test_init),
+        cmocka_unit_test_setup(chip8_load_buffer, chip8_test_init),
+        cmocka_unit_test_setup(chip8_run_instructions, chip8_test_init),
+        cmocka_unit_test_setup(chip8_run_fault, chip8_test_init),
+        cmocka_unit_test_setup(chip8_stack_bounds, chip8_test_init),
+        cmocka_unit_test_setup(chip8_run_breakpoint, chip8_test_init),
+        cmocka_unit_test_setup(chip8_run_watchpoint, chip8_test_init),
+        cmocka_unit_test_setup(chip8_run_trace, chip8_test_init),
+        cmocka_unit_test_setup(chip8_run_native, chip8_test_init),
+        cmocka_unit_test_setup(chip8_engines, chip8_test_init),
+        cmocka_unit_test_setup(chip8_host_call, chip8_test_init),
+        cmocka_unit_test_setup(chip8_usage_counters, chip8_test_init),
+        cmocka_unit_test(metrics_text_format),
+        cmocka_unit_test(render_expand_pitch),
+        cmocka_unit_test(render_text_glyphs),
+        cmocka_unit_test(hud_percentiles),
+        cmocka_unit_test(latency_rom_inverts),
+        cmocka_unit_test(latency_samples),
+        cmocka_unit_test(term_render_diff),
+        cmocka_unit_test(shm_frame_ring),
+        cmocka_unit_test(codec_frame_deltas),
+        cmocka_unit_test(pack_lookup_and_load),
+        cmocka_unit_test(writer_queue_policies),
+        cmocka_unit_test(record_round_trip),
+        cmocka_unit_test(decode_flags_and_operands),
+        cmocka_unit_test(cfg_blocks_and_issues),
     };
 
     parse_args(argc, argv);
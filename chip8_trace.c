@@ -0,0 +1,232 @@
+/*
+ * chip8_trace - CHIP8 Phase Timing Traces
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "chip8_writer.h"
+
+/* Per thread, a power of two. 16 MB, minutes of a 60 Hz main loop. */
+#define TRACE_RING_EVENTS       (1 << 20)
+#define TRACE_MAX_THREADS       16
+#define TRACE_MAX_NAME          32
+#define TRACE_MAX_PATH          512
+
+typedef struct trace_event_s {
+    uint64_t    begin;
+    uint32_t    duration;
+    uint32_t    phase;
+} trace_event_t;
+
+/* Written only by its own thread while recording */
+typedef struct trace_buffer_s {
+    char            name[TRACE_MAX_NAME];
+    uint64_t        count;
+    trace_event_t  *events;
+} trace_buffer_t;
+
+static const char *s_phase_names[CHIP8_TRACE_PHASE_MAX] = {
+    [CHIP8_TRACE_LOOP]      = "loop",
+    [CHIP8_TRACE_POLL]      = "poll",
+    [CHIP8_TRACE_RUN]       = "run",
+    [CHIP8_TRACE_TIMERS]    = "timers",
+    [CHIP8_TRACE_AUDIO]     = "audio",
+    [CHIP8_TRACE_PAINT]     = "paint",
+    [CHIP8_TRACE_PRESENT]   = "present",
+};
+
+static bool s_recording = false;
+static char s_path[TRACE_MAX_PATH];
+static struct timespec s_epoch;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_buffer_t s_buffers[TRACE_MAX_THREADS];
+static unsigned s_num_buffers;
+
+static _Thread_local trace_buffer_t *s_buffer;
+/* Out of buffers, the thread goes untraced */
+static _Thread_local bool s_untraced;
+
+static uint64_t
+elapsed_ns (void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - s_epoch.tv_sec) * 1000000000ull +
+           now.tv_nsec - s_epoch.tv_nsec;
+}
+
+/* Gives the calling thread a buffer, false if there are none left */
+static bool
+attach_thread (void)
+{
+    trace_buffer_t *buffer = NULL;
+
+    if (s_untraced) {
+        return false;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (s_num_buffers < TRACE_MAX_THREADS) {
+        buffer = &s_buffers[s_num_buffers];
+        buffer->events = calloc(TRACE_RING_EVENTS, sizeof(trace_event_t));
+        if (buffer->events != NULL) {
+            snprintf(buffer->name, sizeof(buffer->name), "thread %u",
+                     s_num_buffers);
+            s_num_buffers++;
+        } else {
+            buffer = NULL;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    s_buffer = buffer;
+    s_untraced = (buffer == NULL);
+
+    return !s_untraced;
+}
+
+bool
+chip8_trace_start (const char *path)
+{
+    if (snprintf(s_path, sizeof(s_path), "%s", path) >= sizeof(s_path)) {
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &s_epoch);
+    s_recording = true;
+
+    return true;
+}
+
+void
+chip8_trace_thread_name (const char *name)
+{
+    if (s_recording && (s_buffer != NULL || attach_thread())) {
+        snprintf(s_buffer->name, sizeof(s_buffer->name), "%s", name);
+    }
+}
+
+uint64_t
+chip8_trace_now (void)
+{
+    return s_recording ? elapsed_ns() : 0;
+}
+
+uint64_t
+chip8_trace_phase (chip8_trace_phase_et phase, uint64_t begin)
+{
+    trace_event_t *event;
+    uint64_t now;
+
+    if (!s_recording) {
+        return 0;
+    }
+
+    now = elapsed_ns();
+    if (s_buffer == NULL && !attach_thread()) {
+        return now;
+    }
+
+    event = &s_buffer->events[s_buffer->count++ & (TRACE_RING_EVENTS - 1)];
+    event->begin = begin;
+    event->duration = now - begin;
+    event->phase = phase;
+
+    return now;
+}
+
+/* Formats into the writer's queue, which takes it to the file in large
+ * writes while the next events are formatted */
+static void
+trace_printf (int stream, const char *format, ...)
+{
+    char line[256];
+    va_list args;
+    int len;
+
+    va_start(args, format);
+    len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (len > 0) {
+        chip8_writer_write(stream, line,
+                           ((size_t)len < sizeof(line)) ? (size_t)len :
+                           sizeof(line) - 1);
+    }
+}
+
+static void
+write_buffer (int stream, const trace_buffer_t *buffer, unsigned tid)
+{
+    const trace_event_t *event;
+    uint64_t first = (buffer->count > TRACE_RING_EVENTS) ?
+                     buffer->count - TRACE_RING_EVENTS : 0;
+    uint64_t i;
+
+    trace_printf(stream, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%u,\"args\":{\"name\":\"%s\"}}", tid,
+                 buffer->name);
+
+    for (i = first; i < buffer->count; i++) {
+        event = &buffer->events[i & (TRACE_RING_EVENTS - 1)];
+        /* Microseconds, as the format expects */
+        trace_printf(stream, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+                     "\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%u.%03u}",
+                     s_phase_names[event->phase], tid,
+                     (unsigned long long)(event->begin / 1000),
+                     (unsigned)(event->begin % 1000),
+                     event->duration / 1000, event->duration % 1000);
+    }
+}
+
+bool
+chip8_trace_stop (void)
+{
+    unsigned i;
+    int stream;
+    bool ok;
+
+    if (!s_recording) {
+        return true;
+    }
+    s_recording = false;
+
+    /* Past the emulation, so formatting may wait for the disk */
+    stream = chip8_writer_open(s_path, 0, CHIP8_WRITER_BLOCK);
+    if (stream < 0) {
+        return false;
+    }
+
+    trace_printf(stream, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                 "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"args\":{\"name\":\"chip8\"}}");
+
+    pthread_mutex_lock(&s_lock);
+    for (i = 0; i < s_num_buffers; i++) {
+        write_buffer(stream, &s_buffers[i], i + 1);
+        free(s_buffers[i].events);
+        s_buffers[i].events = NULL;
+    }
+    s_num_buffers = 0;
+    s_buffer = NULL;
+    pthread_mutex_unlock(&s_lock);
+
+    trace_printf(stream, "\n]}\n");
+    ok = chip8_writer_close(stream, NULL);
+    if (!ok) {
+        printf("Unable to write trace %s\n", s_path);
+    }
+
+    return ok;
+}
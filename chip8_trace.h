@@ -0,0 +1,75 @@
+/*
+ * chip8_trace - CHIP8 Phase Timing Traces
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_TRACE_H__
+#define __CHIP8_TRACE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief       The timed phases, named in the trace as below
+ */
+typedef enum {
+    /* One pass of the main loop, enclosing the phases below */
+    CHIP8_TRACE_LOOP,       /* "loop" */
+    CHIP8_TRACE_POLL,       /* "poll", SDL_PollEvent() and key handling */
+    CHIP8_TRACE_RUN,        /* "run", the engine and debugger */
+    CHIP8_TRACE_TIMERS,     /* "timers" */
+    CHIP8_TRACE_AUDIO,      /* "audio", handing over the XO-CHIP pattern */
+    CHIP8_TRACE_PAINT,      /* "paint", uploading VRAM to the texture */
+    CHIP8_TRACE_PRESENT,    /* "present", within paint */
+    CHIP8_TRACE_PHASE_MAX,
+} chip8_trace_phase_et;
+
+/**
+ * @brief       Starts recording, once per process. Call before any traced
+ *              thread starts.
+ *
+ * Each thread records into its own ring buffer, keeping its most recent
+ * events.
+ *
+ * @param[in]   path    Where chip8_trace_stop() writes the trace
+ *
+ * @returns     true on success
+ */
+bool chip8_trace_start(const char *path);
+
+/**
+ * @brief       Stops recording and writes the Chrome trace-event JSON,
+ *              for chrome://tracing or Perfetto.
+ *
+ * Call once traced threads no longer record. Does nothing unless
+ * recording.
+ *
+ * @returns     true on success, or if not recording
+ */
+bool chip8_trace_stop(void);
+
+/**
+ * @brief       Names the calling thread in the trace
+ */
+void chip8_trace_thread_name(const char *name);
+
+/**
+ * @brief       Gets the time a phase starts at
+ *
+ * @returns     Nanoseconds since the trace started, 0 while not recording
+ */
+uint64_t chip8_trace_now(void);
+
+/**
+ * @brief       Records a phase of the calling thread that ends now
+ *
+ * @param[in]   phase   The phase
+ * @param[in]   begin   When it started, from chip8_trace_now() or the
+ *                      last chip8_trace_phase()
+ *
+ * @returns     Now, which is when the next phase begins
+ */
+uint64_t chip8_trace_phase(chip8_trace_phase_et phase, uint64_t begin);
+
+#endif /* __CHIP8_TRACE_H__ */
@@ -7,24 +7,52 @@
 #include "chip8_utils.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <SDL2/SDL.h>
 
 #include "chip8.h"
 #include "chip8_sound.h"
 
+/* All of the following belongs to the machine running on the current
+ * thread, alongside the interpreter state in chip8.c */
+
 /* The current state of a given key */
-static bool s_keys_pressed[CHIP8_KEY_MAX] = { false };
+static _Thread_local bool s_keys_pressed[CHIP8_KEY_MAX] = { false };
+
+static _Thread_local uint32_t s_delay_timer = 0;
+static _Thread_local uint32_t s_delay_timer_started_at = 0;
+static _Thread_local uint32_t s_sound_timer = 0;
+static _Thread_local uint32_t s_sound_timer_started_at = 0;
+
+/* Timer decrements, for monitoring. Not part of snapshots. */
+static _Thread_local uint64_t s_timer_ticks = 0;
+
+/* 1/60s ticks of the clock the timers count down with, running or not */
+static _Thread_local uint64_t s_frame_ticks = 0;
+static _Thread_local uint32_t s_frame_started_at = 0;
 
-static uint32_t s_delay_timer = 0;
-static uint32_t s_delay_timer_started_at = 0;
-static uint32_t s_sound_timer = 0;
-static uint32_t s_sound_timer_started_at = 0;
+/* xorshift32 state. Never zero. */
+static _Thread_local uint32_t s_random_state = 2463534242u;
 
 uint8_t
 get_random_byte (void)
 {
-    return (uint8_t)rand();
+    uint32_t x = s_random_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_random_state = x;
+
+    return (uint8_t)(x >> 24);
+}
+
+void
+seed_random (uint32_t seed)
+{
+    /* xorshift gets stuck at zero */
+    s_random_state = (seed != 0) ? seed : 2463534242u;
 }
 
 void
@@ -62,6 +90,12 @@ set_delay_timer (uint8_t ticks)
     s_delay_timer = ticks;
 }
 
+uint8_t
+get_sound_timer_remaining (void)
+{
+    return s_sound_timer;
+}
+
 void
 set_sound_timer (uint8_t ticks)
 {
@@ -72,20 +106,137 @@ set_sound_timer (uint8_t ticks)
 void
 update_timers (void)
 {
+    if ((SDL_GetTicks() - s_frame_started_at) >= 16) {
+        s_frame_started_at = SDL_GetTicks();
+        s_frame_ticks++;
+    }
+
     if (s_delay_timer &&
         ((SDL_GetTicks() - s_delay_timer_started_at) >= 16)) {
         s_delay_timer_started_at = SDL_GetTicks();
         s_delay_timer -= 1;
+        s_timer_ticks++;
     }
 
     if (s_sound_timer &&
         ((SDL_GetTicks() - s_sound_timer_started_at) >= 16)) {
         s_sound_timer_started_at = SDL_GetTicks();
         s_sound_timer -= 1;
+        s_timer_ticks++;
 
-        if (s_sound_timer == 0) {
+        /* XO-CHIP programs play their own pattern while the timer runs */
+        if (s_sound_timer == 0 && !chip8_get_xochip()) {
             /* Beep */
             chip8_sound_beep();
         }
     }
 }
+
+uint64_t
+get_timer_ticks (void)
+{
+    return s_timer_ticks;
+}
+
+uint64_t
+get_frame_ticks (void)
+{
+    return s_frame_ticks;
+}
+
+void
+tick_timers (void)
+{
+    s_frame_ticks++;
+
+    if (s_delay_timer) {
+        s_delay_timer -= 1;
+        s_timer_ticks++;
+    }
+
+    if (s_sound_timer) {
+        s_sound_timer -= 1;
+        s_timer_ticks++;
+    }
+}
+
+void
+run_frames (uint32_t frames, uint32_t instructions_per_frame)
+{
+    uint32_t f;
+
+    for (f = 0; f < frames; f++) {
+        chip8_run(instructions_per_frame);
+        tick_timers();
+    }
+}
+
+void
+chip8_utils_save_state (chip8_utils_state_t *state)
+{
+    assert(state != NULL);
+
+    memcpy(state->keys_pressed, s_keys_pressed, sizeof(s_keys_pressed));
+    state->delay_timer = s_delay_timer;
+    state->sound_timer = s_sound_timer;
+    state->random_state = s_random_state;
+}
+
+void
+chip8_utils_restore_state (const chip8_utils_state_t *state)
+{
+    assert(state != NULL);
+
+    memcpy(s_keys_pressed, state->keys_pressed, sizeof(s_keys_pressed));
+    s_delay_timer = state->delay_timer;
+    s_delay_timer_started_at = SDL_GetTicks();
+    s_sound_timer = state->sound_timer;
+    s_sound_timer_started_at = SDL_GetTicks();
+    s_random_state = state->random_state;
+}
+
+static uint64_t
+rotl64 (uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t
+hash_mix (uint64_t h)
+{
+    /* MurmurHash3 finalizer */
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return (h);
+}
+
+uint64_t
+hash_bytes (uint64_t seed, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    uint64_t h = seed ^ (len * 0x9E3779B97F4A7C15ULL);
+    uint64_t w;
+
+    /* Consume a word at a time, the snapshots being hashed are several
+     * kilobytes and this sits on the search hot path. */
+    while (len >= sizeof(w)) {
+        memcpy(&w, p, sizeof(w));
+        w *= 0x87c37b91114253d5ULL;
+        w = rotl64(w, 31);
+        w *= 0x4cf5ad432745937fULL;
+        h ^= w;
+        h = rotl64(h, 27) * 5 + 0x52dce729;
+        p += sizeof(w);
+        len -= sizeof(w);
+    }
+
+    w = 0;
+    memcpy(&w, p, len);
+    h ^= w * 0x87c37b91114253d5ULL;
+
+    return hash_mix(h);
+}
@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @brief      Gets a randomly generated byte.
@@ -17,6 +18,13 @@
  */
 uint8_t get_random_byte(void);
 
+/**
+ * @brief      Seeds the random number generator of the calling thread.
+ *
+ * @param[in]  seed  The seed, any value
+ */
+void seed_random(uint32_t seed);
+
 /**
  * @brief      Enumeration of all Chip8 keys
  */
@@ -40,6 +48,16 @@ typedef enum {
     CHIP8_KEY_MAX
 } chip8_key_et;
 
+/**
+ * @brief      Timer, key and RNG state, as captured in a machine snapshot
+ */
+typedef struct chip8_utils_state_s {
+    bool        keys_pressed[CHIP8_KEY_MAX];
+    uint8_t     delay_timer;
+    uint8_t     sound_timer;
+    uint32_t    random_state;
+} chip8_utils_state_t;
+
 /**
  * @brief      Gets the key pressed.
  *
@@ -77,6 +95,30 @@ uint8_t get_delay_timer_remaining(void);
  */
 void set_delay_timer(uint8_t ticks);
 
+/**
+ * @brief      Gets the number of 1/60 ticks left in the sound timer
+ *
+ * @return     Number of ticks remaining
+ */
+uint8_t get_sound_timer_remaining(void);
+
+/**
+ * @brief      Gets how many times either timer has counted down on this
+ *             thread, for monitoring
+ *
+ * @return     Number of ticks
+ */
+uint64_t get_timer_ticks(void);
+
+/**
+ * @brief      Gets how many 1/60s ticks of emulated time have passed on
+ *             this thread. Advances with update_timers() and tick_timers()
+ *             whether or not a timer is running.
+ *
+ * @return     Number of ticks
+ */
+uint64_t get_frame_ticks(void);
+
 /**
  * @brief      Sets the number of 1/60s ticks for the sound timer
  *
@@ -89,4 +131,45 @@ void set_sound_timer(uint8_t ticks);
  */
 void update_timers(void);
 
+/**
+ * @brief      Counts both timers down by exactly one 1/60s tick.
+ *
+ * Used by headless runners which step time by frames rather than by
+ * the wall clock, so that runs are reproducible.
+ */
+void tick_timers(void);
+
+/**
+ * @brief      Runs the interpreter for whole 1/60s frames without a display
+ *
+ * @param[in]  frames                  Number of frames to run
+ * @param[in]  instructions_per_frame  Instructions executed per frame
+ */
+void run_frames(uint32_t frames, uint32_t instructions_per_frame);
+
+/**
+ * @brief      Captures the timer, key and RNG state of the calling thread
+ *
+ * @param[out] state  Where to store the state
+ */
+void chip8_utils_save_state(chip8_utils_state_t *state);
+
+/**
+ * @brief      Restores state captured by chip8_utils_save_state()
+ *
+ * @param[in]  state  The state to restore
+ */
+void chip8_utils_restore_state(const chip8_utils_state_t *state);
+
+/**
+ * @brief      Hashes a block of memory into a 64-bit value
+ *
+ * @param[in]  seed  Starting value, allows chaining several blocks
+ * @param[in]  data  The data to hash
+ * @param[in]  len   Length of the data in bytes
+ *
+ * @return     The hash
+ */
+uint64_t hash_bytes(uint64_t seed, const void *data, size_t len);
+
 #endif /* __CHIP8_UTILS_H__ */
@@ -0,0 +1,694 @@
+/*
+ * chip8_writer - CHIP8 Asynchronous File Output
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "chip8_writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+/* io_uring through the raw system calls, liburing is not needed */
+#if defined(__NR_io_uring_setup) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define WRITER_URING
+#include <sys/mman.h>
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#define WRITER_MIN_QUEUE    4096
+
+typedef struct writer_stream_s {
+    /* Set by open and close, the I/O thread skips inactive streams */
+    atomic_bool             active;
+    /* Bumped by open before it resets the slot, see snapshot_queue() */
+    atomic_uint             generation;
+    int                     fd;
+    /* Pipes and terminals are written at their current position, files
+     * from where they were when the stream opened */
+    bool                    seekable;
+    uint64_t                base;
+    chip8_writer_policy_et  policy;
+    uint8_t                *queue;
+    size_t                  size;
+    /* Bytes ever queued and ever taken off the queue. Only the producer
+     * moves head and only the I/O thread moves tail. */
+    _Alignas(64) atomic_uint_fast64_t head;
+    _Alignas(64) atomic_uint_fast64_t tail;
+    /* Only the I/O thread, read by close once the queue is empty */
+    uint64_t                written;
+    uint64_t                syscalls;
+    atomic_bool             failed;
+    /* Only the producer */
+    uint64_t                dropped_writes;
+    uint64_t                dropped_bytes;
+} writer_stream_t;
+
+#ifdef WRITER_URING
+typedef struct writer_uring_s {
+    int                     fd;
+    unsigned               *sq_tail;
+    unsigned               *sq_mask;
+    unsigned               *sq_array;
+    unsigned               *cq_head;
+    unsigned               *cq_tail;
+    unsigned               *cq_mask;
+    struct io_uring_sqe    *sqes;
+    struct io_uring_cqe    *cqes;
+    void                   *sq_ring;
+    void                   *cq_ring;
+    size_t                  sq_ring_size;
+    size_t                  cq_ring_size;
+    size_t                  sqes_size;
+} writer_uring_t;
+
+static writer_uring_t s_uring = { .fd = -1 };
+#endif
+
+static writer_stream_t s_streams[CHIP8_WRITER_MAX_STREAMS];
+
+/* Held while opening and closing streams, and starting and stopping the
+ * I/O thread */
+static pthread_mutex_t s_open_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned s_num_open;
+static pthread_t s_writer_thread;
+/* Read by chip8_writer_backend(), the I/O thread may fall back */
+static _Atomic(const char *) s_backend = NULL;
+static atomic_bool s_writer_stopping;
+
+/* Producers waiting for room sleep on s_progress. The I/O thread only
+ * takes the lock to wake them when there are some. */
+static pthread_mutex_t s_writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_progress = PTHREAD_COND_INITIALIZER;
+static atomic_uint s_waiters;
+
+/* Producers only write to the pipe when the I/O thread is asleep on it */
+static atomic_bool s_writer_idle;
+static int s_writer_pipe[2] = { -1, -1 };
+
+static size_t
+queued (writer_stream_t *s)
+{
+    return atomic_load_explicit(&s->head, memory_order_relaxed) -
+           atomic_load_explicit(&s->tail, memory_order_acquire);
+}
+
+size_t
+chip8_writer_space (int stream)
+{
+    writer_stream_t *s = &s_streams[stream];
+
+    return s->size - queued(s);
+}
+
+static void
+wake_writer (void)
+{
+    /* Pairs with the fence in the I/O thread. Whichever side goes second
+     * sees the other: the new head, or the thread asleep. */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s_writer_idle, memory_order_relaxed) &&
+        atomic_exchange(&s_writer_idle, false)) {
+        (void)!write(s_writer_pipe[1], "", 1);
+    }
+}
+
+/* Waits until the stream's queue has room for need bytes */
+static void
+wait_for_space (writer_stream_t *s, size_t need)
+{
+    if (s->size - queued(s) >= need) {
+        return;
+    }
+
+    atomic_fetch_add(&s_waiters, 1);
+    wake_writer();
+    pthread_mutex_lock(&s_writer_lock);
+    while (s->size - queued(s) < need) {
+        pthread_cond_wait(&s_progress, &s_writer_lock);
+    }
+    pthread_mutex_unlock(&s_writer_lock);
+    atomic_fetch_sub(&s_waiters, 1);
+}
+
+static void
+enqueue (writer_stream_t *s, const uint8_t *data, size_t len)
+{
+    uint64_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    size_t pos = head & (s->size - 1);
+    size_t first = (len < s->size - pos) ? len : s->size - pos;
+
+    memcpy(&s->queue[pos], data, first);
+    memcpy(s->queue, data + first, len - first);
+    atomic_store_explicit(&s->head, head + len, memory_order_release);
+}
+
+bool
+chip8_writer_write (int stream, const void *data, size_t len)
+{
+    writer_stream_t *s = &s_streams[stream];
+    const uint8_t *bytes = data;
+    size_t chunk;
+
+    if (s->policy == CHIP8_WRITER_DROP) {
+        if (len > s->size - queued(s)) {
+            s->dropped_writes++;
+            s->dropped_bytes += len;
+            return false;
+        }
+        enqueue(s, bytes, len);
+    } else {
+        while (len > 0) {
+            chunk = (len < s->size) ? len : s->size;
+            wait_for_space(s, chunk);
+            enqueue(s, bytes, chunk);
+            bytes += chunk;
+            len -= chunk;
+        }
+    }
+
+    wake_writer();
+    return true;
+}
+
+/* What the I/O thread may write of a stream, false if there is nothing.
+ * open and close do not wait for the I/O thread, so a slot can be closed
+ * and opened again while it reads head and tail. Retried like a seqlock
+ * on the generation instead. Once there is something queued the stream
+ * cannot be closed until the I/O thread takes it off. */
+static bool
+snapshot_queue (writer_stream_t *s, uint64_t *head, uint64_t *tail)
+{
+    unsigned generation;
+
+    do {
+        generation = atomic_load_explicit(&s->generation,
+                                          memory_order_acquire);
+        if (!atomic_load_explicit(&s->active, memory_order_acquire)) {
+            return false;
+        }
+        *head = atomic_load_explicit(&s->head, memory_order_acquire);
+        *tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&s->generation, memory_order_relaxed) !=
+             generation);
+
+    return *head != *tail;
+}
+
+/* Up to two pieces, the queue wraps around. Returns how many. */
+static int
+queued_iovecs (writer_stream_t *s, uint64_t head, uint64_t tail,
+               struct iovec iov[2])
+{
+    size_t pos = tail & (s->size - 1);
+    size_t len = head - tail;
+
+    iov[0].iov_base = &s->queue[pos];
+    iov[0].iov_len = (len < s->size - pos) ? len : s->size - pos;
+    iov[1].iov_base = s->queue;
+    iov[1].iov_len = len - iov[0].iov_len;
+
+    return (iov[1].iov_len > 0) ? 2 : 1;
+}
+
+/* Takes written bytes off the queue, or all of them once it failed */
+static void
+complete_write (writer_stream_t *s, uint64_t head, ssize_t result)
+{
+    uint64_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+
+    s->syscalls++;
+    if (result < 0 && result != -EINTR && result != -EAGAIN) {
+        atomic_store(&s->failed, true);
+    }
+
+    if (atomic_load(&s->failed)) {
+        tail = head;
+    } else if (result > 0) {
+        s->written += result;
+        tail += result;
+    }
+    atomic_store_explicit(&s->tail, tail, memory_order_release);
+}
+
+#ifdef WRITER_URING
+static bool
+uring_setup (void)
+{
+    struct io_uring_params params;
+    writer_uring_t *u = &s_uring;
+
+    memset(&params, 0, sizeof(params));
+    u->fd = syscall(__NR_io_uring_setup, CHIP8_WRITER_MAX_STREAMS, &params);
+    if (u->fd < 0) {
+        /* Too old a kernel, or not allowed here */
+        return false;
+    }
+
+    u->sq_ring_size = params.sq_off.array +
+                      params.sq_entries * sizeof(unsigned);
+    u->cq_ring_size = params.cq_off.cqes +
+                      params.cq_entries * sizeof(struct io_uring_cqe);
+    u->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    u->sq_ring = mmap(NULL, u->sq_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQ_RING);
+    u->cq_ring = mmap(NULL, u->cq_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_CQ_RING);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+    if (u->sq_ring == MAP_FAILED || u->cq_ring == MAP_FAILED ||
+        u->sqes == MAP_FAILED) {
+        if (u->sq_ring != MAP_FAILED) {
+            munmap(u->sq_ring, u->sq_ring_size);
+        }
+        if (u->cq_ring != MAP_FAILED) {
+            munmap(u->cq_ring, u->cq_ring_size);
+        }
+        if (u->sqes != MAP_FAILED) {
+            munmap(u->sqes, u->sqes_size);
+        }
+        close(u->fd);
+        u->fd = -1;
+        return false;
+    }
+
+    u->sq_tail = (unsigned *)((uint8_t *)u->sq_ring + params.sq_off.tail);
+    u->sq_mask = (unsigned *)((uint8_t *)u->sq_ring +
+                              params.sq_off.ring_mask);
+    u->sq_array = (unsigned *)((uint8_t *)u->sq_ring + params.sq_off.array);
+    u->cq_head = (unsigned *)((uint8_t *)u->cq_ring + params.cq_off.head);
+    u->cq_tail = (unsigned *)((uint8_t *)u->cq_ring + params.cq_off.tail);
+    u->cq_mask = (unsigned *)((uint8_t *)u->cq_ring +
+                              params.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)((uint8_t *)u->cq_ring +
+                                      params.cq_off.cqes);
+
+    return true;
+}
+
+static void
+uring_teardown (void)
+{
+    writer_uring_t *u = &s_uring;
+
+    if (u->fd < 0) {
+        return;
+    }
+    munmap(u->sq_ring, u->sq_ring_size);
+    munmap(u->cq_ring, u->cq_ring_size);
+    munmap(u->sqes, u->sqes_size);
+    close(u->fd);
+    u->fd = -1;
+}
+
+/* One system call writes every stream that has something queued */
+static bool
+uring_flush (void)
+{
+    static struct iovec s_iov[CHIP8_WRITER_MAX_STREAMS][2];
+    static uint64_t s_heads[CHIP8_WRITER_MAX_STREAMS];
+    writer_uring_t *u = &s_uring;
+    struct io_uring_sqe *sqe;
+    struct io_uring_cqe *cqe;
+    writer_stream_t *s;
+    unsigned sq_tail = *u->sq_tail;
+    unsigned cq_head;
+    unsigned pending = 0;
+    unsigned i;
+    uint64_t tail;
+    bool fallback = false;
+    long ret;
+
+    for (i = 0; i < CHIP8_WRITER_MAX_STREAMS; i++) {
+        s = &s_streams[i];
+        if (!snapshot_queue(s, &s_heads[i], &tail)) {
+            continue;
+        }
+        if (atomic_load(&s->failed)) {
+            complete_write(s, s_heads[i], 0);
+            continue;
+        }
+
+        sqe = &u->sqes[sq_tail & *u->sq_mask];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = s->fd;
+        sqe->addr = (uint64_t)(uintptr_t)s_iov[i];
+        sqe->len = queued_iovecs(s, s_heads[i], tail, s_iov[i]);
+        sqe->off = s->seekable ? s->base + s->written : (uint64_t)-1;
+        sqe->user_data = i;
+        u->sq_array[sq_tail & *u->sq_mask] = sq_tail & *u->sq_mask;
+        sq_tail++;
+        pending++;
+    }
+    if (pending == 0) {
+        return false;
+    }
+    __atomic_store_n(u->sq_tail, sq_tail, __ATOMIC_RELEASE);
+
+    ret = syscall(__NR_io_uring_enter, u->fd, pending, pending,
+                  IORING_ENTER_GETEVENTS, NULL, 0);
+    if (ret < (long)pending) {
+        /* Only wait for what went in. The rest is left on the queues for
+         * pwritev, which takes over for good. */
+        fallback = true;
+        pending = (ret > 0) ? ret : 0;
+    }
+    while (pending > 0) {
+        cq_head = *u->cq_head;
+        while (cq_head != __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+            cqe = &u->cqes[cq_head & *u->cq_mask];
+            complete_write(&s_streams[cqe->user_data],
+                           s_heads[cqe->user_data], cqe->res);
+            cq_head++;
+            pending--;
+        }
+        __atomic_store_n(u->cq_head, cq_head, __ATOMIC_RELEASE);
+
+        /* Interrupted while waiting, the writes are still going */
+        if (pending > 0) {
+            ret = syscall(__NR_io_uring_enter, u->fd, 0, pending,
+                          IORING_ENTER_GETEVENTS, NULL, 0);
+            if (ret < 0 && errno != EINTR) {
+                break;
+            }
+        }
+    }
+
+    if (fallback) {
+        uring_teardown();
+        s_backend = "pwritev";
+    }
+
+    return true;
+}
+#endif
+
+static bool
+pwritev_flush (void)
+{
+    struct iovec iov[2];
+    writer_stream_t *s;
+    bool progress = false;
+    uint64_t head;
+    uint64_t tail;
+    ssize_t result;
+    unsigned i;
+    int count;
+
+    for (i = 0; i < CHIP8_WRITER_MAX_STREAMS; i++) {
+        s = &s_streams[i];
+        if (!snapshot_queue(s, &head, &tail)) {
+            continue;
+        }
+
+        result = 0;
+        if (!atomic_load(&s->failed)) {
+            count = queued_iovecs(s, head, tail, iov);
+            result = s->seekable ?
+                     pwritev(s->fd, iov, count, s->base + s->written) :
+                     writev(s->fd, iov, count);
+            if (result < 0) {
+                result = -errno;
+            }
+        }
+        complete_write(s, head, result);
+        progress = true;
+    }
+
+    return progress;
+}
+
+static bool
+anything_queued (void)
+{
+    uint64_t head;
+    uint64_t tail;
+    unsigned i;
+
+    for (i = 0; i < CHIP8_WRITER_MAX_STREAMS; i++) {
+        if (snapshot_queue(&s_streams[i], &head, &tail)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void *
+write_streams (void *arg)
+{
+    char drain[64];
+    bool progress;
+
+    for (;;) {
+        /* Whatever producers queue while this runs goes in the next
+         * batch */
+#ifdef WRITER_URING
+        progress = (s_uring.fd >= 0) ? uring_flush() : pwritev_flush();
+#else
+        progress = pwritev_flush();
+#endif
+        if (progress) {
+            /* Pairs with the fence a waiter passes in wake_writer(), so it
+             * sees the new tail or is seen here */
+            atomic_thread_fence(memory_order_seq_cst);
+            if (atomic_load(&s_waiters) > 0) {
+                pthread_mutex_lock(&s_writer_lock);
+                pthread_cond_broadcast(&s_progress);
+                pthread_mutex_unlock(&s_writer_lock);
+            }
+            continue;
+        }
+
+        if (atomic_load(&s_writer_stopping)) {
+            break;
+        }
+
+        atomic_store(&s_writer_idle, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (anything_queued()) {
+            atomic_store(&s_writer_idle, false);
+            continue;
+        }
+        if (read(s_writer_pipe[0], drain, sizeof(drain)) < 0 &&
+            errno != EINTR) {
+            break;
+        }
+        atomic_store(&s_writer_idle, false);
+    }
+
+    return NULL;
+}
+
+static void
+close_writer_pipe (void)
+{
+    if (s_writer_pipe[0] >= 0) {
+        close(s_writer_pipe[0]);
+        close(s_writer_pipe[1]);
+        s_writer_pipe[0] = -1;
+        s_writer_pipe[1] = -1;
+    }
+}
+
+static bool
+start_writer (void)
+{
+    atomic_store(&s_writer_stopping, false);
+    atomic_store(&s_writer_idle, false);
+
+    s_backend = "pwritev";
+#ifdef WRITER_URING
+    if (uring_setup()) {
+        s_backend = "io_uring";
+    }
+#endif
+
+    if (pipe(s_writer_pipe) != 0 ||
+        fcntl(s_writer_pipe[1], F_SETFL, O_NONBLOCK) != 0 ||
+        pthread_create(&s_writer_thread, NULL, write_streams, NULL) != 0) {
+        printf("Unable to start the writer - %s\n", strerror(errno));
+        close_writer_pipe();
+#ifdef WRITER_URING
+        uring_teardown();
+#endif
+        s_backend = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static void
+stop_writer (void)
+{
+    atomic_store(&s_writer_stopping, true);
+    (void)!write(s_writer_pipe[1], "", 1);
+    pthread_join(s_writer_thread, NULL);
+    close_writer_pipe();
+#ifdef WRITER_URING
+    uring_teardown();
+#endif
+    s_backend = NULL;
+}
+
+/* Takes fd over, or closes it on failure. name is for messages. */
+static int
+open_stream (int fd, const char *name, size_t queue_size,
+             chip8_writer_policy_et policy)
+{
+    writer_stream_t *s = NULL;
+    size_t size = WRITER_MIN_QUEUE;
+    off_t pos;
+    int i;
+
+    if (queue_size == 0) {
+        queue_size = CHIP8_WRITER_DEFAULT_QUEUE;
+    }
+    while (size < queue_size) {
+        size *= 2;
+    }
+
+    pthread_mutex_lock(&s_open_lock);
+
+    for (i = 0; i < CHIP8_WRITER_MAX_STREAMS; i++) {
+        if (!atomic_load(&s_streams[i].active)) {
+            s = &s_streams[i];
+            break;
+        }
+    }
+    if (s == NULL) {
+        printf("Unable to open %s - more than %d files\n", name,
+               CHIP8_WRITER_MAX_STREAMS);
+        close(fd);
+        pthread_mutex_unlock(&s_open_lock);
+        return (-1);
+    }
+
+    /* The I/O thread may still be reading the slot's last life */
+    atomic_fetch_add_explicit(&s->generation, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    s->fd = fd;
+    s->queue = malloc(size);
+    if (s->queue == NULL) {
+        printf("Unable to open %s - %s\n", name, strerror(errno));
+        close(fd);
+        pthread_mutex_unlock(&s_open_lock);
+        return (-1);
+    }
+
+    pos = lseek(s->fd, 0, SEEK_CUR);
+    s->seekable = (pos >= 0);
+    s->base = s->seekable ? (uint64_t)pos : 0;
+    s->policy = policy;
+    s->size = size;
+    atomic_store(&s->head, 0);
+    atomic_store(&s->tail, 0);
+    s->written = 0;
+    s->syscalls = 0;
+    atomic_store(&s->failed, false);
+    s->dropped_writes = 0;
+    s->dropped_bytes = 0;
+
+    if (s_num_open == 0 && !start_writer()) {
+        close(s->fd);
+        free(s->queue);
+        pthread_mutex_unlock(&s_open_lock);
+        return (-1);
+    }
+    s_num_open++;
+    atomic_store_explicit(&s->active, true, memory_order_release);
+
+    pthread_mutex_unlock(&s_open_lock);
+    return i;
+}
+
+int
+chip8_writer_open (const char *path, size_t queue_size,
+                   chip8_writer_policy_et policy)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        printf("Unable to open %s - %s\n", path, strerror(errno));
+        return (-1);
+    }
+
+    return open_stream(fd, path, queue_size, policy);
+}
+
+int
+chip8_writer_open_fd (int fd, size_t queue_size,
+                      chip8_writer_policy_et policy)
+{
+    char name[32];
+
+    snprintf(name, sizeof(name), "file descriptor %d", fd);
+    return open_stream(fd, name, queue_size, policy);
+}
+
+void
+chip8_writer_flush (int stream)
+{
+    writer_stream_t *s = &s_streams[stream];
+
+    wait_for_space(s, s->size);
+}
+
+bool
+chip8_writer_close (int stream, chip8_writer_stats_t *stats)
+{
+    writer_stream_t *s = &s_streams[stream];
+    bool failed;
+
+    /* The queue only empties, this is its only producer */
+    chip8_writer_flush(stream);
+
+    pthread_mutex_lock(&s_open_lock);
+
+    atomic_store(&s->active, false);
+    failed = atomic_load(&s->failed);
+    if (close(s->fd) != 0) {
+        failed = true;
+    }
+    free(s->queue);
+    s->queue = NULL;
+
+    if (stats != NULL) {
+        stats->written = s->written;
+        stats->dropped_writes = s->dropped_writes;
+        stats->dropped_bytes = s->dropped_bytes;
+        stats->syscalls = s->syscalls;
+        stats->failed = failed;
+    }
+
+    if (--s_num_open == 0) {
+        stop_writer();
+    }
+
+    pthread_mutex_unlock(&s_open_lock);
+    return !failed;
+}
+
+const char *
+chip8_writer_backend (void)
+{
+    return s_backend;
+}
@@ -0,0 +1,117 @@
+/*
+ * chip8_writer - CHIP8 Asynchronous File Output
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __CHIP8_WRITER_H__
+#define __CHIP8_WRITER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CHIP8_WRITER_MAX_STREAMS    8
+/* Bytes queued per stream unless asked otherwise, a power of two */
+#define CHIP8_WRITER_DEFAULT_QUEUE  (1 << 20)
+
+/**
+ * @brief      What a write does when the stream's queue is full
+ */
+typedef enum {
+    /* Drop the whole write and count it, for threads that must never
+     * wait, such as the emulation thread */
+    CHIP8_WRITER_DROP,
+    /* Wait for the I/O thread to make room */
+    CHIP8_WRITER_BLOCK,
+} chip8_writer_policy_et;
+
+/**
+ * @brief      What came of a stream, see chip8_writer_close()
+ */
+typedef struct chip8_writer_stats_s {
+    /* Bytes in the file */
+    uint64_t    written;
+    /* Writes and bytes dropped because the queue was full */
+    uint64_t    dropped_writes;
+    uint64_t    dropped_bytes;
+    /* System calls the bytes took */
+    uint64_t    syscalls;
+    /* A write to the file failed, everything after it was discarded */
+    bool        failed;
+} chip8_writer_stats_t;
+
+/**
+ * @brief      Creates or truncates a file and starts queueing writes to
+ *             it. The I/O thread starts with the first stream.
+ *
+ * Each stream has one producing thread, the one that writes to it and
+ * closes it. Writes from it are copied into a lock-free queue, and the
+ * I/O thread writes out everything queued on every stream at once, with
+ * io_uring where the kernel allows it and pwritev() otherwise.
+ *
+ * @param[in]  path        The file
+ * @param[in]  queue_size  Bytes the queue holds, rounded up to a power of
+ *                         two, 0 for CHIP8_WRITER_DEFAULT_QUEUE
+ * @param[in]  policy      What a write does when the queue is full
+ *
+ * @returns    The stream, -1 on error after printing why
+ */
+int chip8_writer_open(const char *path, size_t queue_size,
+                      chip8_writer_policy_et policy);
+
+/**
+ * @brief      Starts queueing writes to a file that is already open, such
+ *             as a duplicate of standard output. Writes go on from the
+ *             file's current position.
+ *
+ * @param[in]  fd          The file, closed by chip8_writer_close() or on
+ *                         error
+ * @param[in]  queue_size  See chip8_writer_open()
+ * @param[in]  policy      What a write does when the queue is full
+ *
+ * @returns    The stream, -1 on error after printing why
+ */
+int chip8_writer_open_fd(int fd, size_t queue_size,
+                         chip8_writer_policy_et policy);
+
+/**
+ * @brief      Queues bytes for a stream, see chip8_writer_policy_et
+ *
+ * Writes are never split: a dropped write leaves nothing in the file.
+ * A write larger than the queue is always dropped under
+ * CHIP8_WRITER_DROP, and goes in pieces under CHIP8_WRITER_BLOCK.
+ *
+ * @returns    false if the write was dropped
+ */
+bool chip8_writer_write(int stream, const void *data, size_t len);
+
+/**
+ * @brief      Bytes a write could queue right now without waiting or
+ *             being dropped
+ */
+size_t chip8_writer_space(int stream);
+
+/**
+ * @brief      Waits for everything queued so far to be written out.
+ *             Call from the stream's producing thread.
+ */
+void chip8_writer_flush(int stream);
+
+/**
+ * @brief      Waits for the queue to be written out and closes the file.
+ *             The I/O thread stops with the last stream.
+ *
+ * @param[out] stats   What came of the stream, may be NULL
+ *
+ * @returns    false if writing the file failed
+ */
+bool chip8_writer_close(int stream, chip8_writer_stats_t *stats);
+
+/**
+ * @brief      Names the way the I/O thread writes, "io_uring" or
+ *             "pwritev", NULL while it is not running
+ */
+const char *chip8_writer_backend(void);
+
+#endif /* __CHIP8_WRITER_H__ */
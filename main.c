@@ -5,7 +5,9 @@
  */
 
 #include <stdbool.h>
+#include <string.h>
 #include <assert.h>
+#include <unistd.h>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_keyboard.h>
@@ -14,18 +16,101 @@
 #include "chip8.h"
 #include "chip8_utils.h"
 #include "chip8_sound.h"
+#include "chip8_debugger.h"
+#include "chip8_engine.h"
+#include "chip8_plugin.h"
+#include "chip8_trace.h"
+#include "chip8_hud.h"
+#include "chip8_metrics.h"
+#include "chip8_latency.h"
+#include "chip8_frontend.h"
+#include "chip8_term.h"
+#include "chip8_shm.h"
+#include "chip8_stream.h"
+#include "chip8_render.h"
+#include "chip8_pack.h"
+#include "chip8_record.h"
 
 #define WINDOW_WIDTH    640
 #define WINDOW_HEIGHT   320
 
+/* The overlay texture fits 40x5 cells of the built-in font, room for the
+ * four lines of stats, and is drawn at twice its size in the top-left
+ * corner */
+#define HUD_WIDTH       160
+#define HUD_HEIGHT      32
+#define HUD_SCALE       2
+#define HUD_TEXT_COLOR  0xFFFFFF00
+#define HUD_BACKGROUND  0xA0000000
+
+/* A 60 Hz display refresh */
+#define FRAME_NS                (1000000000ull / 60)
+/* How often the metrics snapshot is republished */
+#define METRICS_PUBLISH_NS      100000000ull
+
+/* Instructions each engine runs while picking the fastest */
+#define ENGINE_CALIBRATION_INSTRUCTIONS 200000
+
 #define ERROR_LOG(...) (fprintf(stderr, __VA_ARGS__))
 
 /* Variables related to SDL window and rendering */
 static SDL_Window       *main_window = NULL;
 static SDL_Texture      *screen_texture = NULL;
 static SDL_Renderer     *renderer = NULL;
+/* The part of the screen texture the last frame was uploaded to */
+static SDL_Rect          screen_src = { 0, 0, 0, 0 };
+/* The screen as of the last pass */
+static chip8_frontend_frame_t screen_frame;
+
+/* Where frames are shown, the SDL window unless -T is given */
+static const chip8_frontend_t *frontend = NULL;
+static bool              terminal_enabled = false;
 
 static bool              is_running = true;
+/* Start in, and break into, the interactive debugger */
+static bool              debug_enabled = false;
+/* Execution stopped where the debugger could not take over */
+static bool              debugger_unavailable = false;
+/* Engine named on the command line, NULL to calibrate */
+static const char       *engine_name = NULL;
+/* Instructions run per pass of the main loop */
+static uint32_t          instructions_per_loop = 1;
+static bool              instructions_per_loop_set = false;
+/* ARGB colors of lit and unlit pixels */
+static uint32_t          fg_color = CHIP8_RENDER_DEFAULT_FG;
+static uint32_t          bg_color = CHIP8_RENDER_DEFAULT_BG;
+/* Run the program as XO-CHIP */
+static bool              xochip_enabled = false;
+/* Chrome trace of the main loop phases, NULL for none */
+static const char       *trace_path = NULL;
+/* Performance overlay, and the numbers in the window title */
+static bool              hud_enabled = false;
+static SDL_Texture      *hud_texture = NULL;
+/* Time spent in each part of the current frame */
+static uint64_t          hud_phase_ns[CHIP8_HUD_PHASE_MAX];
+/* Where to serve Prometheus metrics, NULL for nowhere */
+static const char       *metrics_target = NULL;
+static chip8_metrics_t   metrics;
+/* Swap on the display refresh. Off by default: the loop presents on
+ * every pass, so vsync would also pace the emulation to one pass per
+ * refresh. */
+static bool              vsync_enabled = false;
+/* Presses to measure input latency over, 0 when not measuring */
+static uint32_t          latency_samples = 0;
+/* Shared memory to publish frames in, NULL for none */
+static const char       *shm_name = NULL;
+/* Socket to stream frames to spectators on, NULL for none */
+static const char       *stream_path = NULL;
+/* File to record frames to, NULL for none */
+static const char       *record_path = NULL;
+/* ROM pack the program is in, NULL to load it from a file */
+static const char       *pack_path = NULL;
+static chip8_pack_t      rom_pack;
+/* Passes of the main loop so far */
+static uint64_t          frame_number = 0;
+/* Tick of the last recorded frame, and whether the screen changed since */
+static uint64_t          record_tick = UINT64_MAX;
+static bool              record_pending = false;
 static uint32_t         *screen_backing_store = NULL;
 
 static SDL_Window *
@@ -146,66 +231,363 @@ handle_key_up_event (SDL_Event *event)
     }
 }
 
+static bool
+sdl_poll (void)
+{
+    SDL_Event event;
+
+    /* Process incoming events.
+     * NOTE: This will chew up 100% CPU without vsync.
+     * Would be nice to have a better way to wait between drawing frames */
+    if (SDL_PollEvent(&event) != 0) {
+        if (event.type == SDL_QUIT) {
+            return false;
+        } else if (event.type == SDL_KEYDOWN) {
+            handle_key_down_event(&event);
+        } else if (event.type == SDL_KEYUP) {
+            handle_key_up_event(&event);
+        }
+    }
+
+    return true;
+}
+
+/* Expands a changed frame into the screen texture */
+static bool
+sdl_upload (const chip8_frontend_frame_t *frame)
+{
+    uint32_t palette[CHIP8_RENDER_NUM_COLORS] = {
+        bg_color, fg_color,
+        CHIP8_RENDER_DEFAULT_FG2, CHIP8_RENDER_DEFAULT_BLEND,
+    };
+    SDL_Rect src = { 0, 0, frame->width, frame->height };
+    uint32_t *gpu_pixels = NULL;
+    int pitch = 0;
+
+    /* The low resolution image uses the top-left corner of the texture */
+    if (SDL_LockTexture(screen_texture, &src, (void **)&gpu_pixels,
+                        &pitch) != 0) {
+        return false;
+    }
+    if (frame->planes == 1) {
+        chip8_render_expand(gpu_pixels, pitch, frame->packed[0],
+                            src.w, src.h, fg_color, bg_color);
+    } else {
+        chip8_render_expand_planes(gpu_pixels, pitch, frame->packed[0],
+                                   frame->packed[1], src.w, src.h, palette);
+    }
+    SDL_UnlockTexture(screen_texture);
+    screen_src = src;
+
+    return true;
+}
+
 static void
+sdl_present (void)
+{
+    SDL_Rect hud = { 0, 0, HUD_WIDTH * HUD_SCALE, HUD_HEIGHT * HUD_SCALE };
+
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, screen_texture, &screen_src, NULL);
+    if (hud_enabled) {
+        SDL_RenderCopy(renderer, hud_texture, NULL, &hud);
+    }
+    SDL_RenderPresent(renderer);
+}
+
+/* Returns true if the presented frame differs from the last one */
+static bool
 paint_screen (void)
 {
-    uint8_t *vram = chip8_get_vram();
-    uint32_t *gpu_pixels = NULL;
+    static chip8_frontend_frame_t s_last_frame;
+    uint64_t begin = chip8_trace_now();
+    uint64_t hud_begin = hud_enabled ? chip8_hud_now() : 0;
+    size_t size = 0;
+    bool changed;
+    int i;
+
+    /* Classic programs never draw to the second plane */
+    screen_frame.planes = chip8_get_xochip() ? NUM_PLANES : 1;
+    for (i = 0; i < screen_frame.planes; i++) {
+        size = chip8_get_vram_packed(i, screen_frame.packed[i]);
+    }
+    chip8_get_resolution(&screen_frame.width, &screen_frame.height);
+
+    /* Most frames draw nothing, only upload when VRAM changed */
+    changed = (screen_frame.width != s_last_frame.width ||
+               screen_frame.height != s_last_frame.height ||
+               screen_frame.planes != s_last_frame.planes);
+    for (i = 0; i < screen_frame.planes && !changed; i++) {
+        changed = (memcmp(screen_frame.packed[i], s_last_frame.packed[i],
+                          size) != 0);
+    }
+
+    if (changed && frontend->upload(&screen_frame)) {
+        s_last_frame = screen_frame;
+    }
+
+    begin = chip8_trace_phase(CHIP8_TRACE_PAINT, begin);
+    if (hud_enabled) {
+        hud_phase_ns[CHIP8_HUD_UPLOAD] = chip8_hud_now() - hud_begin;
+        hud_begin += hud_phase_ns[CHIP8_HUD_UPLOAD];
+    }
+
+    frontend->present();
+
+    chip8_trace_phase(CHIP8_TRACE_PRESENT, begin);
+    if (hud_enabled) {
+        hud_phase_ns[CHIP8_HUD_PRESENT] = chip8_hud_now() - hud_begin;
+    }
+
+    return changed;
+}
+
+/* Redraws the overlay and the window title with the latest numbers */
+static void
+update_hud (void)
+{
+    chip8_hud_stats_t stats;
+    char text[256];
+    char title[256];
+    uint32_t *pixels = NULL;
+    uint32_t *row;
+    size_t len;
     int pitch = 0;
     int x;
     int y;
 
-    SDL_LockTexture(screen_texture, NULL, (void **)&gpu_pixels, &pitch);
+    chip8_hud_get_stats(&stats);
 
-    for (y = 0; y < DISPLAY_HEIGHT_PIXELS; y++) {
-        for (x = 0; x < DISPLAY_WIDTH_PIXELS; x++) {
-            if (vram[y * DISPLAY_WIDTH_PIXELS + x] != 0) {
-                gpu_pixels[y * DISPLAY_WIDTH_PIXELS + x] = 0xFFFFFFFF;
-            } else {
-                gpu_pixels[y * DISPLAY_WIDTH_PIXELS + x] = 0x00000000;
-            }
+    len = snprintf(title, sizeof(title), "CHIP8 - ");
+    chip8_hud_format(&stats, ", ", &title[len], sizeof(title) - len);
+    SDL_SetWindowTitle(get_window(), title);
+
+    if (SDL_LockTexture(hud_texture, NULL, (void **)&pixels, &pitch) != 0) {
+        return;
+    }
+    for (y = 0; y < HUD_HEIGHT; y++) {
+        row = (uint32_t *)((uint8_t *)pixels + y * pitch);
+        for (x = 0; x < HUD_WIDTH; x++) {
+            row[x] = HUD_BACKGROUND;
         }
     }
+    chip8_hud_format(&stats, "\n", text, sizeof(text));
+    chip8_render_text(pixels, pitch, HUD_WIDTH, HUD_HEIGHT, 1, 1, 1, text,
+                      HUD_TEXT_COLOR);
+    SDL_UnlockTexture(hud_texture);
+}
 
-    SDL_UnlockTexture(screen_texture);
+/* Hands the XO-CHIP pattern to the audio callback, which resamples it
+ * on its own clock however many instructions ran since the last pass */
+static void
+publish_audio (void)
+{
+    uint8_t pattern[AUDIO_PATTERN_SIZE];
+    uint8_t pitch;
 
-    SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, screen_texture, NULL, NULL);
-    SDL_RenderPresent(renderer);
+    chip8_get_audio(pattern, &pitch);
+    chip8_sound_set_pattern(pattern, pitch,
+                            get_sound_timer_remaining() > 0);
 }
 
+/* Counts a presented frame, and republishes the metrics every so often.
+ * pass_begin is when this pass of the main loop started. */
 static void
-run_main_event_loop (void)
+update_metrics (uint64_t pass_begin)
+{
+    static uint64_t s_last_present = 0;
+    static uint64_t s_last_publish = 0;
+    chip8_counters_t counters;
+    uint64_t now = chip8_hud_now();
+
+    metrics.frames_presented++;
+    if (s_last_present != 0 && now - s_last_present >= 2 * FRAME_NS) {
+        metrics.frames_dropped += (now - s_last_present) / FRAME_NS - 1;
+    }
+    s_last_present = now;
+
+    metrics.waiting_for_key =
+        (chip8_get_stop_reason(NULL) == CHIP8_STOP_KEY_WAIT);
+    if (metrics.waiting_for_key) {
+        metrics.key_wait_ns += now - pass_begin;
+    }
+
+    if (now - s_last_publish < METRICS_PUBLISH_NS) {
+        return;
+    }
+    s_last_publish = now;
+
+    chip8_get_counters(&counters);
+    metrics.instructions = counters.instructions;
+    metrics.draws = counters.draws;
+    metrics.collisions = counters.collisions;
+    metrics.timer_ticks = get_timer_ticks();
+    metrics.audio_underruns = chip8_sound_get_underruns();
+    metrics.instructions_per_pass = instructions_per_loop;
+    metrics.faulted = (chip8_get_fault(NULL) != CHIP8_FAULT_NONE);
+    chip8_metrics_publish(&metrics);
+}
+
+/* Queues a press or release of the key the latency test program waits
+ * for, so it goes through the same event path as a real one */
+static void
+push_latency_key (bool pressed)
 {
     SDL_Event event;
 
+    memset(&event, 0, sizeof(event));
+    event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+    event.key.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+    event.key.keysym.sym = SDLK_x;
+    SDL_PushEvent(&event);
+}
+
+/* Injects the next press when it is due, before events are polled */
+static void
+poll_latency (void)
+{
+    bool ready = (chip8_get_stop_reason(NULL) == CHIP8_STOP_KEY_WAIT);
+
+    if (chip8_latency_poll(chip8_hud_now(), ready) == CHIP8_LATENCY_PRESS) {
+        push_latency_key(true);
+    }
+}
+
+/* Times the press against the frame just presented */
+static void
+check_latency (bool changed)
+{
+    char label[64];
+    char report[256];
+
+    switch (chip8_latency_presented(chip8_hud_now(), changed)) {
+        default:
+            break;
+        case CHIP8_LATENCY_RELEASE:
+            push_latency_key(false);
+            break;
+        case CHIP8_LATENCY_DONE:
+            snprintf(label, sizeof(label), "%s ipf=%u vsync=%s",
+                     chip8_engine_current()->name, instructions_per_loop,
+                     vsync_enabled ? "on" : "off");
+            chip8_latency_report(label, report, sizeof(report));
+            printf("%s\n", report);
+            is_running = false;
+            break;
+    }
+}
+
+static void
+run_main_event_loop (void)
+{
+    uint64_t loop_begin;
+    uint64_t begin;
+    uint64_t hud_begin;
+    uint64_t pass_begin;
+    uint32_t ran;
+    bool changed;
+
     printf("Entering main loop\n");
 
+    if (latency_samples > 0) {
+        chip8_latency_start(latency_samples, chip8_hud_now());
+    }
+
     while (is_running) {
+        loop_begin = chip8_trace_now();
+        pass_begin = (metrics_target != NULL) ? chip8_hud_now() : 0;
 
-        /* Process incoming events.
-         * NOTE: This will chew up 100% CPU.
-         * Would be nice to have a better way to wait between drawing frames */
-        if (SDL_PollEvent(&event) != 0) {
-            if (event.type == SDL_QUIT) {
+        if (latency_samples > 0) {
+            poll_latency();
+        }
+
+        if (!frontend->poll()) {
+            is_running = false;
+        }
+
+        begin = chip8_trace_phase(CHIP8_TRACE_POLL, loop_begin);
+        hud_begin = hud_enabled ? chip8_hud_now() : 0;
+
+        ran = chip8_engine_run(instructions_per_loop);
+        if (chip8_debugger_should_break()) {
+            /* The debugger needs the terminal to itself */
+            if (!debug_enabled || frontend == &chip8_term_frontend) {
+                debugger_unavailable = true;
+                is_running = false;
+            } else if (!chip8_debugger_prompt()) {
                 is_running = false;
-            } else if (event.type == SDL_KEYDOWN) {
-                handle_key_down_event(&event);
-            } else if (event.type == SDL_KEYUP) {
-                handle_key_up_event(&event);
             }
         }
+        begin = chip8_trace_phase(CHIP8_TRACE_RUN, begin);
 
-        chip8_step();
         update_timers();
-        paint_screen();
+        begin = chip8_trace_phase(CHIP8_TRACE_TIMERS, begin);
+
+        if (xochip_enabled) {
+            publish_audio();
+            chip8_trace_phase(CHIP8_TRACE_AUDIO, begin);
+        }
+
+        if (hud_enabled) {
+            hud_phase_ns[CHIP8_HUD_EMULATE] = chip8_hud_now() - hud_begin;
+        }
+
+        changed = paint_screen();
+        chip8_trace_phase(CHIP8_TRACE_LOOP, loop_begin);
+
+        /* Readers keep the last frame they saw until a new one comes */
+        if (changed && shm_name != NULL) {
+            chip8_shm_publish(&screen_frame, frame_number);
+        }
+        if (changed && stream_path != NULL) {
+            chip8_stream_publish(&screen_frame, frame_number);
+        }
+        /* Recordings hold a frame per 1/60s tick, the last pass of a
+         * tick only shows up at the start of the next one */
+        record_pending = record_pending || changed;
+        if (record_pending && record_path != NULL &&
+            get_frame_ticks() != record_tick) {
+            record_tick = get_frame_ticks();
+            chip8_record_publish(&screen_frame, record_tick);
+            record_pending = false;
+        }
+        frame_number++;
+
+        if (latency_samples > 0) {
+            check_latency(changed);
+        }
+
+        if (metrics_target != NULL) {
+            update_metrics(pass_begin);
+        }
+
+        if (hud_enabled &&
+            chip8_hud_frame(chip8_hud_now(), hud_phase_ns, ran)) {
+            update_hud();
+        }
     }
 
     printf("\nExiting...\n");
 }
 
 static void
-init_sdl (void)
+print_renderer_info (void)
+{
+    SDL_RendererInfo render_info;
+    int i;
+
+    SDL_GetRendererInfo(renderer, &render_info);
+
+    printf("===== Renderer Info =====\n");
+    printf("Name: %s\n", render_info.name);
+
+    for (i = 0; i < render_info.num_texture_formats; i++) {
+        printf("Format: %s\n", SDL_GetPixelFormatName(render_info.texture_formats[i]));
+    }
+}
+
+static bool
+sdl_init (void)
 {
     int rc = 0;
 
@@ -227,12 +609,15 @@ init_sdl (void)
      * the Metal SDL2 backend is not as performant as OpenGL. */
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
 
-    /* Set OpenGL to swap on VSync. This fixes performance stuttering on Mac OS.
-     * Full speed ahead on a 2012 Macbook Air. */
-    SDL_GL_SetSwapInterval(1);
+    /* Swap on VSync. This fixes performance stuttering on Mac OS. Asked of
+     * the renderer itself, setting the swap interval before it has created
+     * its GL context does nothing. */
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, vsync_enabled ? "1" : "0");
 
     renderer = SDL_CreateRenderer(get_window(), -1,
-                                  SDL_RENDERER_ACCELERATED);
+                                  SDL_RENDERER_ACCELERATED |
+                                  (vsync_enabled ?
+                                   SDL_RENDERER_PRESENTVSYNC : 0));
     if (renderer == NULL) {
         ERROR_LOG("SDL_CreateRenderer failed: %s\n", SDL_GetError());
         exit(EXIT_FAILURE);
@@ -247,15 +632,36 @@ init_sdl (void)
         exit(EXIT_FAILURE);
     }
 
+    if (hud_enabled) {
+        hud_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                        SDL_TEXTUREACCESS_STREAMING,
+                                        HUD_WIDTH, HUD_HEIGHT);
+        if (hud_texture == NULL) {
+            ERROR_LOG("SDL_CreateTexture failed: %s\n", SDL_GetError());
+            exit(EXIT_FAILURE);
+        }
+        SDL_SetTextureBlendMode(hud_texture, SDL_BLENDMODE_BLEND);
+        chip8_hud_reset(chip8_hud_now());
+        update_hud();
+    }
+
     screen_backing_store = malloc(DISPLAY_WIDTH_PIXELS * DISPLAY_HEIGHT_PIXELS * 4);
     assert(screen_backing_store);
+
+    chip8_sound_init();
+    print_renderer_info();
+
+    return true;
 }
 
 static void
-at_exit (void)
+sdl_deinit (void)
 {
     chip8_sound_deinit();
     if (get_window()) {
+        if (hud_texture != NULL) {
+            SDL_DestroyTexture(hud_texture);
+        }
         SDL_DestroyTexture(screen_texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(get_window());
@@ -264,42 +670,271 @@ at_exit (void)
     }
 }
 
+static const chip8_frontend_t s_sdl_frontend = {
+    .name       = "sdl",
+    .init       = sdl_init,
+    .deinit     = sdl_deinit,
+    .poll       = sdl_poll,
+    .upload     = sdl_upload,
+    .present    = sdl_present,
+};
+
 static void
-print_renderer_info (void)
+at_exit (void)
 {
-    SDL_RendererInfo render_info;
-    int i;
+    chip8_trace_stop();
+    chip8_metrics_stop();
+    chip8_shm_destroy();
+    chip8_stream_stop();
+    chip8_record_stop();
+    chip8_pack_close(&rom_pack);
+    if (frontend != NULL) {
+        frontend->deinit();
+    }
+}
 
-    SDL_GetRendererInfo(renderer, &render_info);
+static void
+usage (const char *prog)
+{
+    size_t i;
+
+    printf("Usage: %s [-g] [-x] [-e engine] [-i n] [-f rrggbb] [-b rrggbb] "
+           "[-p plugin.so] [-t trace.json] [-s] [-m metrics] [-V] "
+           "[-L n] [-T] "
+           "[-F name] [-w socket] [-r file] [-P pack] "
+           "<path/to/rom.ch8>\n"
+           "  -g         Start in the interactive debugger\n"
+           "  -x         Run an XO-CHIP program, with 64 KB of memory\n"
+           "  -e <name>  Execution engine, default: the fastest one\n"
+           "  -i <n>     Instructions per main loop pass (default 1)\n"
+           "  -f <rgb>   Color of lit pixels, as hex (default ffffff)\n"
+           "  -b <rgb>   Color of unlit pixels, as hex (default 000000)\n"
+           "  -p <path>  Load native SYS routines from a plugin, repeatable\n"
+           "  -t <path>  Write main loop timings as Chrome trace JSON\n"
+           "  -s         Show performance stats over the screen and in the\n"
+           "             window title\n"
+           "  -m <dest>  Serve Prometheus metrics on unix:<socket>, or\n"
+           "             rewrite them to a file every second\n"
+           "  -V         Present frames in step with the display refresh,\n"
+           "             which also paces each pass of the main loop\n"
+           "  -L <n>     Measure input-to-photon latency over n synthetic\n"
+           "             key presses, then exit. Runs a built-in test\n"
+           "             program when no ROM is given.\n"
+           "  -T         Draw in the terminal instead of a window, without\n"
+           "             sound. Ctrl-C quits.\n"
+           "  -F <name>  Publish frames in POSIX shared memory, e.g. /chip8\n"
+           "  -w <path>  Stream frames to chip8-view on a UNIX socket\n"
+           "  -r <path>  Record frames to a file, see chip8-export\n"
+           "  -P <pack>  Run a program from a ROM pack, given by name or\n"
+           "             hash instead of a path. Its profile picks -x and\n"
+           "             -i unless they are given.\n"
+           "Engines:", prog);
+    for (i = 0; i < chip8_engine_count(); i++) {
+        printf(" %s", chip8_engine_get(i)->name);
+    }
+    printf("\n");
+}
 
-    printf("===== Renderer Info =====\n");
-    printf("Name: %s\n", render_info.name);
+static void
+select_engine (void)
+{
+    const chip8_engine_t *engine;
 
-    for (i = 0; i < render_info.num_texture_formats; i++) {
-        printf("Format: %s\n", SDL_GetPixelFormatName(render_info.texture_formats[i]));
+    if (engine_name == NULL) {
+        engine = chip8_engine_calibrate(ENGINE_CALIBRATION_INSTRUCTIONS);
+    } else {
+        engine = chip8_engine_find(engine_name);
+        if (!chip8_engine_use(engine)) {
+            printf("Engine %s cannot run this program\n", engine_name);
+            engine = chip8_engine_current();
+        }
+    }
+
+    printf("Using the %s engine\n", engine->name);
+}
+
+static void
+parse_args (int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv,
+                         "gxe:i:f:b:p:t:sm:VL:TF:w:r:P:h")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            case 'g':
+                debug_enabled = true;
+                break;
+            case 'x':
+                xochip_enabled = true;
+                break;
+            case 'e':
+                engine_name = optarg;
+                break;
+            case 'i':
+                instructions_per_loop = strtoul(optarg, NULL, 0);
+                instructions_per_loop_set = true;
+                break;
+            case 'f':
+                fg_color = 0xFF000000 | strtoul(optarg, NULL, 16);
+                break;
+            case 'b':
+                bg_color = 0xFF000000 | strtoul(optarg, NULL, 16);
+                break;
+            case 'p':
+                if (!chip8_plugin_load(optarg)) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 't':
+                trace_path = optarg;
+                break;
+            case 's':
+                hud_enabled = true;
+                break;
+            case 'm':
+                metrics_target = optarg;
+                break;
+            case 'V':
+                vsync_enabled = true;
+                break;
+            case 'L':
+                latency_samples = strtoul(optarg, NULL, 0);
+                break;
+            case 'T':
+                terminal_enabled = true;
+                break;
+            case 'F':
+                shm_name = optarg;
+                break;
+            case 'w':
+                stream_path = optarg;
+                break;
+            case 'r':
+                record_path = optarg;
+                break;
+            case 'P':
+                pack_path = optarg;
+                break;
+        }
+    }
+
+    if (instructions_per_loop == 0) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    /* The overlay, injected keys and the debugger prompt need the
+     * window */
+    if (terminal_enabled &&
+        (hud_enabled || latency_samples > 0 || debug_enabled)) {
+        printf("-T cannot be used with -s, -L or -g\n");
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (engine_name != NULL && chip8_engine_find(engine_name) == NULL) {
+        printf("Unknown engine %s\n", engine_name);
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (optind >= argc && latency_samples == 0) {
+        printf("Must provide a program to load!\n");
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
     }
 }
 
+/* Maps the pack once and copies the program out of it */
+static void
+load_pack_program (const char *key)
+{
+    const chip8_pack_entry_t *entry;
+
+    if (!chip8_pack_open(pack_path, &rom_pack)) {
+        exit(EXIT_FAILURE);
+    }
+    entry = chip8_pack_find(&rom_pack, key);
+    if (entry == NULL) {
+        printf("%s is not in %s\n", key, pack_path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (entry->profile == CHIP8_PACK_PROFILE_XOCHIP) {
+        xochip_enabled = true;
+    }
+    if (!instructions_per_loop_set && entry->instructions_per_frame != 0) {
+        instructions_per_loop = entry->instructions_per_frame;
+    }
+    chip8_set_xochip(xochip_enabled);
+
+    if (chip8_pack_load(&rom_pack, entry) != 0) {
+        printf("%s is %u bytes, more than fit in memory\n", entry->name,
+               entry->size);
+        exit(EXIT_FAILURE);
+    }
+    printf("Loaded %u bytes of %s from %s\n", entry->size, entry->name,
+           pack_path);
+}
+
 int
 main (int argc, char *argv[])
 {
+    parse_args(argc, argv);
+
     /* Setup program exit cleanup routines */
     atexit(at_exit);
 
-    init_sdl();
     chip8_init();
-    chip8_sound_init();
 
-    if (argc >= 2) {
-        chip8_load_program(argv[1]);
+    if (pack_path != NULL && optind < argc) {
+        load_pack_program(argv[optind]);
+    } else if (optind < argc) {
+        chip8_set_xochip(xochip_enabled);
+        chip8_load_program(argv[optind]);
     } else {
-        printf("Must provide a program to load!\n");
-        exit(EXIT_FAILURE);
+        chip8_set_xochip(xochip_enabled);
+        chip8_load_program_buffer(chip8_latency_rom, chip8_latency_rom_size);
     }
 
-    print_renderer_info();
+    select_engine();
+
+    frontend = terminal_enabled ? &chip8_term_frontend : &s_sdl_frontend;
+    if (!frontend->init()) {
+        return EXIT_FAILURE;
+    }
 
+    if (debug_enabled && !chip8_debugger_prompt()) {
+        return EXIT_SUCCESS;
+    }
+
+    if (metrics_target != NULL && !chip8_metrics_start(metrics_target)) {
+        return EXIT_FAILURE;
+    }
+    if (shm_name != NULL && !chip8_shm_create(shm_name)) {
+        return EXIT_FAILURE;
+    }
+    if (stream_path != NULL && !chip8_stream_start(stream_path)) {
+        return EXIT_FAILURE;
+    }
+    if (record_path != NULL && !chip8_record_start(record_path)) {
+        return EXIT_FAILURE;
+    }
+    if (trace_path != NULL && chip8_trace_start(trace_path)) {
+        chip8_trace_thread_name("main");
+    }
     run_main_event_loop();
 
+    if (debugger_unavailable) {
+        /* After the terminal frontend gives the screen back */
+        frontend->deinit();
+        frontend = NULL;
+        chip8_debugger_report();
+        return EXIT_FAILURE;
+    }
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,70 @@
+/*
+ * mathlib - Sample CHIP8 host call plugin
+ *
+ * Mike Mallin, 2026
+ *
+ * Loaded with ./chip8 -p plugins/mathlib.so. Routines:
+ *   SYS 0x100  MUL   V0:V1 = V0 * V1, high byte in V0
+ *   SYS 0x101  DIV   V0 = V0 / V1, V1 = V0 % V1, faults if V1 is 0
+ *   SYS 0x102  COPY  Copies V2 bytes (0 for 256) from V0:V1 to I
+ */
+
+#include <string.h>
+
+#include "chip8_plugin.h"
+
+#define MATHLIB_MUL     0x100
+#define MATHLIB_DIV     0x101
+#define MATHLIB_COPY    0x102
+
+static bool
+mathlib_mul (chip8_rt_t *rt, void *ctx)
+{
+    uint16_t product = rt->v_regs[0] * rt->v_regs[1];
+
+    rt->v_regs[0] = product >> 8;
+    rt->v_regs[1] = product & 0xFF;
+
+    return true;
+}
+
+static bool
+mathlib_div (chip8_rt_t *rt, void *ctx)
+{
+    uint8_t dividend = rt->v_regs[0];
+    uint8_t divisor = rt->v_regs[1];
+
+    if (divisor == 0) {
+        return false;
+    }
+
+    rt->v_regs[0] = dividend / divisor;
+    rt->v_regs[1] = dividend % divisor;
+
+    return true;
+}
+
+static bool
+mathlib_copy (chip8_rt_t *rt, void *ctx)
+{
+    uint32_t size = *rt->xochip ? MEMORY_SIZE : CLASSIC_MEMORY_SIZE;
+    uint32_t src = (rt->v_regs[0] << 8) | rt->v_regs[1];
+    uint32_t len = (rt->v_regs[2] != 0) ? rt->v_regs[2] : 256;
+    uint32_t dst = *rt->i_reg;
+
+    if (src + len > size || dst + len > size) {
+        return false;
+    }
+
+    memmove(&rt->memory[dst], &rt->memory[src], len);
+
+    return true;
+}
+
+bool
+chip8_plugin_init (chip8_plugin_set_t set)
+{
+    return set(MATHLIB_MUL, mathlib_mul, NULL) &&
+           set(MATHLIB_DIV, mathlib_div, NULL) &&
+           set(MATHLIB_COPY, mathlib_copy, NULL);
+}
@@ -0,0 +1,568 @@
+/*
+ * chip8d - Runs programs for clients of a UNIX socket
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "chip8.h"
+#include "chip8_pack.h"
+#include "manifest.h"
+
+#define MAX_THREADS         256
+#define MAX_LINE            1024
+/* Connections accepted but not yet taken by a worker */
+#define MAX_PENDING         256
+#define DEFAULT_IPF         10
+/* Seconds a client may leave a worker waiting on it */
+#define DEFAULT_IDLE_SEC    10
+
+#define OUTPUT_HASH         (1 << 0)
+#define OUTPUT_SCREEN       (1 << 1)
+#define OUTPUT_REGS         (1 << 2)
+
+/* One request, see usage() */
+typedef struct daemon_job_s {
+    /* Path, XO-CHIP, instructions per frame and the key script */
+    manifest_entry_t    entry;
+    /* Bytes of program following the request, 0 to load entry.path */
+    size_t              rom_size;
+    /* Or the program from the pack */
+    const chip8_pack_entry_t *program;
+    bool                have_ipf;
+    bool                have_xochip;
+    uint64_t            cycles;
+    uint32_t            seed;
+    bool                have_seed;
+    unsigned            outputs;
+    char                error[128];
+} daemon_job_t;
+
+static const char *s_fault_names[] = {
+    [CHIP8_FAULT_NONE]              = "none",
+    [CHIP8_FAULT_BAD_OPCODE]        = "bad_opcode",
+    [CHIP8_FAULT_STACK_OVERFLOW]    = "stack_overflow",
+    [CHIP8_FAULT_STACK_UNDERFLOW]   = "stack_underflow",
+    [CHIP8_FAULT_HOST_CALL]         = "host_call",
+};
+
+static unsigned s_num_threads;
+static unsigned s_idle_sec = DEFAULT_IDLE_SEC;
+/* Mapped once and shared by the workers, NULL header when there is none */
+static const char *s_pack_path;
+static chip8_pack_t s_pack;
+static char s_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static volatile sig_atomic_t s_stop = 0;
+
+/* Accepted connections, handed to the workers in order */
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_ready = PTHREAD_COND_INITIALIZER;
+static int s_pending[MAX_PENDING];
+static unsigned s_pending_head;
+static unsigned s_pending_count;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [-j threads] [-P pack] [-t secs] <socket>\n"
+           "  -j <n>     Worker threads (default: all cores)\n"
+           "  -P <pack>  ROM pack to serve programs from\n"
+           "  -t <secs>  Hang up on clients idle this long, 0 to wait\n"
+           "             forever (default: %u)\n"
+           "\n"
+           "Requests are lines of <key> <value> ending with an empty line:\n"
+           "  rom <path>         Program to run, relative to the daemon\n"
+           "  size <n>           Or n bytes of program after the empty line\n"
+           "  pack <name|hash>   Or a program of the pack, which picks\n"
+           "                     xochip and ipf unless they are given\n"
+           "  cycles <n>         Instructions to run, required\n"
+           "  ipf <n>            Instructions per frame (default: %u)\n"
+           "  xochip 1           Run as XO-CHIP\n"
+           "  input <script>     Keys like 5+7,6-7: key 7 pressed at\n"
+           "                     frame 5 and released at frame 6\n"
+           "  seed <n>           Random number seed\n"
+           "  output <list>      Any of hash,screen,regs\n"
+           "Replies are lines of <key> <value> ending with an empty line,\n"
+           "the first one \"ok\" or \"error <why>\". A connection can send\n"
+           "any number of requests.\n",
+           prog, DEFAULT_IDLE_SEC, DEFAULT_IPF);
+}
+
+static void
+stop (int sig)
+{
+    s_stop = 1;
+}
+
+/* Fills in the job from one key and value, false if it is malformed */
+static bool
+parse_field (daemon_job_t *job, const char *key, char *value)
+{
+    manifest_entry_t *entry = &job->entry;
+    char *save = NULL;
+    char *tok;
+    char *end;
+
+    if (strcmp(key, "rom") == 0) {
+        snprintf(entry->name, sizeof(entry->name), "%s", value);
+        snprintf(entry->path, sizeof(entry->path), "%s", value);
+        return true;
+    }
+    if (strcmp(key, "pack") == 0) {
+        job->program = (s_pack.header != NULL) ?
+                       chip8_pack_find(&s_pack, value) : NULL;
+        return (job->program != NULL);
+    }
+    if (strcmp(key, "input") == 0) {
+        return (manifest_parse_input(entry, value) == 0);
+    }
+    if (strcmp(key, "output") == 0) {
+        for (tok = strtok_r(value, ",", &save); tok != NULL;
+             tok = strtok_r(NULL, ",", &save)) {
+            if (strcmp(tok, "hash") == 0) {
+                job->outputs |= OUTPUT_HASH;
+            } else if (strcmp(tok, "screen") == 0) {
+                job->outputs |= OUTPUT_SCREEN;
+            } else if (strcmp(tok, "regs") == 0) {
+                job->outputs |= OUTPUT_REGS;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    errno = 0;
+    if (strcmp(key, "size") == 0) {
+        job->rom_size = strtoull(value, &end, 0);
+    } else if (strcmp(key, "cycles") == 0) {
+        job->cycles = strtoull(value, &end, 0);
+    } else if (strcmp(key, "ipf") == 0) {
+        entry->instructions_per_frame = strtoul(value, &end, 0);
+        job->have_ipf = true;
+    } else if (strcmp(key, "xochip") == 0) {
+        entry->xochip = (strtoul(value, &end, 0) != 0);
+        job->have_xochip = true;
+    } else if (strcmp(key, "seed") == 0) {
+        job->seed = strtoul(value, &end, 0);
+        job->have_seed = true;
+    } else {
+        return false;
+    }
+
+    return (errno == 0 && end != value && *end == '\0');
+}
+
+/* Reads a request up to its empty line. Returns false once the client
+ * hangs up. A malformed request leaves a reason in job->error. */
+static bool
+read_request (FILE *in, daemon_job_t *job)
+{
+    char line[MAX_LINE];
+    char *save;
+    char *key;
+    char *value;
+    bool empty = true;
+
+    memset(job, 0, sizeof(*job));
+    job->entry.instructions_per_frame = DEFAULT_IPF;
+
+    for (;;) {
+        if (fgets(line, sizeof(line), in) == NULL) {
+            return false;
+        }
+        save = NULL;
+        key = strtok_r(line, " \t\r\n", &save);
+        if (key == NULL) {
+            /* Blank lines before a request are ignored */
+            if (empty) {
+                continue;
+            }
+            break;
+        }
+        empty = false;
+        value = strtok_r(NULL, "\r\n", &save);
+
+        if (job->error[0] == '\0' &&
+            (value == NULL || !parse_field(job, key, value))) {
+            snprintf(job->error, sizeof(job->error), "bad %s", key);
+        }
+    }
+
+    if (job->error[0] != '\0') {
+        return true;
+    }
+    if (job->program != NULL) {
+        if (!job->have_xochip) {
+            job->entry.xochip =
+                (job->program->profile == CHIP8_PACK_PROFILE_XOCHIP);
+        }
+        if (!job->have_ipf && job->program->instructions_per_frame != 0) {
+            job->entry.instructions_per_frame =
+                job->program->instructions_per_frame;
+        }
+    }
+    if (job->rom_size == 0 && job->entry.path[0] == '\0' &&
+        job->program == NULL) {
+        snprintf(job->error, sizeof(job->error), "no rom, size or pack");
+    } else if (job->cycles == 0) {
+        snprintf(job->error, sizeof(job->error), "no cycles");
+    } else if (job->entry.instructions_per_frame == 0) {
+        snprintf(job->error, sizeof(job->error), "bad ipf");
+    }
+
+    return true;
+}
+
+static void
+write_hex (FILE *out, const uint8_t *data, size_t len)
+{
+    static const char s_hex[] = "0123456789abcdef";
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        putc(s_hex[data[i] >> 4], out);
+        putc(s_hex[data[i] & 0xF], out);
+    }
+}
+
+static void
+write_outputs (FILE *out, const daemon_job_t *job)
+{
+    static _Thread_local chip8_state_t s_state;
+    static _Thread_local uint8_t s_packed[PACKED_VRAM_SIZE];
+    uint8_t planes = job->entry.xochip ? NUM_PLANES : 1;
+    uint8_t plane;
+    size_t size;
+    int width;
+    int height;
+    int i;
+
+    if (job->outputs & OUTPUT_HASH) {
+        fprintf(out, "hash %016llx\n",
+                (unsigned long long)manifest_hash_screen(job->entry.xochip));
+    }
+
+    if (job->outputs & OUTPUT_SCREEN) {
+        chip8_get_resolution(&width, &height);
+        fprintf(out, "screen %d %d", width, height);
+        for (plane = 0; plane < planes; plane++) {
+            size = chip8_get_vram_packed(plane, s_packed);
+            putc(' ', out);
+            write_hex(out, s_packed, size);
+        }
+        putc('\n', out);
+    }
+
+    if (job->outputs & OUTPUT_REGS) {
+        chip8_save_state(&s_state);
+        fprintf(out, "regs pc=%03x i=%03x sp=%03x v=", s_state.pc,
+                s_state.i_reg, s_state.stack_ptr);
+        for (i = 0; i < NUM_V_REGISTERS; i++) {
+            fprintf(out, "%s%02x", i ? "," : "", s_state.v_regs[i]);
+        }
+        putc('\n', out);
+    }
+}
+
+/* Runs a job on the calling thread's machine and writes the reply */
+static void
+run_job (FILE *out, daemon_job_t *job, const uint8_t *image)
+{
+    const manifest_entry_t *entry = &job->entry;
+    chip8_stop_reason_et reason = CHIP8_STOP_NONE;
+    struct timespec begin;
+    struct timespec end;
+    uint64_t executed = 0;
+    uint64_t count;
+    unsigned event = 0;
+    uint32_t frame = 0;
+    uint16_t addr = 0;
+    int ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    if (image != NULL) {
+        ret = manifest_boot_buffer(entry, image, job->rom_size, job->error,
+                                   sizeof(job->error));
+    } else if (job->program != NULL) {
+        ret = manifest_boot_buffer(entry, chip8_pack_image(&s_pack,
+                                                           job->program),
+                                   job->program->size, job->error,
+                                   sizeof(job->error));
+    } else {
+        ret = manifest_boot(entry, job->error, sizeof(job->error));
+    }
+    if (ret != 0) {
+        fprintf(out, "error %s\n\n", job->error);
+        return;
+    }
+    if (job->have_seed) {
+        seed_random(job->seed);
+    }
+
+    while (executed < job->cycles) {
+        manifest_apply_input(entry, frame, &event);
+
+        count = job->cycles - executed;
+        if (count > entry->instructions_per_frame) {
+            count = entry->instructions_per_frame;
+        }
+        executed += chip8_run(count);
+        tick_timers();
+        frame++;
+
+        /* Nothing can wake a machine waiting on a key no script presses */
+        reason = chip8_get_stop_reason(&addr);
+        if (reason == CHIP8_STOP_FAULT ||
+            (reason == CHIP8_STOP_KEY_WAIT && event == entry->num_events)) {
+            break;
+        }
+        reason = CHIP8_STOP_NONE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    fprintf(out, "ok\n");
+    if (reason == CHIP8_STOP_FAULT) {
+        fprintf(out, "stop fault %s %03x\n",
+                s_fault_names[chip8_get_fault(NULL)], addr);
+    } else if (reason == CHIP8_STOP_KEY_WAIT) {
+        fprintf(out, "stop key_wait\n");
+    } else {
+        fprintf(out, "stop cycles\n");
+    }
+    fprintf(out, "instructions %llu\nframes %u\n",
+            (unsigned long long)executed, frame);
+    write_outputs(out, job);
+    fprintf(out, "elapsed_ns %llu\n\n",
+            (unsigned long long)((end.tv_sec - begin.tv_sec) * 1000000000ll +
+                                 (end.tv_nsec - begin.tv_nsec)));
+}
+
+/* Answers requests until the client hangs up or goes idle */
+static void
+serve_client (int fd)
+{
+    static _Thread_local uint8_t s_image[MEMORY_SIZE];
+    static _Thread_local daemon_job_t s_job;
+    struct timeval timeout = { .tv_sec = s_idle_sec };
+    FILE *in;
+    FILE *out;
+    int out_fd;
+
+    /* The worker is stuck with the client until it hangs up. A client
+     * that neither sends nor reads gets cut off, so it cannot keep the
+     * thread from the connections queued behind it. */
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    out_fd = dup(fd);
+    in = fdopen(fd, "r");
+    out = (out_fd >= 0) ? fdopen(out_fd, "w") : NULL;
+    if (in == NULL || out == NULL) {
+        if (in != NULL) {
+            fclose(in);
+        } else {
+            close(fd);
+        }
+        if (out != NULL) {
+            fclose(out);
+        } else if (out_fd >= 0) {
+            close(out_fd);
+        }
+        return;
+    }
+
+    while (read_request(in, &s_job)) {
+        /* The program bytes come whether or not the request was good */
+        if (s_job.rom_size > sizeof(s_image)) {
+            fprintf(out, "error %zu bytes do not fit in memory\n\n",
+                    s_job.rom_size);
+            break;
+        }
+        if (s_job.rom_size > 0 &&
+            fread(s_image, 1, s_job.rom_size, in) != s_job.rom_size) {
+            break;
+        }
+
+        if (s_job.error[0] != '\0') {
+            fprintf(out, "error %s\n\n", s_job.error);
+        } else {
+            run_job(out, &s_job, (s_job.rom_size > 0) ? s_image : NULL);
+        }
+        if (fflush(out) != 0) {
+            break;
+        }
+    }
+
+    fclose(out);
+    fclose(in);
+}
+
+static void *
+worker (void *arg)
+{
+    int fd;
+
+    /* The first job should not pay for setting up this thread's machine */
+    chip8_init();
+
+    for (;;) {
+        pthread_mutex_lock(&s_lock);
+        while (s_pending_count == 0) {
+            pthread_cond_wait(&s_ready, &s_lock);
+        }
+        fd = s_pending[s_pending_head];
+        s_pending_head = (s_pending_head + 1) % MAX_PENDING;
+        s_pending_count--;
+        pthread_mutex_unlock(&s_lock);
+
+        serve_client(fd);
+    }
+
+    return NULL;
+}
+
+static int
+open_socket (const char *path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    struct stat st;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Socket path %s is too long\n", path);
+        return (-1);
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    /* Left behind by an earlier run. Never remove anything else. */
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(fd, MAX_PENDING) != 0) {
+        printf("Unable to listen on %s - %s\n", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return (-1);
+    }
+
+    return fd;
+}
+
+static void
+parse_args (int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:P:t:h")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            case 'j':
+                s_num_threads = strtoul(optarg, NULL, 0);
+                break;
+            case 'P':
+                s_pack_path = optarg;
+                break;
+            case 't':
+                s_idle_sec = strtoul(optarg, NULL, 0);
+                break;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (s_num_threads == 0) {
+        s_num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (s_num_threads > MAX_THREADS) {
+        s_num_threads = MAX_THREADS;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    struct sigaction action = { .sa_handler = stop };
+    pthread_t thread;
+    unsigned started;
+    int listen_fd;
+    int fd;
+
+    parse_args(argc, argv);
+    snprintf(s_path, sizeof(s_path), "%s", argv[optind]);
+
+    /* A client hanging up mid-reply is not our problem. No SA_RESTART,
+     * so accept() returns on a signal. */
+    signal(SIGPIPE, SIG_IGN);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (s_pack_path != NULL && !chip8_pack_open(s_pack_path, &s_pack)) {
+        return EXIT_FAILURE;
+    }
+
+    listen_fd = open_socket(s_path);
+    if (listen_fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    for (started = 0; started < s_num_threads; started++) {
+        if (pthread_create(&thread, NULL, worker, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+    }
+    if (started == 0) {
+        printf("Unable to start any workers - %s\n", strerror(errno));
+        close(listen_fd);
+        unlink(s_path);
+        return EXIT_FAILURE;
+    }
+    printf("Listening on %s with %u workers\n", s_path, started);
+    fflush(stdout);
+
+    while (!s_stop) {
+        fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&s_lock);
+        if (s_pending_count == MAX_PENDING) {
+            close(fd);
+        } else {
+            s_pending[(s_pending_head + s_pending_count) % MAX_PENDING] = fd;
+            s_pending_count++;
+            pthread_cond_signal(&s_ready);
+        }
+        pthread_mutex_unlock(&s_lock);
+    }
+
+    /* Workers are still serving, exiting takes them down with it */
+    close(listen_fd);
+    unlink(s_path);
+    return EXIT_SUCCESS;
+}
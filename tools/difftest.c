@@ -0,0 +1,418 @@
+/*
+ * chip8-difftest - Runs an engine in lockstep with the reference interpreter
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "chip8.h"
+#include "chip8_rt.h"
+#include "chip8_decode.h"
+#include "chip8_engine.h"
+#include "manifest.h"
+
+#define MAX_ENTRIES         256
+#define MAX_WINDOW          256
+#define DEFAULT_CHUNK       64
+#define DEFAULT_WINDOW      16
+#define DEFAULT_FRAMES      600
+#define DEFAULT_IPF         10
+
+/* An instruction the reference interpreter executed */
+typedef struct trace_entry_s {
+    uint16_t    pc;
+    uint16_t    op;
+} trace_entry_t;
+
+static manifest_entry_t s_entries[MAX_ENTRIES];
+static unsigned s_num_entries;
+
+static const chip8_engine_t *s_engine;
+static uint32_t s_chunk = DEFAULT_CHUNK;
+static uint32_t s_window = DEFAULT_WINDOW;
+static const char *s_manifest;
+
+/* Ring of the last s_window reference instructions */
+static trace_entry_t s_trace[MAX_WINDOW];
+static uint64_t s_trace_count;
+
+/* Both machines, swapped in and out of the thread's machine state */
+static chip8_state_t s_ref;
+static chip8_state_t s_test;
+static chip8_state_t s_ref_start;
+static chip8_state_t s_test_start;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [options] <path/to/rom.ch8...>\n"
+           "       %s [options] -m <manifest>\n"
+           "  -e <name>  Engine to check (default: the last one built in)\n"
+           "  -c <n>     Instructions between comparisons (default: %u)\n"
+           "  -w <n>     Reference instructions shown on a divergence "
+           "(default: %u)\n"
+           "  -m <path>  Run every program in a chip8-regress manifest\n"
+           "Without a manifest:\n"
+           "  -x         XO-CHIP programs\n"
+           "  -f <n>     Frames to run (default: %u)\n"
+           "  -i <n>     Instructions per frame (default: %u)\n"
+           "  -k <keys>  Key script, e.g. 5+7,6-7\n",
+           prog, prog, DEFAULT_CHUNK, DEFAULT_WINDOW, DEFAULT_FRAMES,
+           DEFAULT_IPF);
+}
+
+/* Steps the reference interpreter, recording what it runs if asked */
+static void
+step_reference (uint32_t count, bool record)
+{
+    chip8_rt_t *rt = chip8_rt_get();
+    trace_entry_t *entry;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if (record) {
+            entry = &s_trace[s_trace_count++ % s_window];
+            entry->pc = *rt->pc;
+            entry->op = chip8_fetch_op(rt->memory, *rt->pc);
+        }
+        chip8_step();
+    }
+}
+
+/* Runs both machines from the start states, returns the instructions the
+ * engine ran */
+static uint32_t
+run_both (uint32_t count, bool record)
+{
+    uint32_t ran;
+
+    chip8_restore_state(&s_test_start);
+    ran = s_engine->run(count);
+    chip8_save_state(&s_test);
+
+    chip8_restore_state(&s_ref_start);
+    step_reference(ran, record);
+    chip8_save_state(&s_ref);
+
+    return (ran);
+}
+
+static size_t
+memory_size (const chip8_state_t *state)
+{
+    return state->xochip ? MEMORY_SIZE : CLASSIC_MEMORY_SIZE;
+}
+
+static bool
+states_equal (const chip8_state_t *a, const chip8_state_t *b)
+{
+    return a->xochip == b->xochip &&
+           memcmp(a->memory, b->memory, memory_size(a)) == 0 &&
+           memcmp(a->v_regs, b->v_regs, sizeof(a->v_regs)) == 0 &&
+           a->i_reg == b->i_reg &&
+           a->pc == b->pc &&
+           a->stack_ptr == b->stack_ptr &&
+           a->paused_for_key_ld == b->paused_for_key_ld &&
+           memcmp(a->vram, b->vram, sizeof(a->vram)) == 0 &&
+           a->plane_mask == b->plane_mask &&
+           a->hires == b->hires &&
+           memcmp(a->rpl_flags, b->rpl_flags, sizeof(a->rpl_flags)) == 0 &&
+           memcmp(a->audio_pattern, b->audio_pattern,
+                  sizeof(a->audio_pattern)) == 0 &&
+           a->audio_pitch == b->audio_pitch &&
+           a->fault == b->fault &&
+           a->utils.delay_timer == b->utils.delay_timer &&
+           a->utils.sound_timer == b->utils.sound_timer &&
+           a->utils.random_state == b->utils.random_state;
+}
+
+#define REPORT_FIELD(_name, _a, _b)                                     \
+    do {                                                                \
+        if ((_a) != (_b)) {                                             \
+            printf("  %-14s 0x%-8x 0x%x\n", _name, (unsigned)(_a),      \
+                   (unsigned)(_b));                                     \
+        }                                                               \
+    } while (0)
+
+static void
+report_differences (const chip8_state_t *ref, const chip8_state_t *test)
+{
+    char name[32];
+    size_t size = memory_size(ref);
+    size_t first = size;
+    size_t count = 0;
+    size_t i;
+    int plane;
+    int row;
+
+    printf("  %-14s %-10s %s\n", "", "reference", s_engine->name);
+    REPORT_FIELD("xochip", ref->xochip, test->xochip);
+    REPORT_FIELD("pc", ref->pc, test->pc);
+    REPORT_FIELD("I", ref->i_reg, test->i_reg);
+    REPORT_FIELD("sp", ref->stack_ptr, test->stack_ptr);
+    for (i = 0; i < NUM_V_REGISTERS; i++) {
+        snprintf(name, sizeof(name), "V%zX", i);
+        REPORT_FIELD(name, ref->v_regs[i], test->v_regs[i]);
+    }
+    REPORT_FIELD("key wait", ref->paused_for_key_ld,
+                 test->paused_for_key_ld);
+    REPORT_FIELD("fault", ref->fault, test->fault);
+    REPORT_FIELD("hires", ref->hires, test->hires);
+    REPORT_FIELD("planes", ref->plane_mask, test->plane_mask);
+    REPORT_FIELD("delay timer", ref->utils.delay_timer,
+                 test->utils.delay_timer);
+    REPORT_FIELD("sound timer", ref->utils.sound_timer,
+                 test->utils.sound_timer);
+    REPORT_FIELD("random", ref->utils.random_state,
+                 test->utils.random_state);
+    REPORT_FIELD("pitch", ref->audio_pitch, test->audio_pitch);
+    for (i = 0; i < NUM_RPL_FLAGS; i++) {
+        snprintf(name, sizeof(name), "R%zu", i);
+        REPORT_FIELD(name, ref->rpl_flags[i], test->rpl_flags[i]);
+    }
+    if (memcmp(ref->audio_pattern, test->audio_pattern,
+               sizeof(ref->audio_pattern)) != 0) {
+        printf("  audio pattern differs\n");
+    }
+
+    for (i = 0; i < size && (ref->xochip == test->xochip); i++) {
+        if (ref->memory[i] != test->memory[i]) {
+            first = (count == 0) ? i : first;
+            count++;
+        }
+    }
+    if (count != 0) {
+        snprintf(name, sizeof(name), "[0x%03zx]", first);
+        REPORT_FIELD(name, ref->memory[first], test->memory[first]);
+        printf("  %zu memory bytes differ\n", count);
+    }
+
+    for (plane = 0; plane < NUM_PLANES; plane++) {
+        for (row = 0; row < DISPLAY_HEIGHT_PIXELS; row++) {
+            if (memcmp(ref->vram[plane][row], test->vram[plane][row],
+                       sizeof(ref->vram[plane][row])) != 0) {
+                printf("  VRAM differs from plane %d row %d\n", plane, row);
+                plane = NUM_PLANES;
+                break;
+            }
+        }
+    }
+}
+
+static void
+report_trace (void)
+{
+    uint64_t start = (s_trace_count > s_window) ?
+                     s_trace_count - s_window : 0;
+    chip8_insn_t insn;
+    trace_entry_t *entry;
+    uint64_t i;
+
+    printf("Last %llu reference instructions:\n",
+           (unsigned long long)(s_trace_count - start));
+    for (i = start; i < s_trace_count; i++) {
+        entry = &s_trace[i % s_window];
+        chip8_decode(entry->op, &insn);
+        printf("  0x%03x  %04x  %s\n", entry->pc, entry->op, insn.text);
+    }
+}
+
+/* Narrows a diverging chunk down to the first instruction that differs.
+ * The start states matched, count is what the engine ran. */
+static void
+report_divergence (const manifest_entry_t *entry, uint64_t executed,
+                   uint32_t frame, uint32_t count)
+{
+    uint64_t trace_count = s_trace_count;
+    uint32_t n;
+
+    /* Engines may only run whole blocks, so replay longer and longer
+     * prefixes of the chunk rather than stepping the engine */
+    for (n = 1; n < count; n++) {
+        s_trace_count = trace_count;
+        if (run_both(n, false) != n || !states_equal(&s_ref, &s_test)) {
+            break;
+        }
+    }
+    s_trace_count = trace_count;
+    n = run_both(n, true);
+
+    printf("DIVERGED %s: %s differs from the reference after instruction "
+           "%llu, frame %u\n", entry->name, s_engine->name,
+           (unsigned long long)(executed + n), frame);
+    report_differences(&s_ref, &s_test);
+    report_trace();
+}
+
+/* Returns 1 on a divergence, 0 if the engine kept up, -1 if it could not
+ * run the program at all */
+static int
+check_entry (const manifest_entry_t *entry)
+{
+    uint32_t last = entry->checkpoints[entry->num_checkpoints - 1];
+    char error[128];
+    unsigned ref_event = 0;
+    unsigned test_event = 0;
+    uint64_t executed = 0;
+    uint32_t remaining;
+    uint32_t frame;
+    uint32_t ran;
+
+    if (manifest_boot(entry, error, sizeof(error)) != 0) {
+        printf("ERROR %s: %s\n", entry->name, error);
+        return (-1);
+    }
+    if (!s_engine->init()) {
+        printf("SKIP  %s: %s can't run it\n", entry->name, s_engine->name);
+        return (-1);
+    }
+
+    chip8_save_state(&s_ref);
+    chip8_save_state(&s_test);
+    s_trace_count = 0;
+
+    for (frame = 0; frame <= last; frame++) {
+        if (ref_event < entry->num_events &&
+            entry->events[ref_event].frame == frame) {
+            chip8_restore_state(&s_ref);
+            manifest_apply_input(entry, frame, &ref_event);
+            chip8_save_state(&s_ref);
+            chip8_restore_state(&s_test);
+            manifest_apply_input(entry, frame, &test_event);
+            chip8_save_state(&s_test);
+        }
+
+        for (remaining = entry->instructions_per_frame; remaining > 0;
+             remaining -= ran) {
+            memcpy(&s_ref_start, &s_ref, chip8_state_size(&s_ref));
+            memcpy(&s_test_start, &s_test, chip8_state_size(&s_test));
+
+            ran = run_both((remaining < s_chunk) ? remaining : s_chunk,
+                           true);
+            if (!states_equal(&s_ref, &s_test)) {
+                s_trace_count -= ran;
+                report_divergence(entry, executed, frame, ran);
+                return 1;
+            }
+            executed += ran;
+
+            /* Waiting on a key or faulted, the frame is over */
+            if (ran == 0 || s_ref.paused_for_key_ld || s_ref.fault) {
+                break;
+            }
+        }
+
+        chip8_restore_state(&s_ref);
+        tick_timers();
+        chip8_save_state(&s_ref);
+        chip8_restore_state(&s_test);
+        tick_timers();
+        chip8_save_state(&s_test);
+    }
+
+    printf("ok    %s: %llu instructions\n", entry->name,
+           (unsigned long long)executed);
+    return 0;
+}
+
+static void
+parse_args (int argc, char *argv[])
+{
+    static manifest_entry_t s_template;
+    char *keys = NULL;
+    int opt;
+
+    s_template.instructions_per_frame = DEFAULT_IPF;
+    s_template.checkpoints[0] = DEFAULT_FRAMES;
+    s_template.num_checkpoints = 1;
+    s_engine = chip8_engine_get(chip8_engine_count() - 1);
+
+    while ((opt = getopt(argc, argv, "e:c:w:m:xf:i:k:h")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            case 'e':
+                s_engine = chip8_engine_find(optarg);
+                if (s_engine == NULL) {
+                    printf("No engine called %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'c':
+                s_chunk = strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                s_window = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                s_manifest = optarg;
+                break;
+            case 'x':
+                s_template.xochip = true;
+                break;
+            case 'f':
+                s_template.checkpoints[0] = strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                s_template.instructions_per_frame = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                keys = optarg;
+                break;
+        }
+    }
+
+    if (s_chunk == 0 || s_window == 0 || s_window > MAX_WINDOW ||
+        (keys != NULL && manifest_parse_input(&s_template, keys) != 0)) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (s_manifest != NULL) {
+        if (manifest_load(s_manifest, s_entries, MAX_ENTRIES,
+                          &s_num_entries) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        return;
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    for (; optind < argc && s_num_entries < MAX_ENTRIES; optind++) {
+        s_entries[s_num_entries] = s_template;
+        snprintf(s_entries[s_num_entries].name, MANIFEST_MAX_PATH, "%s",
+                 argv[optind]);
+        snprintf(s_entries[s_num_entries].path, MANIFEST_MAX_PATH, "%s",
+                 argv[optind]);
+        s_num_entries++;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    unsigned diverged = 0;
+    unsigned skipped = 0;
+    unsigned i;
+    int rc;
+
+    parse_args(argc, argv);
+
+    for (i = 0; i < s_num_entries; i++) {
+        rc = check_entry(&s_entries[i]);
+        diverged += (rc > 0);
+        skipped += (rc < 0);
+    }
+
+    printf("%u of %u programs diverged from the reference, %u not run\n",
+           diverged, s_num_entries, skipped);
+
+    return (diverged == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,283 @@
+/*
+ * chip8-dis - Disassembles CHIP8 programs
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "chip8.h"
+#include "chip8_decode.h"
+#include "chip8_cfg.h"
+
+#define PROGRAM_START       0x200
+#define DATA_BYTES_PER_LINE 8
+
+typedef enum output_mode_e {
+    OUTPUT_LISTING,
+    OUTPUT_JSON,
+    OUTPUT_TRIAGE,
+} output_mode_et;
+
+static output_mode_et s_mode = OUTPUT_LISTING;
+static bool s_xochip = false;
+static uint8_t s_memory[MEMORY_SIZE];
+static chip8_cfg_t s_cfg;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [options] <path/to/rom.ch8>...\n"
+           "  -j  Print the control-flow graph as JSON\n"
+           "  -t  Only report unsupported and indirect instructions,\n"
+           "      exits with 1 if any ROM contains unsupported opcodes\n"
+           "  -x  Analyse as XO-CHIP, where skips pass over F000 NNNN\n",
+           prog);
+}
+
+static const char *
+issue_name (uint16_t kind)
+{
+    if (kind & CHIP8_INSN_UNSUPPORTED) {
+        return "unsupported";
+    }
+
+    return (kind & CHIP8_INSN_HOST_CALL) ? "native" : "indirect";
+}
+
+/* Loads a ROM into s_memory the same way the interpreter would */
+static long
+load_rom (const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    size_t len;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return (-1);
+    }
+
+    memset(s_memory, 0, sizeof(s_memory));
+    len = fread(&s_memory[PROGRAM_START], 1, MEMORY_SIZE - PROGRAM_START,
+                file);
+    if (fgetc(file) != EOF) {
+        fprintf(stderr, "%s: larger than %d bytes\n", path,
+                MEMORY_SIZE - PROGRAM_START);
+        fclose(file);
+        return (-1);
+    }
+    fclose(file);
+
+    return (len);
+}
+
+static void
+print_label (uint16_t addr)
+{
+    if (s_cfg.byte_flags[addr] & CHIP8_CFG_SUBROUTINE) {
+        printf("\nsub_%03x:\n", addr);
+    } else if (addr == s_cfg.entry) {
+        printf("start:\n");
+    } else if (s_cfg.byte_flags[addr] & CHIP8_CFG_LEADER) {
+        printf("L_%03x:\n", addr);
+    }
+}
+
+static uint32_t
+print_data (uint32_t addr)
+{
+    uint32_t end = addr;
+    uint32_t i;
+
+    while (end < s_cfg.rom_end && end - addr < DATA_BYTES_PER_LINE &&
+           chip8_cfg_is_data(&s_cfg, end)) {
+        end++;
+    }
+
+    printf("    0x%03x:  db", addr);
+    for (i = addr; i < end; i++) {
+        printf(" 0x%02x", s_memory[i]);
+    }
+    if (s_cfg.byte_flags[addr] & CHIP8_CFG_DATA_REF) {
+        printf("    ; referenced by LD I");
+    }
+    printf("\n");
+
+    return end;
+}
+
+static void
+print_listing (void)
+{
+    chip8_insn_t insn;
+    uint32_t addr = s_cfg.rom_start;
+
+    while (addr < s_cfg.rom_end) {
+        if (chip8_cfg_is_data(&s_cfg, addr)) {
+            addr = print_data(addr);
+            continue;
+        }
+
+        if ((s_cfg.byte_flags[addr] & CHIP8_CFG_CODE) == 0) {
+            /* Second half of an instruction starting one byte earlier */
+            addr++;
+            continue;
+        }
+
+        print_label(addr);
+        chip8_decode_at(s_memory, addr, &insn);
+        printf("    0x%03x:  %04x  ", addr, insn.op);
+        if (insn.flags & (CHIP8_INSN_UNSUPPORTED | CHIP8_INSN_INDIRECT |
+                          CHIP8_INSN_HOST_CALL)) {
+            printf("%-20s; %s\n", insn.text, issue_name(insn.flags));
+        } else if (s_cfg.byte_flags[addr] & CHIP8_CFG_OVERLAP) {
+            printf("%-20s; overlaps another instruction\n", insn.text);
+        } else {
+            printf("%s\n", insn.text);
+        }
+        addr += insn.size;
+    }
+}
+
+static void
+print_json (const char *path)
+{
+    const chip8_cfg_block_t *block;
+    uint32_t addr;
+    uint32_t start;
+    size_t i;
+    size_t j;
+    bool first = true;
+
+    printf("{\n  \"rom\": \"%s\",\n  \"entry\": %u,\n", path, s_cfg.entry);
+
+    printf("  \"subroutines\": [");
+    for (i = 0; i < s_cfg.num_subroutines; i++) {
+        printf("%s%u", i ? ", " : "", s_cfg.subroutines[i]);
+    }
+    printf("],\n");
+
+    printf("  \"blocks\": [\n");
+    for (i = 0; i < s_cfg.num_blocks; i++) {
+        block = &s_cfg.blocks[i];
+        printf("    {\"start\": %u, \"end\": %u, \"insns\": %u, "
+               "\"flags\": %u, \"routine\": %u, \"call\": %d, \"succ\": [",
+               block->start, block->end, block->num_insns, block->flags,
+               block->routine, block->call_target);
+        for (j = 0; j < block->num_succ; j++) {
+            printf("%s%u", j ? ", " : "", block->succ[j]);
+        }
+        printf("]}%s\n", (i + 1 < s_cfg.num_blocks) ? "," : "");
+    }
+    printf("  ],\n");
+
+    printf("  \"data\": [");
+    for (addr = s_cfg.rom_start; addr < s_cfg.rom_end; ) {
+        if (!chip8_cfg_is_data(&s_cfg, addr)) {
+            addr++;
+            continue;
+        }
+        start = addr;
+        while (addr < s_cfg.rom_end && chip8_cfg_is_data(&s_cfg, addr)) {
+            addr++;
+        }
+        printf("%s[%u, %u]", first ? "" : ", ", start, addr);
+        first = false;
+    }
+    printf("],\n");
+
+    printf("  \"issues\": [");
+    for (i = 0; i < s_cfg.num_issues; i++) {
+        printf("%s{\"addr\": %u, \"op\": %u, \"kind\": \"%s\"}",
+               i ? ", " : "", s_cfg.issues[i].addr, s_cfg.issues[i].op,
+               issue_name(s_cfg.issues[i].kind));
+    }
+    printf("]\n}\n");
+}
+
+/* Returns true if the program uses opcodes the interpreter cannot run */
+static bool
+print_triage (const char *path)
+{
+    const chip8_cfg_issue_t *issue;
+    bool unsupported = false;
+    size_t i;
+
+    printf("%s: %zu blocks, %zu subroutines, %zu issues\n", path,
+           s_cfg.num_blocks, s_cfg.num_subroutines, s_cfg.num_issues);
+
+    for (i = 0; i < s_cfg.num_issues; i++) {
+        issue = &s_cfg.issues[i];
+        printf("  0x%03x: %04x %s\n", issue->addr, issue->op,
+               issue_name(issue->kind));
+        unsupported |= (issue->kind & CHIP8_INSN_UNSUPPORTED) != 0;
+    }
+
+    return unsupported;
+}
+
+int
+main (int argc, char *argv[])
+{
+    int status = EXIT_SUCCESS;
+    long len;
+    int opt;
+    int i;
+
+    while ((opt = getopt(argc, argv, "jtxh")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            case 'j':
+                s_mode = OUTPUT_JSON;
+                break;
+            case 't':
+                s_mode = OUTPUT_TRIAGE;
+                break;
+            case 'x':
+                s_xochip = true;
+                break;
+        }
+    }
+
+    if (optind >= argc || (s_mode != OUTPUT_TRIAGE && optind + 1 != argc)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = optind; i < argc; i++) {
+        len = load_rom(argv[i]);
+        if (len < 0) {
+            status = EXIT_FAILURE;
+            continue;
+        }
+
+        if (chip8_cfg_analyze(&s_cfg, s_memory, PROGRAM_START, len,
+                              s_xochip) != 0) {
+            fprintf(stderr, "%s: out of memory\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        switch (s_mode) {
+            case OUTPUT_LISTING:
+                print_listing();
+                break;
+            case OUTPUT_JSON:
+                print_json(argv[i]);
+                break;
+            case OUTPUT_TRIAGE:
+                if (print_triage(argv[i])) {
+                    status = EXIT_FAILURE;
+                }
+                break;
+        }
+
+        chip8_cfg_free(&s_cfg);
+    }
+
+    return status;
+}
@@ -0,0 +1,186 @@
+/*
+ * chip8-explore - Searches the input space of a CHIP8 program
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "chip8.h"
+#include "chip8_explore.h"
+
+#define MAX_PRINTED_PATH    4096
+
+static chip8_explore_config_t s_config;
+static int s_score_addr = -1;
+static long s_target_score = -1;
+
+/* Best input sequence seen so far, shared between the search threads.
+ * Nodes do not outlive the search, so the path is copied out. */
+static pthread_mutex_t s_best_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool s_have_best = false;
+static int64_t s_best_score;
+static uint8_t s_best_path[MAX_PRINTED_PATH];
+static uint32_t s_best_path_len;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [options] <path/to/rom.ch8>\n"
+           "  -j <n>     Worker threads (default: all cores)\n"
+           "  -n <n>     Stop after this many unique states\n"
+           "  -d <n>     Maximum input sequence length\n"
+           "  -i <n>     Instructions per frame\n"
+           "  -f <n>     Frames each input is held for\n"
+           "  -s <addr>  Best-first search, scored by the byte at <addr>\n"
+           "  -t <n>     Stop once the score reaches <n>\n",
+           prog);
+}
+
+static int64_t
+score_memory_byte (const chip8_state_t *state, void *arg)
+{
+    return state->memory[s_score_addr];
+}
+
+static bool
+visit_state (const chip8_explore_node_t *node, const chip8_state_t *state,
+             void *arg)
+{
+    bool keep_going = true;
+
+    if (s_score_addr < 0) {
+        return true;
+    }
+
+    pthread_mutex_lock(&s_best_lock);
+    if (!s_have_best || node->score > s_best_score) {
+        s_have_best = true;
+        s_best_score = node->score;
+        s_best_path_len = chip8_explore_node_path(node, s_best_path,
+                                                  MAX_PRINTED_PATH);
+    }
+    if (s_target_score >= 0 && node->score >= s_target_score) {
+        keep_going = false;
+    }
+    pthread_mutex_unlock(&s_best_lock);
+
+    return (keep_going);
+}
+
+static void
+print_best_path (void)
+{
+    uint32_t i;
+
+    printf("Best score %lld after %u inputs of %u frames: ",
+           (long long)s_best_score, s_best_path_len,
+           s_config.frames_per_input);
+    for (i = 0; i < s_best_path_len && i < MAX_PRINTED_PATH; i++) {
+        if (s_best_path[i] == CHIP8_EXPLORE_NO_KEY) {
+            putchar('-');
+        } else {
+            printf("%X", s_best_path[i]);
+        }
+    }
+    putchar('\n');
+}
+
+static void
+parse_args (int argc, char *argv[])
+{
+    int opt;
+
+    chip8_explore_config_init(&s_config);
+
+    while ((opt = getopt(argc, argv, "j:n:d:i:f:s:t:h")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            case 'j':
+                s_config.num_threads = strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                s_config.max_states = strtoull(optarg, NULL, 0);
+                break;
+            case 'd':
+                s_config.max_depth = strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                s_config.instructions_per_frame = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                s_config.frames_per_input = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                s_score_addr = strtol(optarg, NULL, 0);
+                break;
+            case 't':
+                s_target_score = strtol(optarg, NULL, 0);
+                break;
+        }
+    }
+
+    if (optind >= argc || s_config.max_states == 0) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (s_score_addr >= MEMORY_SIZE) {
+        printf("Score address 0x%x is out of range\n", s_score_addr);
+        exit(EXIT_FAILURE);
+    }
+
+    if (s_score_addr >= 0) {
+        s_config.strategy = CHIP8_EXPLORE_BEST_FIRST;
+        s_config.score = score_memory_byte;
+    }
+    s_config.visit = visit_state;
+}
+
+int
+main (int argc, char *argv[])
+{
+    static chip8_state_t s_start;
+    chip8_explore_stats_t stats;
+    struct timespec begin;
+    struct timespec end;
+    double elapsed;
+
+    parse_args(argc, argv);
+
+    chip8_init();
+    chip8_load_program(argv[optind]);
+    chip8_save_state(&s_start);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    if (chip8_explore(&s_config, &s_start, &stats) != 0) {
+        printf("Ran out of memory while exploring\n");
+        return EXIT_FAILURE;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - begin.tv_sec) +
+              (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    printf("Unique states:    %llu\n", (unsigned long long)stats.unique_states);
+    printf("Duplicate states: %llu\n",
+           (unsigned long long)stats.duplicate_states);
+    printf("Expanded states:  %llu\n",
+           (unsigned long long)stats.expanded_states);
+    printf("Deepest input:    %u\n", stats.max_depth_reached);
+    printf("Search %s after %.3fs (%.0f states/s)\n",
+           stats.exhausted ? "exhausted" : "stopped", elapsed,
+           elapsed > 0 ? stats.expanded_states / elapsed : 0.0);
+
+    if (s_have_best) {
+        print_best_path();
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/*
+ * chip8-export - Converts recordings to standard formats
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "chip8_record.h"
+
+/* Every frame of a video is at the largest resolution */
+#define VIDEO_WIDTH     DISPLAY_WIDTH_PIXELS
+#define VIDEO_HEIGHT    DISPLAY_HEIGHT_PIXELS
+#define VIDEO_HEADER    "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 Cmono\n"
+
+/* Indexed by the pixel in the first plane in bit 0 and the second in
+ * bit 1 */
+static const uint8_t s_grays[] = { 0x00, 0xFF, 0x55, 0xAA };
+
+static chip8_frontend_frame_t s_frame;
+static uint8_t s_pixels[VIDEO_WIDTH * VIDEO_HEIGHT];
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [-p] <recording> <output>\n"
+           "Writes a recording made with ./chip8 -r as a YUV4MPEG2 video,\n"
+           "%dx%d at 60 frames per second, one per 1/60s tick.\n"
+           "  -p    Write each recorded frame as <output>NNNNNN.pgm\n"
+           "        instead, numbered by tick, at the resolution it was\n"
+           "        drawn in\n",
+           prog, VIDEO_WIDTH, VIDEO_HEIGHT);
+}
+
+/* Expands the frame to a gray level per pixel, each pixel scale by scale */
+static void
+expand_frame (int scale)
+{
+    int stride = s_frame.width / 8;
+    int width = s_frame.width * scale;
+    uint8_t gray;
+    uint8_t bit;
+    int plane;
+    int x;
+    int y;
+
+    for (y = 0; y < s_frame.height * scale; y++) {
+        for (x = 0; x < width; x++) {
+            bit = 0x80 >> (x / scale % 8);
+            gray = 0;
+            for (plane = 0; plane < s_frame.planes; plane++) {
+                if (s_frame.packed[plane][y / scale * stride + x / scale / 8] &
+                    bit) {
+                    gray |= 1 << plane;
+                }
+            }
+            s_pixels[y * width + x] = s_grays[gray];
+        }
+    }
+}
+
+static bool
+write_pgm (const char *prefix, uint64_t number)
+{
+    char path[1024];
+    size_t size = s_frame.width * s_frame.height;
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "%s%06llu.pgm", prefix,
+             (unsigned long long)number);
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        printf("Unable to write %s - %s\n", path, strerror(errno));
+        return false;
+    }
+
+    expand_frame(1);
+    fprintf(fp, "P5\n%d %d\n255\n", s_frame.width, s_frame.height);
+    if (fwrite(s_pixels, 1, size, fp) != size || fclose(fp) != 0) {
+        printf("Unable to write %s - %s\n", path, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+static bool
+write_video_frames (FILE *out, uint64_t count)
+{
+    while (count-- > 0) {
+        if (fputs("FRAME\n", out) == EOF ||
+            fwrite(s_pixels, 1, sizeof(s_pixels), out) != sizeof(s_pixels)) {
+            printf("Unable to write the video - %s\n", strerror(errno));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int
+main (int argc, char *argv[])
+{
+    FILE *in = NULL;
+    FILE *out = NULL;
+    bool pgm = false;
+    bool ok = true;
+    uint64_t frames = 0;
+    uint64_t number;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    int ret = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ph")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            case 'p':
+                pgm = true;
+                break;
+        }
+    }
+    if (optind + 2 != argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    in = fopen(argv[optind], "rb");
+    if (in == NULL) {
+        printf("Unable to open %s - %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (!chip8_record_read_header(in)) {
+        printf("%s is not a CHIP8 recording\n", argv[optind]);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    if (!pgm) {
+        out = fopen(argv[optind + 1], "wb");
+        if (out == NULL) {
+            printf("Unable to write %s - %s\n", argv[optind + 1],
+                   strerror(errno));
+            fclose(in);
+            return EXIT_FAILURE;
+        }
+        fprintf(out, VIDEO_HEADER, VIDEO_WIDTH, VIDEO_HEIGHT);
+    }
+
+    while (ok && (ret = chip8_record_read(in, &s_frame, &number)) > 0) {
+        if (frames > 0 && number <= last) {
+            ret = -1;
+            break;
+        }
+
+        if (pgm) {
+            ok = write_pgm(argv[optind + 1], number);
+        } else {
+            /* Ticks that changed nothing showed the frame before */
+            if (frames > 0) {
+                ok = write_video_frames(out, number - last - 1);
+            }
+            expand_frame(VIDEO_WIDTH / s_frame.width);
+            ok = ok && write_video_frames(out, 1);
+        }
+        if (frames == 0) {
+            first = number;
+        }
+        last = number;
+        frames++;
+    }
+
+    if (out != NULL && fclose(out) != 0) {
+        ok = false;
+    }
+    fclose(in);
+
+    if (ret < 0) {
+        printf("%s is corrupt after %llu frames\n", argv[optind],
+               (unsigned long long)frames);
+        return EXIT_FAILURE;
+    }
+    if (ok) {
+        printf("Wrote %llu recorded frames, ticks %llu to %llu\n",
+               (unsigned long long)frames, (unsigned long long)first,
+               (unsigned long long)last);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+/*
+ * chip8-fuzz - libFuzzer target for the interpreter core
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+/* Input layout:
+ *   byte 0         Flags, FUZZ_FLAG_*
+ *   byte 1         Number of frames in the key script, n
+ *   bytes 2..n+1   Key held during each frame, 0x10 and up for none
+ *   the rest       The program image, loaded at 0x200 */
+#define FUZZ_HEADER_SIZE        2
+#define FUZZ_FLAG_XOCHIP        0x01
+/* Bounds the work done per input */
+#define FUZZ_MAX_FRAMES         64
+#define FUZZ_INSTRUCTIONS_PER_FRAME 200
+#define FUZZ_SEED               0x5EED5EEDu
+
+/* Freshly initialized machines, restored instead of calling chip8_init()
+ * for every input */
+static chip8_state_t s_boot_classic;
+static chip8_state_t s_boot_xochip;
+static bool s_booted = false;
+static bool s_last_xochip = false;
+
+static void
+boot (void)
+{
+    chip8_init();
+    seed_random(FUZZ_SEED);
+    chip8_save_state(&s_boot_classic);
+
+    chip8_set_xochip(true);
+    chip8_save_state(&s_boot_xochip);
+
+    s_booted = true;
+}
+
+int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size)
+{
+    const uint8_t *script;
+    uint32_t num_frames;
+    uint32_t frame;
+    bool xochip;
+
+    if (size < FUZZ_HEADER_SIZE) {
+        return 0;
+    }
+    if (!s_booted) {
+        boot();
+    }
+
+    xochip = (data[0] & FUZZ_FLAG_XOCHIP) != 0;
+    num_frames = data[1];
+    if (num_frames > FUZZ_MAX_FRAMES ||
+        size < FUZZ_HEADER_SIZE + num_frames) {
+        return 0;
+    }
+    script = &data[FUZZ_HEADER_SIZE];
+    data += FUZZ_HEADER_SIZE + num_frames;
+    size -= FUZZ_HEADER_SIZE + num_frames;
+
+    /* Classic snapshots only carry the first 4 KB, clear whatever an
+     * XO-CHIP input left above that */
+    if (s_last_xochip && !xochip) {
+        chip8_restore_state(&s_boot_xochip);
+    }
+    chip8_restore_state(xochip ? &s_boot_xochip : &s_boot_classic);
+    s_last_xochip = xochip;
+
+    if (chip8_load_program_buffer(data, size) != 0) {
+        return 0;
+    }
+
+    /* Always run at least one frame, even without a key script */
+    for (frame = 0; frame < num_frames || frame == 0; frame++) {
+        if (frame < num_frames && script[frame] < CHIP8_KEY_MAX) {
+            key_pressed(script[frame]);
+        }
+        run_frames(1, FUZZ_INSTRUCTIONS_PER_FRAME);
+        if (frame < num_frames && script[frame] < CHIP8_KEY_MAX) {
+            key_released(script[frame]);
+        }
+
+        if (chip8_get_fault(NULL) != CHIP8_FAULT_NONE) {
+            break;
+        }
+    }
+
+    return 0;
+}
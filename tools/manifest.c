@@ -0,0 +1,232 @@
+/*
+ * manifest - Program lists shared by the testing tools
+ *
+ * Mike Mallin, 2026
+ */
+
+#include "manifest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define MAX_LINE            1024
+#define MAX_FIELDS          5
+/* Every run starts from the same random numbers */
+#define MANIFEST_SEED       0xC8C8C8C8u
+
+static int
+parse_checkpoints (manifest_entry_t *entry, char *list)
+{
+    char *save = NULL;
+    char *tok;
+    unsigned long frame;
+    char *end;
+
+    for (tok = strtok_r(list, ",", &save); tok != NULL;
+         tok = strtok_r(NULL, ",", &save)) {
+        frame = strtoul(tok, &end, 0);
+        if (*end != '\0' ||
+            entry->num_checkpoints == MANIFEST_MAX_CHECKPOINTS ||
+            (entry->num_checkpoints > 0 &&
+             frame <= entry->checkpoints[entry->num_checkpoints - 1])) {
+            return (-1);
+        }
+        entry->checkpoints[entry->num_checkpoints++] = frame;
+    }
+
+    return (entry->num_checkpoints > 0) ? 0 : -1;
+}
+
+int
+manifest_parse_input (manifest_entry_t *entry, char *list)
+{
+    char *save = NULL;
+    char *tok;
+    manifest_event_t *event;
+    unsigned long key;
+    char *end;
+
+    for (tok = strtok_r(list, ",", &save); tok != NULL;
+         tok = strtok_r(NULL, ",", &save)) {
+        if (entry->num_events == MANIFEST_MAX_EVENTS) {
+            return (-1);
+        }
+        event = &entry->events[entry->num_events];
+
+        event->frame = strtoul(tok, &end, 10);
+        if (*end != '+' && *end != '-') {
+            return (-1);
+        }
+        event->pressed = (*end == '+');
+        key = strtoul(end + 1, &end, 16);
+        if (*end != '\0' || key >= CHIP8_KEY_MAX ||
+            (entry->num_events > 0 &&
+             event->frame < entry->events[entry->num_events - 1].frame)) {
+            return (-1);
+        }
+        event->key = (chip8_key_et)key;
+        entry->num_events++;
+    }
+
+    return 0;
+}
+
+int
+manifest_load (const char *path, manifest_entry_t *entries,
+               unsigned max_entries, unsigned *num_entries)
+{
+    char line[MAX_LINE];
+    char dir[MANIFEST_MAX_PATH];
+    char *fields[MAX_FIELDS];
+    char *save;
+    const char *slash;
+    manifest_entry_t *entry;
+    unsigned line_num = 0;
+    unsigned num_fields;
+    FILE *fp;
+
+    *num_entries = 0;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        printf("Unable to open %s - %s\n", path, strerror(errno));
+        return (-1);
+    }
+
+    slash = strrchr(path, '/');
+    snprintf(dir, sizeof(dir), "%.*s",
+             slash ? (int)(slash - path + 1) : 0, path);
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_num++;
+        if (strchr(line, '#')) {
+            *strchr(line, '#') = '\0';
+        }
+
+        save = NULL;
+        memset(fields, 0, sizeof(fields));
+        for (num_fields = 0; num_fields < MAX_FIELDS; num_fields++) {
+            fields[num_fields] = strtok_r(num_fields ? NULL : line,
+                                          " \t\r\n", &save);
+            if (fields[num_fields] == NULL) {
+                break;
+            }
+        }
+        if (num_fields == 0) {
+            continue;
+        }
+
+        if (*num_entries == max_entries) {
+            printf("%s:%u: more than %u programs\n", path, line_num,
+                   max_entries);
+            fclose(fp);
+            return (-1);
+        }
+        entry = &entries[*num_entries];
+        memset(entry, 0, sizeof(*entry));
+
+        if (num_fields < 4 ||
+            (strcmp(fields[1], "chip8") != 0 &&
+             strcmp(fields[1], "xochip") != 0) ||
+            (entry->instructions_per_frame =
+                 strtoul(fields[2], NULL, 0)) == 0 ||
+            parse_checkpoints(entry, fields[3]) != 0 ||
+            (fields[4] != NULL &&
+             manifest_parse_input(entry, fields[4]) != 0)) {
+            printf("%s:%u: malformed entry\n", path, line_num);
+            fclose(fp);
+            return (-1);
+        }
+
+        snprintf(entry->name, sizeof(entry->name), "%s", fields[0]);
+        /* Relative to the manifest, unless the path is absolute */
+        snprintf(entry->path, sizeof(entry->path), "%s%s",
+                 (fields[0][0] == '/') ? "" : dir, fields[0]);
+        entry->xochip = (strcmp(fields[1], "xochip") == 0);
+        (*num_entries)++;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+int
+manifest_boot_buffer (const manifest_entry_t *entry, const uint8_t *image,
+                      size_t len, char *error, size_t error_len)
+{
+    static const chip8_utils_state_t s_released = { 0 };
+
+    /* Threads run several entries, nothing may leak from the last one */
+    chip8_init();
+    chip8_utils_restore_state(&s_released);
+    seed_random(MANIFEST_SEED);
+    chip8_set_xochip(entry->xochip);
+
+    if (chip8_load_program_buffer(image, len) != 0) {
+        snprintf(error, error_len, "%zu bytes do not fit in memory", len);
+        return (-1);
+    }
+
+    return 0;
+}
+
+int
+manifest_boot (const manifest_entry_t *entry, char *error, size_t error_len)
+{
+    static _Thread_local uint8_t s_image[MEMORY_SIZE];
+    FILE *fp;
+    size_t len;
+
+    fp = fopen(entry->path, "rb");
+    if (fp == NULL) {
+        snprintf(error, error_len, "%s", strerror(errno));
+        return (-1);
+    }
+    len = fread(s_image, 1, sizeof(s_image), fp);
+    fclose(fp);
+
+    return manifest_boot_buffer(entry, s_image, len, error, error_len);
+}
+
+/* Hashes the packed planes rather than the machine's VRAM, so the
+ * layout of VRAM can change without invalidating golden hashes */
+uint64_t
+manifest_hash_screen (bool xochip)
+{
+    static _Thread_local uint8_t s_packed[PACKED_VRAM_SIZE];
+    uint64_t h = 0;
+    uint8_t planes = xochip ? NUM_PLANES : 1;
+    int width;
+    int height;
+    uint8_t plane;
+    size_t size;
+
+    chip8_get_resolution(&width, &height);
+    h = hash_bytes(h, &width, sizeof(width));
+    h = hash_bytes(h, &height, sizeof(height));
+    for (plane = 0; plane < planes; plane++) {
+        size = chip8_get_vram_packed(plane, s_packed);
+        h = hash_bytes(h, s_packed, size);
+    }
+
+    return h;
+}
+
+void
+manifest_apply_input (const manifest_entry_t *entry, uint32_t frame,
+                      unsigned *next_event)
+{
+    const manifest_event_t *event;
+
+    while (*next_event < entry->num_events &&
+           entry->events[*next_event].frame == frame) {
+        event = &entry->events[(*next_event)++];
+        if (event->pressed) {
+            key_pressed(event->key);
+        } else {
+            key_released(event->key);
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * manifest - Program lists shared by the testing tools
+ *
+ * Mike Mallin, 2026
+ */
+
+#ifndef __MANIFEST_H__
+#define __MANIFEST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+
+#define MANIFEST_MAX_CHECKPOINTS    16
+#define MANIFEST_MAX_EVENTS         64
+#define MANIFEST_MAX_PATH           512
+
+/**
+ * @brief      Presses or releases a key at the start of a frame
+ */
+typedef struct manifest_event_s {
+    uint32_t        frame;
+    chip8_key_et    key;
+    bool            pressed;
+} manifest_event_t;
+
+/**
+ * @brief      One manifest line:
+ *             <rom> <chip8|xochip> <instructions per frame> <frame,...>
+ *             [<input>]
+ *
+ * Input is a list like 5+7,6-7: key 7 pressed at frame 5 and released at
+ * frame 6. The ROM path is relative to the manifest's directory.
+ */
+typedef struct manifest_entry_s {
+    char                name[MANIFEST_MAX_PATH];
+    char                path[MANIFEST_MAX_PATH];
+    bool                xochip;
+    uint32_t            instructions_per_frame;
+    /* In increasing order, the last one is where a run ends */
+    uint32_t            checkpoints[MANIFEST_MAX_CHECKPOINTS];
+    unsigned            num_checkpoints;
+    manifest_event_t    events[MANIFEST_MAX_EVENTS];
+    unsigned            num_events;
+} manifest_entry_t;
+
+/**
+ * @brief      Reads a manifest, printing the first malformed line
+ *
+ * @param[in]  path         The manifest
+ * @param[out] entries      Room for max_entries entries
+ * @param[in]  max_entries  Size of entries
+ * @param[out] num_entries  Entries read
+ *
+ * @return     0 on success, -1 on error
+ */
+int manifest_load(const char *path, manifest_entry_t *entries,
+                  unsigned max_entries, unsigned *num_entries);
+
+/**
+ * @brief      Parses a key script such as 5+7,6-7 into an entry
+ *
+ * @return     0 on success, -1 if the script is malformed
+ */
+int manifest_parse_input(manifest_entry_t *entry, char *list);
+
+/**
+ * @brief      Starts a fresh machine on the calling thread with the
+ *             entry's program loaded.
+ *
+ * Resets everything chip8_init() leaves alone, including keys, timers and
+ * the random numbers, so runs are reproducible on any thread.
+ *
+ * @param[out] error      Why the program could not be loaded
+ *
+ * @return     0 on success, -1 on error
+ */
+int manifest_boot(const manifest_entry_t *entry, char *error,
+                  size_t error_len);
+
+/**
+ * @brief      manifest_boot() with the program already in memory, the
+ *             entry's path is not used
+ *
+ * @param[in]  image      The program
+ * @param[in]  len        Size of image
+ *
+ * @return     0 on success, -1 on error
+ */
+int manifest_boot_buffer(const manifest_entry_t *entry, const uint8_t *image,
+                         size_t len, char *error, size_t error_len);
+
+/**
+ * @brief      Applies the key presses and releases due at a frame
+ *
+ * @param[in,out] next_event  Index of the first event not yet applied,
+ *                            start at 0
+ */
+void manifest_apply_input(const manifest_entry_t *entry, uint32_t frame,
+                          unsigned *next_event);
+
+/**
+ * @brief      Hashes what the calling thread's machine shows
+ *
+ * @param[in]  xochip     Include every plane, not just the first
+ */
+uint64_t manifest_hash_screen(bool xochip);
+
+#endif /* __MANIFEST_H__ */
@@ -0,0 +1,252 @@
+/*
+ * chip8-pack - Builds and lists ROM packs
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "chip8.h"
+#include "chip8_pack.h"
+#include "manifest.h"
+
+#define MAX_ENTRIES         4096
+
+/* Entries of the pack being built and their images, one after another */
+static chip8_pack_entry_t s_entries[MAX_ENTRIES];
+static uint32_t s_num_entries;
+static uint8_t *s_images;
+static size_t s_images_len;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s -o <pack> [-x] [-i n] [-m manifest] [<rom>...]\n"
+           "       %s -l <pack>\n"
+           "  -o <pack>      Write a pack of the ROMs\n"
+           "  -x             The ROMs are XO-CHIP programs\n"
+           "  -i <n>         Suggested instructions per frame for the ROMs\n"
+           "  -m <manifest>  Also add the programs of a chip8-regress\n"
+           "                 manifest, with the profile it gives each\n"
+           "  -l <pack>      List the programs in a pack\n"
+           "ROMs are named by their file name, without directories.\n",
+           prog, prog);
+}
+
+/* Named by its file name, see usage(). Returns 0 on success, -1 on
+ * error */
+static int
+add_rom (const char *path, bool xochip, uint32_t ipf)
+{
+    const char *name = strrchr(path, '/');
+    chip8_pack_entry_t *entry;
+    uint8_t *images;
+    uint32_t i;
+    long size;
+    FILE *fp;
+
+    name = name ? name + 1 : path;
+
+    if (s_num_entries == MAX_ENTRIES) {
+        printf("More than %u programs\n", MAX_ENTRIES);
+        return (-1);
+    }
+    if (strlen(name) >= CHIP8_PACK_MAX_NAME) {
+        printf("%s: names are at most %u characters\n", name,
+               CHIP8_PACK_MAX_NAME - 1);
+        return (-1);
+    }
+    for (i = 0; i < s_num_entries; i++) {
+        if (strcmp(s_entries[i].name, name) == 0) {
+            printf("%s is in the pack twice\n", name);
+            return (-1);
+        }
+    }
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        printf("Unable to open %s - %s\n", path, strerror(errno));
+        return (-1);
+    }
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0L, SEEK_SET);
+    if (size < 0 || size > MEMORY_SIZE) {
+        printf("%s does not fit in memory\n", path);
+        fclose(fp);
+        return (-1);
+    }
+
+    images = realloc(s_images, s_images_len + size);
+    if (images == NULL && size > 0) {
+        printf("Out of memory reading %s\n", path);
+        fclose(fp);
+        return (-1);
+    }
+    s_images = images;
+    if (fread(&s_images[s_images_len], 1, size, fp) != (size_t)size) {
+        printf("Unable to read %s\n", path);
+        fclose(fp);
+        return (-1);
+    }
+    fclose(fp);
+
+    entry = &s_entries[s_num_entries++];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    entry->hash = hash_bytes(0, &s_images[s_images_len], size);
+    /* Relative to the images until the pack is written */
+    entry->offset = s_images_len;
+    entry->size = size;
+    entry->profile = xochip ? CHIP8_PACK_PROFILE_XOCHIP :
+                              CHIP8_PACK_PROFILE_CHIP8;
+    entry->instructions_per_frame = ipf;
+    s_images_len += size;
+
+    return 0;
+}
+
+static int
+add_manifest (const char *path)
+{
+    static manifest_entry_t s_manifest[MAX_ENTRIES];
+    unsigned num_entries;
+    unsigned i;
+
+    if (manifest_load(path, s_manifest, MAX_ENTRIES, &num_entries) != 0) {
+        return (-1);
+    }
+    for (i = 0; i < num_entries; i++) {
+        if (add_rom(s_manifest[i].path, s_manifest[i].xochip,
+                    s_manifest[i].instructions_per_frame) != 0) {
+            return (-1);
+        }
+    }
+
+    return 0;
+}
+
+static int
+compare_entries (const void *a, const void *b)
+{
+    const chip8_pack_entry_t *x = a;
+    const chip8_pack_entry_t *y = b;
+
+    return (x->hash > y->hash) - (x->hash < y->hash);
+}
+
+static int
+write_pack (const char *path)
+{
+    chip8_pack_header_t header = {
+        .magic          = CHIP8_PACK_MAGIC,
+        .version        = CHIP8_PACK_VERSION,
+        .num_entries    = s_num_entries,
+        .entry_size     = sizeof(chip8_pack_entry_t),
+    };
+    size_t index_end = sizeof(header) + s_num_entries * sizeof(s_entries[0]);
+    uint32_t i;
+    FILE *fp;
+
+    if (index_end + s_images_len > UINT32_MAX) {
+        printf("The pack would be over 4 GB\n");
+        return (-1);
+    }
+
+    qsort(s_entries, s_num_entries, sizeof(s_entries[0]), compare_entries);
+    for (i = 0; i < s_num_entries; i++) {
+        s_entries[i].offset += index_end;
+    }
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        printf("Unable to write %s - %s\n", path, strerror(errno));
+        return (-1);
+    }
+    if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fwrite(s_entries, sizeof(s_entries[0]), s_num_entries, fp) !=
+            s_num_entries ||
+        fwrite(s_images, 1, s_images_len, fp) != s_images_len ||
+        fclose(fp) != 0) {
+        printf("Unable to write %s - %s\n", path, strerror(errno));
+        return (-1);
+    }
+
+    printf("Packed %u programs, %zu bytes\n", s_num_entries,
+           index_end + s_images_len);
+    return 0;
+}
+
+static int
+list_pack (const char *path)
+{
+    const chip8_pack_entry_t *entry;
+    chip8_pack_t pack;
+    uint32_t i;
+
+    if (!chip8_pack_open(path, &pack)) {
+        return (-1);
+    }
+
+    for (i = 0; i < pack.header->num_entries; i++) {
+        entry = &pack.entries[i];
+        printf("%016llx %6u %-6s %5u %s\n", (unsigned long long)entry->hash,
+               entry->size,
+               (entry->profile == CHIP8_PACK_PROFILE_XOCHIP) ? "xochip" :
+                                                               "chip8",
+               entry->instructions_per_frame, entry->name);
+    }
+
+    chip8_pack_close(&pack);
+    return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+    const char *output = NULL;
+    bool xochip = false;
+    uint32_t ipf = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:xi:m:l:h")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            case 'l':
+                return (list_pack(optarg) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+            case 'o':
+                output = optarg;
+                break;
+            case 'x':
+                xochip = true;
+                break;
+            case 'i':
+                ipf = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                if (add_manifest(optarg) != 0) {
+                    return EXIT_FAILURE;
+                }
+                break;
+        }
+    }
+
+    if (output == NULL) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (; optind < argc; optind++) {
+        if (add_rom(argv[optind], xochip, ipf) != 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return (write_pack(output) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,589 @@
+/*
+ * chip8-recomp - Translates a CHIP8 program to C ahead of time
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "chip8.h"
+#include "chip8_decode.h"
+#include "chip8_cfg.h"
+
+#define PROGRAM_START       0x200
+#define BYTES_PER_LINE      12
+
+static uint8_t s_memory[MEMORY_SIZE];
+static chip8_cfg_t s_cfg;
+static FILE *s_out;
+static uint16_t s_code_lo;
+static uint32_t s_code_hi;
+
+#define EMIT(...) (fprintf(s_out, __VA_ARGS__))
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [-o out.c] <path/to/rom.ch8>\n"
+           "  -o <file>  Write the C source here instead of stdout\n",
+           prog);
+}
+
+static long
+load_rom (const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    size_t len;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return (-1);
+    }
+
+    /* The translation only runs classic programs */
+    memset(s_memory, 0, sizeof(s_memory));
+    len = fread(&s_memory[PROGRAM_START], 1,
+                CLASSIC_MEMORY_SIZE - PROGRAM_START, file);
+    if (fgetc(file) != EOF) {
+        fprintf(stderr, "%s: larger than %d bytes\n", path,
+                CLASSIC_MEMORY_SIZE - PROGRAM_START);
+        fclose(file);
+        return (-1);
+    }
+    fclose(file);
+
+    return (len);
+}
+
+/* Leaves compiled code to let the interpreter run the instruction at addr.
+ * rem is the number of instructions after it in the block, all of which
+ * were already counted on entry. */
+static void
+emit_bail (uint16_t addr, unsigned rem)
+{
+    EMIT("    n -= %u; pc = 0x%03x; goto interp;\n", rem + 1, addr);
+}
+
+static void
+emit_skip (const char *cond, uint16_t addr)
+{
+    EMIT("    pc = (%s) ? 0x%03x : 0x%03x;\n    goto dispatch;\n",
+         cond, addr + 4, addr + 2);
+}
+
+/* Leaves FX33, FX55 and FX65 to the interpreter when len bytes at I run
+ * past the top of memory, where MEMORY_AT() wraps them around */
+static void
+emit_wrap_check (unsigned len, uint16_t addr, unsigned rem)
+{
+    EMIT("    if (I > CLASSIC_MEMORY_SIZE - %u) {\n    ", len);
+    emit_bail(addr, rem);
+    EMIT("    }\n");
+}
+
+/* After a memory write that may have hit compiled code */
+static void
+emit_write_check (const char *start, const char *len, uint16_t addr,
+                  unsigned rem)
+{
+    EMIT("    if (rc_note_write(%s, %s)) {\n"
+         "        n -= %u; pc = 0x%03x; goto dispatch;\n"
+         "    }\n", start, len, rem, addr + 2);
+}
+
+static void
+emit_op8 (uint16_t op)
+{
+    unsigned x = OPC_REGX(op);
+    unsigned y = OPC_REGY(op);
+
+    /* Mirrors chip8_interpret_op8(), including the order in which VF and
+     * Vx are written when x is 0xF */
+    switch (OPC_N(op)) {
+        case 0x0:
+            EMIT("    v[0x%X] = v[0x%X];\n", x, y);
+            break;
+        case 0x1:
+            EMIT("    v[0x%X] |= v[0x%X];\n", x, y);
+            break;
+        case 0x2:
+            EMIT("    v[0x%X] &= v[0x%X];\n", x, y);
+            break;
+        case 0x3:
+            EMIT("    v[0x%X] ^= v[0x%X];\n", x, y);
+            break;
+        case 0x4:
+            EMIT("    tmp = v[0x%X] + v[0x%X];\n"
+                 "    v[0x%X] = tmp & 0xFF;\n"
+                 "    v[0xF] = tmp >> 8;\n", x, y, x);
+            break;
+        case 0x5:
+            EMIT("    v[0xF] = v[0x%X] > v[0x%X];\n"
+                 "    v[0x%X] = v[0x%X] - v[0x%X];\n", x, y, x, x, y);
+            break;
+        case 0x6:
+            EMIT("    v[0xF] = v[0x%X] & 0x1;\n"
+                 "    v[0x%X] = v[0x%X] >> 1;\n", x, x, x);
+            break;
+        case 0x7:
+            EMIT("    v[0xF] = v[0x%X] > v[0x%X];\n"
+                 "    v[0x%X] = v[0x%X] - v[0x%X];\n", y, x, x, y, x);
+            break;
+        case 0xE:
+            EMIT("    v[0xF] = (v[0x%X] & 0x80) != 0;\n"
+                 "    v[0x%X] = v[0x%X] << 1;\n", x, x, x);
+            break;
+    }
+}
+
+static void
+emit_opF (uint16_t op, uint16_t addr, unsigned rem)
+{
+    unsigned x = OPC_REGX(op);
+    char len[8];
+
+    switch (OPC_NN(op)) {
+        case 0x07:
+            EMIT("    v[0x%X] = get_delay_timer_remaining();\n", x);
+            break;
+        case 0x15:
+            EMIT("    set_delay_timer(v[0x%X]);\n", x);
+            break;
+        case 0x18:
+            EMIT("    set_sound_timer(v[0x%X]);\n", x);
+            break;
+        case 0x1E:
+            EMIT("    I += v[0x%X];\n", x);
+            break;
+        case 0x29:
+            EMIT("    I = CHIP8_RT_FONT_ADDR(v[0x%X] & 0xF);\n", x);
+            break;
+        case 0x30:
+            EMIT("    I = CHIP8_RT_BIG_FONT_ADDR(v[0x%X] & 0xF);\n", x);
+            break;
+        case 0x33:
+            emit_wrap_check(3, addr, rem);
+            EMIT("    mem[I] = v[0x%X] / 100;\n"
+                 "    mem[I + 1] = (v[0x%X] / 10) %% 10;\n"
+                 "    mem[I + 2] = v[0x%X] %% 10;\n", x, x, x);
+            emit_write_check("I", "3", addr, rem);
+            break;
+        case 0x55:
+            emit_wrap_check(x + 1, addr, rem);
+            EMIT("    memcpy(&mem[I], v, %u);\n", x + 1);
+            snprintf(len, sizeof(len), "%u", x + 1);
+            emit_write_check("I", len, addr, rem);
+            break;
+        case 0x65:
+            emit_wrap_check(x + 1, addr, rem);
+            EMIT("    memcpy(v, &mem[I], %u);\n", x + 1);
+            break;
+        case 0x75:
+            EMIT("    memcpy(rt->rpl_flags, v, %u);\n", x + 1);
+            break;
+        case 0x85:
+            EMIT("    memcpy(v, rt->rpl_flags, %u);\n", x + 1);
+            break;
+    }
+}
+
+static void
+emit_insn (uint16_t addr, unsigned rem)
+{
+    chip8_insn_t insn;
+    uint16_t op = chip8_fetch_op(s_memory, addr);
+    unsigned x = OPC_REGX(op);
+    unsigned y = OPC_REGY(op);
+    char cond[48];
+
+    chip8_decode(op, &insn);
+    EMIT("i_%03x: /* %s */\n", addr, insn.text);
+
+    if (insn.flags & (CHIP8_INSN_UNSUPPORTED | CHIP8_INSN_INDIRECT |
+                      CHIP8_INSN_KEY_WAIT | CHIP8_INSN_HALT |
+                      CHIP8_INSN_HOST_CALL)) {
+        /* Left to the interpreter: BNNN has no static target, LD Vx, K
+         * pauses the machine, EXIT parks it, SYS runs native code that
+         * may move the PC and unsupported opcodes stop it */
+        emit_bail(addr, rem);
+        return;
+    }
+
+    switch (OPC_CLASS(op)) {
+        case 0x0:
+            if (op == 0x00E0) {
+                EMIT("    chip8_rt_clear();\n");
+            } else if (op == 0x00EE) {
+                /* The interpreter faults on an empty stack */
+                EMIT("    if (sp >= CHIP8_RT_STACK_BASE_ADDR) {\n    ");
+                emit_bail(addr, rem);
+                EMIT("    }\n");
+                EMIT("    sp += 2;\n"
+                     "    memcpy(&pc, &mem[sp], sizeof(pc));\n"
+                     "    goto dispatch;\n");
+            } else {
+                /* SUPER-CHIP scrolls and resolution changes */
+                EMIT("    chip8_rt_display_op(0x%04x);\n", op);
+            }
+            break;
+        case 0x1:
+            EMIT("    pc = 0x%03x;\n    goto dispatch;\n", OPC_NNN(op));
+            break;
+        case 0x2:
+            /* The interpreter faults on a full stack */
+            EMIT("    if (sp < CHIP8_RT_STACK_END_ADDR) {\n    ");
+            emit_bail(addr, rem);
+            EMIT("    }\n");
+            EMIT("    ret = 0x%03x;\n"
+                 "    memcpy(&mem[sp], &ret, sizeof(ret));\n"
+                 "    if (rc_note_write(sp, sizeof(ret))) {\n"
+                 "        n -= %u;\n"
+                 "    }\n"
+                 "    sp -= 2;\n"
+                 "    pc = 0x%03x;\n"
+                 "    goto dispatch;\n", addr + 2, rem, OPC_NNN(op));
+            break;
+        case 0x3:
+        case 0x4:
+            snprintf(cond, sizeof(cond), "v[0x%X] %s 0x%02x", x,
+                     OPC_CLASS(op) == 0x3 ? "==" : "!=", OPC_NN(op));
+            emit_skip(cond, addr);
+            break;
+        case 0x5:
+        case 0x9:
+            snprintf(cond, sizeof(cond), "v[0x%X] %s v[0x%X]", x,
+                     OPC_CLASS(op) == 0x5 ? "==" : "!=", y);
+            emit_skip(cond, addr);
+            break;
+        case 0x6:
+            EMIT("    v[0x%X] = 0x%02x;\n", x, OPC_NN(op));
+            break;
+        case 0x7:
+            EMIT("    v[0x%X] += 0x%02x;\n", x, OPC_NN(op));
+            break;
+        case 0x8:
+            emit_op8(op);
+            break;
+        case 0xA:
+            EMIT("    I = 0x%03x;\n", OPC_NNN(op));
+            break;
+        case 0xC:
+            EMIT("    v[0x%X] = get_random_byte() & 0x%02x;\n", x, OPC_NN(op));
+            break;
+        case 0xD:
+            EMIT("    v[0xF] = chip8_rt_draw(v[0x%X], v[0x%X], I, %u);\n",
+                 x, y, OPC_N(op));
+            break;
+        case 0xE:
+            snprintf(cond, sizeof(cond), "%sget_key_pressed(v[0x%X] & 0xF)",
+                     OPC_NN(op) == 0x9E ? "" : "!", x);
+            emit_skip(cond, addr);
+            break;
+        case 0xF:
+            emit_opF(op, addr, rem);
+            break;
+    }
+}
+
+static void
+emit_byte_table (const char *decl, const uint8_t *bytes, size_t len)
+{
+    size_t i;
+
+    EMIT("%s = {", decl);
+    for (i = 0; i < len; i++) {
+        EMIT("%s0x%02x,", (i % BYTES_PER_LINE == 0) ? "\n    " : " ",
+             bytes[i]);
+    }
+    EMIT("\n};\n\n");
+}
+
+static void
+emit_tables (void)
+{
+    const chip8_cfg_block_t *block;
+    size_t i;
+    uint32_t addr;
+
+    EMIT("#define CODE_LO     0x%03x\n"
+         "#define CODE_HI     0x%03x\n"
+         "#define NUM_BLOCKS  %zu\n\n", s_code_lo, s_code_hi, s_cfg.num_blocks);
+
+    EMIT("/* Memory the code was compiled from */\n");
+    emit_byte_table("static const uint8_t s_image[CODE_HI - CODE_LO]",
+                    &s_memory[s_code_lo], s_code_hi - s_code_lo);
+
+    EMIT("static const struct {\n"
+         "    uint16_t start;\n"
+         "    uint16_t end;\n"
+         "} s_blocks[NUM_BLOCKS] = {\n");
+    for (i = 0; i < s_cfg.num_blocks; i++) {
+        block = &s_cfg.blocks[i];
+        EMIT("    { 0x%03x, 0x%03x },\n", block->start, block->end);
+    }
+    EMIT("};\n\n");
+
+    EMIT("/* Block index + 1 of every compiled byte, 0 for the rest */\n"
+         "static const uint16_t s_block_of[CODE_HI - CODE_LO] = {");
+    i = 0;
+    for (addr = s_code_lo; addr < s_code_hi; addr++) {
+        while (i < s_cfg.num_blocks && s_cfg.blocks[i].end <= addr) {
+            i++;
+        }
+        block = (i < s_cfg.num_blocks) ? &s_cfg.blocks[i] : NULL;
+        EMIT("%s%zu,", ((addr - s_code_lo) % BYTES_PER_LINE == 0) ?
+             "\n    " : " ",
+             (block != NULL && block->start <= addr) ? i + 1 : 0);
+    }
+    EMIT("\n};\n\n");
+}
+
+static void
+emit_helpers (void)
+{
+    EMIT("/* Blocks whose bytes changed since they were compiled */\n"
+         "static _Thread_local bool s_dirty[NUM_BLOCKS];\n\n");
+
+    EMIT("/* Marks blocks overwritten by a store, returns true if any. Stores\n"
+         " * wrap around the top of memory like the interpreter's. */\n"
+         "static bool\n"
+         "rc_note_write (uint32_t start, uint32_t len)\n"
+         "{\n"
+         "    uint32_t addr;\n"
+         "    uint32_t i;\n"
+         "    bool hit = false;\n\n"
+         "    if (start + len <= CLASSIC_MEMORY_SIZE &&\n"
+         "        (start >= CODE_HI || start + len <= CODE_LO)) {\n"
+         "        return false;\n"
+         "    }\n\n"
+         "    for (i = 0; i < len; i++) {\n"
+         "        addr = (start + i) & (CLASSIC_MEMORY_SIZE - 1);\n"
+         "        if (addr >= CODE_LO && addr < CODE_HI &&\n"
+         "            s_block_of[addr - CODE_LO] != 0) {\n"
+         "            s_dirty[s_block_of[addr - CODE_LO] - 1] = true;\n"
+         "            hit = true;\n"
+         "        }\n"
+         "    }\n\n"
+         "    return hit;\n"
+         "}\n\n");
+
+    EMIT("/* Interprets the instruction at the PC, noting any code it\n"
+         " * overwrites */\n"
+         "static uint32_t\n"
+         "rc_interpret_one (chip8_rt_t *rt)\n"
+         "{\n"
+         "    uint16_t pc = *rt->pc;\n"
+         "    uint16_t op = (rt->memory[pc] << 8) | rt->memory[pc + 1];\n\n"
+         "    if ((op & 0xF0FF) == 0xF033) {\n"
+         "        rc_note_write(*rt->i_reg, 3);\n"
+         "    } else if ((op & 0xF0FF) == 0xF055) {\n"
+         "        rc_note_write(*rt->i_reg, ((op >> 8) & 0xF) + 1);\n"
+         "    } else if ((op & 0xF000) == 0x2000) {\n"
+         "        rc_note_write(*rt->stack_ptr, sizeof(uint16_t));\n"
+         "    }\n\n"
+         "    return chip8_rt_interpret(1);\n"
+         "}\n\n");
+
+    EMIT("void\n"
+         "chip8_recomp_invalidate (void)\n"
+         "{\n"
+         "    const uint8_t *mem = chip8_rt_get()->memory;\n"
+         "    int i;\n\n"
+         "    for (i = 0; i < NUM_BLOCKS; i++) {\n"
+         "        s_dirty[i] = memcmp(&mem[s_blocks[i].start],\n"
+         "                            &s_image[s_blocks[i].start - CODE_LO],\n"
+         "                            s_blocks[i].end - s_blocks[i].start) != 0;\n"
+         "    }\n"
+         "}\n\n");
+
+    EMIT("bool\n"
+         "chip8_recomp_attach (void)\n"
+         "{\n"
+         "    if (*chip8_rt_get()->xochip ||\n"
+         "        memcmp(&chip8_rt_get()->memory[CODE_LO], s_image,\n"
+         "               sizeof(s_image)) != 0) {\n"
+         "        return false;\n"
+         "    }\n\n"
+         "    chip8_recomp_invalidate();\n"
+         "    chip8_rt_set_native(chip8_recomp_run, chip8_recomp_invalidate);\n\n"
+         "    return true;\n"
+         "}\n\n");
+}
+
+static void
+emit_run (void)
+{
+    const chip8_cfg_block_t *block;
+    chip8_insn_t insn;
+    uint32_t addr;
+    size_t i;
+    unsigned k;
+
+    EMIT("uint32_t\n"
+         "chip8_recomp_run (uint32_t count)\n"
+         "{\n"
+         "    chip8_rt_t *rt = chip8_rt_get();\n"
+         "    uint8_t *mem = rt->memory;\n"
+         "    uint8_t v[NUM_V_REGISTERS];\n"
+         "    uint16_t I;\n"
+         "    uint16_t pc;\n"
+         "    uint16_t sp;\n"
+         "    uint16_t ret;\n"
+         "    uint16_t tmp;\n"
+         "    uint32_t n = 0;\n"
+         "    uint32_t done;\n\n"
+         "    if (*rt->paused_for_key_ld) {\n"
+         "        return chip8_rt_interpret(count);\n"
+         "    }\n\n"
+         "    memcpy(v, rt->v_regs, sizeof(v));\n"
+         "    I = *rt->i_reg;\n"
+         "    pc = *rt->pc;\n"
+         "    sp = *rt->stack_ptr;\n"
+         "    (void)mem;\n"
+         "    (void)ret;\n"
+         "    (void)tmp;\n\n");
+
+    /* Every compiled instruction is an entry point. Each case charges the
+     * rest of its block up front, so a block is only entered if it can
+     * run to its end within count. */
+    EMIT("dispatch:\n"
+         "    switch (pc) {\n"
+         "        default:\n"
+         "            goto interp;\n");
+    for (i = 0; i < s_cfg.num_blocks; i++) {
+        block = &s_cfg.blocks[i];
+        for (k = 0, addr = block->start; addr < block->end; k++, addr += 2) {
+            EMIT("        case 0x%03x:\n"
+                 "            if (s_dirty[%zu] || n + %u > count) goto interp;\n"
+                 "            n += %u;\n"
+                 "            goto i_%03x;\n",
+                 addr, i, block->num_insns - k, block->num_insns - k, addr);
+        }
+    }
+    EMIT("    }\n\n");
+
+    EMIT("interp:\n"
+         "    if (n >= count) {\n"
+         "        goto out;\n"
+         "    }\n"
+         "    memcpy(rt->v_regs, v, sizeof(v));\n"
+         "    *rt->i_reg = I;\n"
+         "    *rt->pc = pc;\n"
+         "    *rt->stack_ptr = sp;\n"
+         "    done = rc_interpret_one(rt);\n"
+         "    n += done;\n"
+         "    memcpy(v, rt->v_regs, sizeof(v));\n"
+         "    I = *rt->i_reg;\n"
+         "    pc = *rt->pc;\n"
+         "    sp = *rt->stack_ptr;\n"
+         "    if (done == 0 || *rt->paused_for_key_ld) {\n"
+         "        goto out;\n"
+         "    }\n"
+         "    goto dispatch;\n\n");
+
+    for (i = 0; i < s_cfg.num_blocks; i++) {
+        block = &s_cfg.blocks[i];
+        EMIT("    /* Block 0x%03x - 0x%03x */\n", block->start, block->end);
+        for (k = 0, addr = block->start; addr < block->end; k++, addr += 2) {
+            emit_insn(addr, block->num_insns - k - 1);
+        }
+
+        chip8_decode(chip8_fetch_op(s_memory, block->end - 2), &insn);
+        if ((insn.flags & (CHIP8_INSN_JUMP | CHIP8_INSN_CALL |
+                           CHIP8_INSN_RET | CHIP8_INSN_SKIP)) == 0) {
+            EMIT("    pc = 0x%03x;\n    goto dispatch;\n", block->end);
+        }
+        EMIT("\n");
+    }
+
+    EMIT("out:\n"
+         "    memcpy(rt->v_regs, v, sizeof(v));\n"
+         "    *rt->i_reg = I;\n"
+         "    *rt->pc = pc;\n"
+         "    *rt->stack_ptr = sp;\n\n"
+         "    return (n);\n"
+         "}\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+    const char *out_path = NULL;
+    long len;
+    size_t i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:h")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            case 'o':
+                out_path = optarg;
+                break;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    len = load_rom(argv[optind]);
+    if (len < 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (chip8_cfg_analyze(&s_cfg, s_memory, PROGRAM_START, len, false) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    if (s_cfg.num_blocks == 0) {
+        fprintf(stderr, "%s: no code found\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < s_cfg.num_blocks; i++) {
+        if (s_cfg.blocks[i].flags & CHIP8_INSN_XOCHIP) {
+            fprintf(stderr, "%s: XO-CHIP programs are not supported\n",
+                    argv[optind]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    s_code_lo = s_cfg.blocks[0].start;
+    s_code_hi = s_cfg.blocks[0].end;
+    for (i = 1; i < s_cfg.num_blocks; i++) {
+        if (s_cfg.blocks[i].end > s_code_hi) {
+            s_code_hi = s_cfg.blocks[i].end;
+        }
+    }
+
+    s_out = (out_path != NULL) ? fopen(out_path, "w") : stdout;
+    if (s_out == NULL) {
+        fprintf(stderr, "%s: cannot create\n", out_path);
+        return EXIT_FAILURE;
+    }
+
+    EMIT("/*\n"
+         " * Generated by chip8-recomp from %s, do not edit.\n"
+         " */\n\n"
+         "#include <stdint.h>\n"
+         "#include <stdbool.h>\n"
+         "#include <string.h>\n\n"
+         "#include \"chip8_rt.h\"\n\n", argv[optind]);
+    emit_tables();
+    emit_helpers();
+    emit_run();
+
+    if (s_out != stdout) {
+        fclose(s_out);
+    }
+    chip8_cfg_free(&s_cfg);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,285 @@
+/*
+ * chip8-regress - Checks programs still draw what they used to
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "chip8.h"
+#include "manifest.h"
+
+#define MAX_ENTRIES         256
+
+/* What came of running one manifest entry */
+typedef struct regress_result_s {
+    /* Filled in by the workers */
+    uint64_t        hashes[MANIFEST_MAX_CHECKPOINTS];
+    char            error[128];
+    /* Read from the golden file */
+    uint64_t        golden[MANIFEST_MAX_CHECKPOINTS];
+    bool            have_golden[MANIFEST_MAX_CHECKPOINTS];
+} regress_result_t;
+
+static manifest_entry_t s_entries[MAX_ENTRIES];
+static regress_result_t s_results[MAX_ENTRIES];
+static unsigned s_num_entries;
+static atomic_uint s_next_entry;
+
+static unsigned s_num_threads;
+static bool s_update;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s [options] <manifest> <golden>\n"
+           "  -j <n>     Worker threads (default: all cores)\n"
+           "  -u         Rewrite the golden file from this run\n"
+           "\n"
+           "Manifest lines, relative to the manifest's directory:\n"
+           "  <rom> <chip8|xochip> <instructions per frame> "
+           "<frame,...> [<input>]\n"
+           "Input is a list like 5+7,6-7: key 7 pressed at frame 5 and\n"
+           "released at frame 6. Frames must be in order.\n",
+           prog);
+}
+
+static void
+run_entry (const manifest_entry_t *entry, regress_result_t *result)
+{
+    uint32_t last = entry->checkpoints[entry->num_checkpoints - 1];
+    unsigned event = 0;
+    unsigned checkpoint = 0;
+    uint32_t frame;
+
+    if (manifest_boot(entry, result->error, sizeof(result->error)) != 0) {
+        return;
+    }
+
+    for (frame = 0; frame <= last; frame++) {
+        manifest_apply_input(entry, frame, &event);
+
+        /* Checkpoint frames are hashed before they run */
+        if (frame == entry->checkpoints[checkpoint]) {
+            result->hashes[checkpoint++] = manifest_hash_screen(entry->xochip);
+            if (checkpoint == entry->num_checkpoints) {
+                break;
+            }
+        }
+
+        run_frames(1, entry->instructions_per_frame);
+    }
+}
+
+static void *
+worker (void *arg)
+{
+    unsigned i;
+
+    while ((i = atomic_fetch_add(&s_next_entry, 1)) < s_num_entries) {
+        run_entry(&s_entries[i], &s_results[i]);
+    }
+
+    return NULL;
+}
+
+/* Returns the index of the named entry, or s_num_entries */
+static unsigned
+find_entry (const char *name)
+{
+    unsigned i;
+
+    for (i = 0; i < s_num_entries; i++) {
+        if (strcmp(s_entries[i].name, name) == 0) {
+            break;
+        }
+    }
+
+    return (i);
+}
+
+/* Lines are "<rom> <frame> <hash>". Hashes for programs or frames no
+ * longer in the manifest are ignored. */
+static void
+load_golden (const char *golden)
+{
+    char name[MANIFEST_MAX_PATH];
+    manifest_entry_t *entry;
+    regress_result_t *result;
+    unsigned long long hash;
+    unsigned index;
+    unsigned long frame;
+    unsigned i;
+    FILE *fp;
+
+    fp = fopen(golden, "r");
+    if (fp == NULL) {
+        return;
+    }
+
+    while (fscanf(fp, "%511s %lu %llx", name, &frame, &hash) == 3) {
+        index = find_entry(name);
+        if (index == s_num_entries) {
+            continue;
+        }
+        entry = &s_entries[index];
+        result = &s_results[index];
+        for (i = 0; i < entry->num_checkpoints; i++) {
+            if (entry->checkpoints[i] == frame) {
+                result->golden[i] = hash;
+                result->have_golden[i] = true;
+            }
+        }
+    }
+
+    fclose(fp);
+}
+
+static int
+write_golden (const char *golden)
+{
+    const manifest_entry_t *entry;
+    const regress_result_t *result;
+    unsigned i;
+    unsigned j;
+    FILE *fp;
+
+    fp = fopen(golden, "w");
+    if (fp == NULL) {
+        printf("Unable to write %s - %s\n", golden, strerror(errno));
+        return (-1);
+    }
+
+    for (i = 0; i < s_num_entries; i++) {
+        entry = &s_entries[i];
+        result = &s_results[i];
+        for (j = 0; j < entry->num_checkpoints && result->error[0] == '\0';
+             j++) {
+            fprintf(fp, "%s %u %016llx\n", entry->name,
+                    entry->checkpoints[j],
+                    (unsigned long long)result->hashes[j]);
+        }
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/* Returns true if the entry matches its golden hashes */
+static bool
+report_entry (const manifest_entry_t *entry, const regress_result_t *result)
+{
+    unsigned i;
+
+    if (result->error[0] != '\0') {
+        printf("ERROR %s: %s\n", entry->name, result->error);
+        return false;
+    }
+
+    for (i = 0; i < entry->num_checkpoints; i++) {
+        if (!result->have_golden[i]) {
+            printf("NEW   %s: no golden hash for frame %u\n", entry->name,
+                   entry->checkpoints[i]);
+            return false;
+        }
+        if (result->hashes[i] != result->golden[i]) {
+            printf("FAIL  %s: frame %u hashed %016llx, expected %016llx\n",
+                   entry->name, entry->checkpoints[i],
+                   (unsigned long long)result->hashes[i],
+                   (unsigned long long)result->golden[i]);
+            return false;
+        }
+    }
+
+    printf("ok    %s\n", entry->name);
+    return true;
+}
+
+static void
+parse_args (int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:uh")) != -1) {
+        switch (opt) {
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            case 'j':
+                s_num_threads = strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+                s_update = true;
+                break;
+        }
+    }
+
+    if (optind + 2 != argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (s_num_threads == 0) {
+        s_num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    static pthread_t s_threads[MAX_ENTRIES];
+    struct timespec begin;
+    struct timespec end;
+    unsigned failed = 0;
+    unsigned i;
+
+    parse_args(argc, argv);
+
+    if (manifest_load(argv[optind], s_entries, MAX_ENTRIES,
+                      &s_num_entries) != 0) {
+        return EXIT_FAILURE;
+    }
+    load_golden(argv[optind + 1]);
+
+    if (s_num_threads > s_num_entries) {
+        s_num_threads = s_num_entries;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < s_num_threads; i++) {
+        if (pthread_create(&s_threads[i], NULL, worker, NULL) != 0) {
+            break;
+        }
+    }
+    /* Whatever threads did start finish the list between them */
+    if (i == 0) {
+        worker(NULL);
+    }
+    while (i > 0) {
+        pthread_join(s_threads[--i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (s_update) {
+        return (write_golden(argv[optind + 1]) == 0) ?
+               EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    for (i = 0; i < s_num_entries; i++) {
+        if (!report_entry(&s_entries[i], &s_results[i])) {
+            failed++;
+        }
+    }
+
+    printf("%u of %u programs failed in %.3fs\n", failed, s_num_entries,
+           (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9);
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,170 @@
+/*
+ * chip8-view - Watches a running emulator's spectator stream
+ *
+ * Mike Mallin, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "chip8_codec.h"
+#include "chip8_stream.h"
+#include "chip8_term.h"
+
+#define BUFFER_SIZE (2 * (CHIP8_CODEC_MAX_VARINT + CHIP8_CODEC_MAX_FRAME))
+
+static uint8_t s_buffer[BUFFER_SIZE];
+static size_t s_buffer_len;
+static bool s_hello_seen;
+
+static chip8_frontend_frame_t s_frame;
+static bool s_have_keyframe;
+
+static void
+usage (const char *prog)
+{
+    printf("Usage: %s <socket>\n"
+           "Shows the frames a ./chip8 -w <socket> streams, in the terminal.\n"
+           "Ctrl-C quits.\n", prog);
+}
+
+static int
+connect_stream (const char *path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Socket path %s is too long\n", path);
+        return (-1);
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+        printf("Unable to connect to %s - %s\n", path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return (-1);
+    }
+
+    return fd;
+}
+
+/* Decodes every complete message in the buffer. Returns 1 if the frame
+ * changed, 0 if not, -1 if the stream is corrupt. */
+static int
+decode_messages (void)
+{
+    chip8_codec_type_et type;
+    uint64_t number;
+    uint64_t len;
+    size_t used = 0;
+    size_t n;
+    int changed = 0;
+
+    if (!s_hello_seen) {
+        if (s_buffer_len < CHIP8_STREAM_MAGIC_LEN + 1) {
+            return 0;
+        }
+        if (memcmp(s_buffer, CHIP8_STREAM_MAGIC,
+                   CHIP8_STREAM_MAGIC_LEN) != 0 ||
+            s_buffer[CHIP8_STREAM_MAGIC_LEN] != CHIP8_STREAM_VERSION) {
+            return (-1);
+        }
+        used = CHIP8_STREAM_MAGIC_LEN + 1;
+        s_hello_seen = true;
+    }
+
+    for (;;) {
+        n = chip8_codec_get_varint(&s_buffer[used], s_buffer_len - used,
+                                   &len);
+        if (n == 0 || len > s_buffer_len - used - n) {
+            /* Incomplete, unless it can never fit */
+            if (s_buffer_len - used >= CHIP8_CODEC_MAX_VARINT &&
+                (n == 0 || len > CHIP8_CODEC_MAX_FRAME)) {
+                return (-1);
+            }
+            break;
+        }
+        used += n;
+
+        if (len == 0 ||
+            (s_buffer[used] != CHIP8_CODEC_KEYFRAME && !s_have_keyframe) ||
+            chip8_codec_decode_frame(&s_buffer[used], len, &s_frame,
+                                     &number, &type) != len) {
+            return (-1);
+        }
+        s_have_keyframe = true;
+        used += len;
+        changed = 1;
+    }
+
+    memmove(s_buffer, &s_buffer[used], s_buffer_len - used);
+    s_buffer_len -= used;
+
+    return changed;
+}
+
+int
+main (int argc, char *argv[])
+{
+    const chip8_frontend_t *frontend = &chip8_term_frontend;
+    const char *error = NULL;
+    ssize_t len;
+    int changed;
+    int fd;
+
+    if (argc != 2 || argv[1][0] == '-') {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fd = connect_stream(argv[1]);
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+    if (!frontend->init()) {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    /* The terminal frontend paces this at 60 Hz */
+    while (error == NULL && frontend->poll()) {
+        len = read(fd, &s_buffer[s_buffer_len],
+                   sizeof(s_buffer) - s_buffer_len);
+        if (len == 0) {
+            error = "The stream ended";
+        } else if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+                   errno != EINTR) {
+            error = strerror(errno);
+        } else if (len > 0) {
+            s_buffer_len += len;
+        }
+
+        changed = decode_messages();
+        if (changed < 0) {
+            error = "The stream is corrupt";
+        } else if (changed > 0) {
+            frontend->upload(&s_frame);
+        }
+        frontend->present();
+    }
+
+    frontend->deinit();
+    close(fd);
+
+    if (error != NULL) {
+        printf("%s\n", error);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}